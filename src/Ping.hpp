@@ -145,7 +145,7 @@ public:
     }
 
     /**Return the timestamp of the ping*/
-    uint64_t getTimestamp() {
+    uint64_t getTimestamp() const {
         return timestamp;
     }
 
@@ -231,7 +231,7 @@ public:
         intensity = intensity;
     }
 
-    static bool sortByTimestamp(Ping & p1, Ping & p2) {
+    static bool sortByTimestamp(const Ping & p1, const Ping & p2) {
         return p1.getTimestamp() < p2.getTimestamp();
     }
 
@@ -6,10 +6,12 @@
 #define DATAGRAMPROCESSOR_HPP
 
 #include <map>
+#include <vector>
 
 #include "../svp/SoundVelocityProfile.hpp"
 
 #include "../sidescan/SidescanPing.hpp"
+#include "../sidescan/SidescanSwath.hpp"
 
 /*!
 * \brief Datagram event handler class
@@ -98,7 +100,26 @@ public:
 
         
         
-        virtual void processSidescanData(SidescanPing * ping){}
+        /**
+         * Processes the samples of a sidescan channel. The handler owns the ping until it calls ping->release().
+         * @param ping the sidescan ping
+         */
+        virtual void processSidescanData(SidescanPing * ping){ ping->release();}
+
+        /**
+         * Processes the channels of one sidescan ping, port and starboard being paired. The handler owns the swath until
+         * it deletes it. By default, every channel goes to processSidescanData() in the order of the swath.
+         * @param swath the sidescan swath
+         */
+        virtual void processSidescanSwath(SidescanSwath * swath){
+            std::vector<SidescanPing *> pings;
+            swath->takePings(pings);
+            delete swath;
+
+            for(auto i=pings.begin();i!=pings.end();i++){
+                processSidescanData(*i);
+            }
+        }
         
 };
 
@@ -0,0 +1,279 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef QUINSYR2SONICDECODER_HPP
+#define QUINSYR2SONICDECODER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "XtfTypes.hpp"
+#include "../../utils/Constants.hpp"
+
+/*Names of the QUINSy R2Sonic packet and sections*/
+#define R2SONIC_PACKET_BTH0   0x42544830
+#define R2SONIC_SECTION_H0    0x4830
+#define R2SONIC_SECTION_A0    0x4130
+#define R2SONIC_SECTION_A2    0x4132
+#define R2SONIC_SECTION_I1    0x4931
+#define R2SONIC_SECTION_G0    0x4730
+#define R2SONIC_SECTION_G1    0x4731
+#define R2SONIC_SECTION_Q0    0x5130
+#define R2SONIC_SECTION_R0    0x5230
+
+/*!
+* \brief QUINSy R2Sonic decoder class
+*
+* Decodes the big-endian BTH0 bathymetry packets of R2Sonic sonars logged in XTF by QUINSy. The beam arrays of a
+* section are read whole: their words are swapped into a buffer in one loop, then scaled into one array per beam
+* field, in loops without branches that the compiler vectorizes. The parser then gives the beams of the swath to its
+* processor in one pass over the arrays.
+*
+* The words are assembled from their bytes, so the decoder does not depend on the byte order of the host nor on the
+* alignment of the packet. The arrays are reused from packet to packet.
+*/
+class QuinsyR2SonicDecoder{
+public:
+
+  /**Creates a QUINSy R2Sonic decoder*/
+  QuinsyR2SonicDecoder() : timestamp(0), nbBeams(0){
+
+  }
+
+  /**Destroys the QUINSy R2Sonic decoder*/
+  ~QuinsyR2SonicDecoder(){
+
+  }
+
+  /**
+  * Decodes a BTH0 packet. The beams without a value in the packet keep a value of 0.
+  *
+  * @param packet the packet, starting at its XtfHeaderQuinsyR2SonicBathy
+  * @return false if the packet is not a BTH0 packet
+  */
+  bool decode(const unsigned char * packet){
+    if(readUInt32(packet + offsetof(XtfHeaderQuinsyR2SonicBathy,PacketName)) != R2SONIC_PACKET_BTH0){
+      return false;
+    }
+
+    uint32_t nbBytes = readUInt32(packet + offsetof(XtfHeaderQuinsyR2SonicBathy,PacketSize));
+    uint32_t packetIndex = sizeof(XtfHeaderQuinsyR2SonicBathy); //start after the header
+
+    timestamp = 0;
+    resize(0);
+
+    while(packetIndex + 2 * sizeof(uint16_t) <= nbBytes){
+      const unsigned char * section = packet + packetIndex;
+      uint16_t sectionName  = readUInt16(section);
+      uint16_t sectionBytes = readUInt16(section + sizeof(uint16_t));
+
+      if(sectionBytes == 0){
+        break;
+      }
+
+      if(sectionName == R2SONIC_SECTION_H0){
+        //H0 - Main header
+        timestamp = ((uint64_t)readUInt32(section + offsetof(XtfHeaderQuinsyR2SonicBathy_H0,TimeSeconds)) * (uint64_t)1000000)
+                  + ((uint64_t)readUInt32(section + offsetof(XtfHeaderQuinsyR2SonicBathy_H0,TimeNanoseconds)) / (uint64_t)1000);
+
+        resize(readUInt16(section + offsetof(XtfHeaderQuinsyR2SonicBathy_H0,Points)));
+      }
+      else if(sectionName == R2SONIC_SECTION_A0){
+        //A0 - equi-angle mode
+        float first = readFloat(section + offsetof(XtfHeaderQuinsyR2SonicBathy_A0,AngleFirst));
+        float last  = readFloat(section + offsetof(XtfHeaderQuinsyR2SonicBathy_A0,AngleLast));
+
+        double step = (first - last) / (double)nbBeams;
+
+        for(unsigned int i=0;i<nbBeams;i++){
+          acrossTrackAngles[i] = first + i * step;
+        }
+      }
+      else if(sectionName == R2SONIC_SECTION_A2){
+        //A2 - equidistant angle mode
+        if(readWords(section,sectionBytes,offsetof(XtfHeaderQuinsyR2SonicBathy_A2,AngleStepArray))){
+          float angleFirst    = readFloat(section + offsetof(XtfHeaderQuinsyR2SonicBathy_A2,AngleFirst));
+          float scalingFactor = readFloat(section + offsetof(XtfHeaderQuinsyR2SonicBathy_A2,ScalingFactor));
+
+          //the steps add up from beam to beam: only the sum is sequential
+          uint32_t sum = 0;
+
+          for(unsigned int i=0;i<nbBeams;i++){
+            sum += words[i];
+            sums[i] = sum;
+          }
+
+          for(unsigned int i=0;i<nbBeams;i++){
+            float angle = ( angleFirst + sums[i] * scalingFactor ) * R2D;
+            acrossTrackAngles[i] = angle;
+          }
+        }
+      }
+      else if(sectionName == R2SONIC_SECTION_I1){
+        //I1
+        if(readWords(section,sectionBytes,offsetof(XtfHeaderQuinsyR2SonicBathy_I1,IntensityArray))){
+          float scalingFactor = readFloat(section + offsetof(XtfHeaderQuinsyR2SonicBathy_I1,ScalingFactor));
+
+          for(unsigned int i=0;i<nbBeams;i++){
+            double microPascals = words[i] * scalingFactor;
+
+            // dbSPL = 20 * LOG10(uPa * 1000000/0.00002)
+            intensities[i] = (double)20 * log10((double)microPascals * (double)1000000 / (double)0.00002);
+          }
+        }
+      }
+      else if(sectionName == R2SONIC_SECTION_G0 || sectionName == R2SONIC_SECTION_G1){
+        //TODO: process depth gates settings?
+      }
+      else if(sectionName == R2SONIC_SECTION_Q0){
+        //TODO: process quality data
+        std::fill(qualities.begin(),qualities.end(),0);
+      }
+      else if(sectionName == R2SONIC_SECTION_R0){
+        //R0
+        if(readWords(section,sectionBytes,offsetof(XtfHeaderQuinsyR2SonicBathy_R0,RangeArray))){
+          float scalingFactor = readFloat(section + offsetof(XtfHeaderQuinsyR2SonicBathy_R0,ScalingFactor));
+
+          for(unsigned int i=0;i<nbBeams;i++){
+            twoWayTravelTimes[i] = scalingFactor * words[i];
+          }
+        }
+      }
+      else{
+        printf("Unknown QUINSy R2Sonic section type %.4X\n",sectionName);
+      }
+
+      packetIndex += sectionBytes;
+    }
+
+    return true;
+  }
+
+  /**Returns the timestamp of the swath*/
+  uint64_t getTimestamp() const { return timestamp; }
+
+  /**Returns the number of beams of the swath*/
+  unsigned int getNbBeams() const { return nbBeams; }
+
+  /**Returns the across track angle of each beam*/
+  const double * getAcrossTrackAngles() const { return acrossTrackAngles.data(); }
+
+  /**Returns the two way travel time of each beam, in seconds*/
+  const double * getTwoWayTravelTimes() const { return twoWayTravelTimes.data(); }
+
+  /**Returns the intensity of each beam, in dB re 1 uPa*/
+  const double * getIntensities() const { return intensities.data(); }
+
+  /**Returns the quality of each beam*/
+  const uint32_t * getQualities() const { return qualities.data(); }
+
+  /**
+  * Converts an array of big-endian 16 bit words
+  *
+  * @param data the words, without any alignment
+  * @param nbWords the number of words
+  * @param values receives the words, with room for nbWords
+  */
+  static void readUInt16Array(const unsigned char * data,unsigned int nbWords,uint16_t * values){
+    for(unsigned int i=0;i<nbWords;i++){
+      values[i] = (uint16_t)((data[2 * i] << 8) | data[2 * i + 1]);
+    }
+  }
+
+  /**
+  * Returns a big-endian 16 bit word
+  *
+  * @param data the word
+  */
+  static uint16_t readUInt16(const unsigned char * data){
+    return (uint16_t)((data[0] << 8) | data[1]);
+  }
+
+  /**
+  * Returns a big-endian 32 bit word
+  *
+  * @param data the word
+  */
+  static uint32_t readUInt32(const unsigned char * data){
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | (uint32_t)data[3];
+  }
+
+  /**
+  * Returns a big-endian float
+  *
+  * @param data the float
+  */
+  static float readFloat(const unsigned char * data){
+    uint32_t word = readUInt32(data);
+    float value;
+    memcpy(&value,&word,sizeof(float));
+    return value;
+  }
+
+private:
+
+  /**
+  * Resizes the arrays for the beams of a swath and clears them
+  *
+  * @param n the number of beams
+  */
+  void resize(unsigned int n){
+    nbBeams = n;
+
+    words.resize(n);
+    sums.resize(n);
+    acrossTrackAngles.assign(n,0);
+    twoWayTravelTimes.assign(n,0);
+    intensities.assign(n,0);
+    qualities.assign(n,0);
+  }
+
+  /**
+  * Swaps the beam array of a section into the words buffer
+  *
+  * @param section the section
+  * @param sectionBytes the size of the section
+  * @param arrayOffset the offset of the beam array in the section
+  * @return false if the section is too small to hold an array of every beam
+  */
+  bool readWords(const unsigned char * section,uint16_t sectionBytes,size_t arrayOffset){
+    if(arrayOffset + nbBeams * sizeof(uint16_t) > sectionBytes){
+      printf("QUINSy R2Sonic section too small for %u beams\n",nbBeams);
+      return false;
+    }
+
+    readUInt16Array(section + arrayOffset,nbBeams,words.data());
+    return true;
+  }
+
+  /**Timestamp of the swath*/
+  uint64_t timestamp;
+
+  /**Number of beams of the swath*/
+  unsigned int nbBeams;
+
+  /**Beam array of the section being decoded, in the byte order of the host*/
+  std::vector<uint16_t> words;
+
+  /**Cumulated angle steps of an A2 section*/
+  std::vector<uint32_t> sums;
+
+  /**Across track angle of each beam*/
+  std::vector<double> acrossTrackAngles;
+
+  /**Two way travel time of each beam*/
+  std::vector<double> twoWayTravelTimes;
+
+  /**Intensity of each beam*/
+  std::vector<double> intensities;
+
+  /**Quality of each beam*/
+  std::vector<uint32_t> qualities;
+};
+
+#endif
@@ -17,7 +17,7 @@
  *
  * @param processor the datagram processor
  */
-XtfParser::XtfParser(DatagramEventHandler & processor):DatagramParser(processor){
+XtfParser::XtfParser(DatagramEventHandler & processor):DatagramParser(processor),nbDecodingThreads(0),gainWindowSize(0),gainNbBins(90){
 
 }
 
@@ -26,6 +26,41 @@ XtfParser::~XtfParser(){
     for(auto i=channels.begin();i!=channels.end();i++){
         free(*i);
     }
+
+    for(auto i=channelDecoders.begin();i!=channelDecoders.end();i++){
+        delete *i;
+    }
+}
+
+/**
+ * Normalize the across track gain of the sidescan channels while decoding them
+ *
+ * @param windowSize number of pings of each channel in the gain curve, 0 to disable normalization
+ * @param nbBins number of bins of the gain curve
+ */
+void XtfParser::setGainNormalization(unsigned int windowSize,unsigned int nbBins){
+    gainWindowSize = windowSize;
+    gainNbBins = nbBins;
+
+    for(auto i=channelDecoders.begin();i!=channelDecoders.end();i++){
+        if((*i)->gainNormalizer){
+            delete (*i)->gainNormalizer;
+            (*i)->gainNormalizer = NULL;
+        }
+
+        if(windowSize > 0){
+            (*i)->gainNormalizer = new GainNormalizer(windowSize,nbBins);
+        }
+    }
+}
+
+/**
+ * Set the number of threads decoding the channels of a sidescan ping
+ *
+ * @param nbThreads number of threads, 0 for one thread per channel, 1 to decode the channels in sequence
+ */
+void XtfParser::setNbDecodingThreads(unsigned int nbThreads){
+    nbDecodingThreads = nbThreads;
 }
 
 /**
@@ -454,6 +489,16 @@ void XtfParser::processChanInfo(XtfChanInfo * c){
     memcpy(channel,c,sizeof(XtfChanInfo));
     
     channels.push_back(channel);
+    sampleConverters.push_back(XtfSampleDecoder::select(channel->SampleFormat,channel->BytesPerSample));
+    sampleTypes.push_back(XtfSampleDecoder::getSampleType(channel->SampleFormat,channel->BytesPerSample));
+
+    XtfChannelDecoder * decoder = new XtfChannelDecoder();
+
+    if(gainWindowSize > 0){
+        decoder->gainNormalizer = new GainNormalizer(gainWindowSize,gainNbBins);
+    }
+
+    channelDecoders.push_back(decoder);
     
     //fprintf(stderr,"[+] XTF Channel Information\n\n");
     //fprintf(stderr,"TypeOfChannel: %d\n",channel->TypeOfChannel);
@@ -655,17 +700,38 @@ void XtfParser::processPacket(XtfPacketHeader & hdr,unsigned char * packet){
             XtfPingHeader * pingHdr = (XtfPingHeader*) packet;
             
             processPingHeader(*pingHdr);
-            
+
+            //Locate every channel before decoding them, each one starting after the samples of the previous one
+            swathDecoders.clear();
+
             for(unsigned int i=0;i<hdr.NumChansToFollow;i++){
                 XtfPingChanHeader * pingChanHdr = (XtfPingChanHeader *) (packet+sizeof(XtfPingHeader) + i*sizeof(XtfPingChanHeader) + sampleBytesRead);
                 processPingChanHeader(*pingChanHdr);
-                
-                unsigned char * data = ((unsigned char *)pingChanHdr) + sizeof(XtfPingChanHeader);
-                
-                processSidescanData(*pingHdr,*pingChanHdr,data);
+
+                if(pingChanHdr->ChannelNumber >= channels.size()){
+                    for(auto j=swathDecoders.begin();j!=swathDecoders.end();j++){
+                        (*j)->pingChanHdr = NULL;
+                    }
+
+                    throw new Exception("Invalid sidescan channel number");
+                }
+
+                XtfChannelDecoder * decoder = channelDecoders[pingChanHdr->ChannelNumber];
+
+                if(decoder->pingChanHdr != NULL){
+                    //A channel repeated in the packet starts another swath
+                    processSidescanSwath(*pingHdr,swathDecoders);
+                    swathDecoders.clear();
+                }
+
+                decoder->pingChanHdr = pingChanHdr;
+                decoder->data = ((unsigned char *)pingChanHdr) + sizeof(XtfPingChanHeader);
+                swathDecoders.push_back(decoder);
                 
                 sampleBytesRead += pingChanHdr->NumSamples * channels[pingChanHdr->ChannelNumber]->BytesPerSample;
             }
+
+            processSidescanSwath(*pingHdr,swathDecoders);
         }
 	else{
 		printf("Unknown packet type: %d\n",(int)hdr.HeaderType);
@@ -676,55 +742,32 @@ void XtfParser::processPingChanHeader(XtfPingChanHeader & pingChanHdr){
     
 }
 
-void XtfParser::processSidescanData(XtfPingHeader & pingHdr,XtfPingChanHeader & pingChanHdr,void * data){   
-    std::vector<double> rawSamples; //we will boil down all the types to double. This is not a pretty hack, but we need to support every sample type
-    
-    for(unsigned int i=0;i<pingChanHdr.NumSamples;i++){
-        double sample = 0;
-        
-        if(channels[pingChanHdr.ChannelNumber]->SampleFormat == 0){
-            //legacy
-            if(channels[pingChanHdr.ChannelNumber]->BytesPerSample == 1){
-                sample = ((uint8_t*)data)[i];
-            }
-            else if(channels[pingChanHdr.ChannelNumber]->BytesPerSample == 2){
-                sample = ((uint16_t*)data)[i];
-            }
-            else if(channels[pingChanHdr.ChannelNumber]->BytesPerSample == 4){
-                sample = ((uint32_t*)data)[i];
-            }
-            else{
-                std::cerr << "[-] Bytes per sample: " << channels[pingChanHdr.ChannelNumber]->BytesPerSample << std::endl;
-                throw new std::invalid_argument("Bad bytes per sample format");                
+/**
+ * Decode the channels of a sidescan ping, in parallel, and give them to the processor as a swath
+ *
+ * @param pingHdr the ping header
+ * @param decoders the decoders of the channels of the ping, located in the packet
+ */
+void XtfParser::processSidescanSwath(XtfPingHeader & pingHdr,std::vector<XtfChannelDecoder*> & decoders){
+    if(decoders.empty()) return;
+
+    uint64_t nbSamples = 0;
+
+    for(auto i=decoders.begin();i!=decoders.end();i++){
+        XtfPingChanHeader & pingChanHdr = *(*i)->pingChanHdr;
+
+        if(sampleConverters[pingChanHdr.ChannelNumber] == NULL){
+            for(auto j=decoders.begin();j!=decoders.end();j++){
+                (*j)->pingChanHdr = NULL;
             }
-        }
-        else if(channels[pingChanHdr.ChannelNumber]->SampleFormat == 1){
-            //TODO: wtf is an "IBM float" in C?
-            throw new std::invalid_argument("[-] Sample format is IBM float");
-        }
-        else if(channels[pingChanHdr.ChannelNumber]->SampleFormat == 2){
-            sample = ((uint32_t*)data)[i];
-        }
-        else if(channels[pingChanHdr.ChannelNumber]->SampleFormat == 3){
-            sample = ((uint16_t*)data)[i];
-        }
-        else if(channels[pingChanHdr.ChannelNumber]->SampleFormat == 5){
-            sample = ((float*)data)[i];
-        }
-        else if(channels[pingChanHdr.ChannelNumber]->SampleFormat == 8){
-            sample = ((uint8_t*)data)[i];
-        }        
-        else{
-            std::cerr << "[-] Sample Format: " << channels[pingChanHdr.ChannelNumber]->SampleFormat << std::endl;
-            throw new std::invalid_argument("Sample format unused");
+
+            std::cerr << "[-] Sample Format: " << (int)channels[pingChanHdr.ChannelNumber]->SampleFormat << " Bytes per sample: " << channels[pingChanHdr.ChannelNumber]->BytesPerSample << std::endl;
+            throw new std::invalid_argument("Unsupported sample format");
         }
 
-        rawSamples.push_back(sample);
+        nbSamples += pingChanHdr.NumSamples;
     }
-    
-    
-    SidescanPing * ping = new SidescanPing();
-    
+
     uint64_t microEpoch = TimeUtils::build_time(
                 pingHdr.Year,
                 pingHdr.Month-1,
@@ -735,12 +778,122 @@ void XtfParser::processSidescanData(XtfPingHeader & pingHdr,XtfPingChanHeader &
                 pingHdr.HSeconds * 10,
                 0
         );
+
+    //Small pings are not worth waking the workers
+    unsigned int threads = 1;
+
+    if(nbSamples >= XTF_PARALLEL_MIN_SAMPLES){
+        threads = (nbDecodingThreads > 0) ? std::min<size_t>(nbDecodingThreads,decoders.size()) : decoders.size();
+    }
+
+    decodingWorkers.runChunks(threads,decoders.size(),[&](unsigned int thread,size_t begin,size_t end){
+        for(size_t i=begin;i<end;i++){
+            decodeChannelSamples(pingHdr,*decoders[i]);
+        }
+    });
+
+    //Port and starboard see the same seafloor under the sensor: they share the nearest bottom either of them found
+    double pairedAltitude = 0;
+
+    for(auto i=decoders.begin();i!=decoders.end();i++){
+        uint8_t type = channels[(*i)->pingChanHdr->ChannelNumber]->TypeOfChannel;
+
+        if((type == XTF_CHANNEL_PORT || type == XTF_CHANNEL_STARBOARD) && (*i)->altitude > 0 && (pairedAltitude == 0 || (*i)->altitude < pairedAltitude)){
+            pairedAltitude = (*i)->altitude;
+        }
+    }
+
+    for(auto i=decoders.begin();i!=decoders.end();i++){
+        uint8_t type = channels[(*i)->pingChanHdr->ChannelNumber]->TypeOfChannel;
+
+        if((type == XTF_CHANNEL_PORT || type == XTF_CHANNEL_STARBOARD) && pairedAltitude > 0){
+            (*i)->altitude = pairedAltitude;
+        }
+    }
+
+    decodingWorkers.runChunks(threads,decoders.size(),[&](unsigned int thread,size_t begin,size_t end){
+        for(size_t i=begin;i<end;i++){
+            buildChannelPing(pingHdr,*decoders[i],microEpoch);
+        }
+    });
+
+    SidescanSwath * swath = new SidescanSwath(microEpoch,(pingHdr.SensorPrimaryAltitude > 0) ? pingHdr.SensorPrimaryAltitude : pairedAltitude);
+
+    if(pingHdr.SensorXcoordinate != 0.0 && pingHdr.SensorYcoordinate != 0.0){
+        swath->setPosition(Position(microEpoch,pingHdr.SensorYcoordinate,pingHdr.SensorXcoordinate,pingHdr.SensorPrimaryAltitude));
+    }
+
+    for(auto i=decoders.begin();i!=decoders.end();i++){
+        uint8_t type = channels[(*i)->pingChanHdr->ChannelNumber]->TypeOfChannel;
+        int side = SIDESCAN_SIDE_OTHER;
+
+        if(type == XTF_CHANNEL_PORT) side = SIDESCAN_SIDE_PORT;
+        else if(type == XTF_CHANNEL_STARBOARD) side = SIDESCAN_SIDE_STARBOARD;
+
+        swath->addPing((*i)->ping,side);
+
+        (*i)->ping = NULL;
+        (*i)->pingChanHdr = NULL;
+        (*i)->data = NULL;
+    }
+
+    processor.processSidescanSwath(swath);
+}
+
+/**
+ * Convert the samples of a channel, and find the altitude of the sensor if the ping header does not give it
+ *
+ * @param pingHdr the ping header
+ * @param decoder the decoder of the channel
+ */
+void XtfParser::decodeChannelSamples(XtfPingHeader & pingHdr,XtfChannelDecoder & decoder){
+    XtfPingChanHeader & pingChanHdr = *decoder.pingChanHdr;
+    XtfChanInfo * channel = channels[pingChanHdr.ChannelNumber];
+    std::vector<double> & rawSamples = decoder.rawSamples;
+
+    decoder.altitude = (pingHdr.SensorPrimaryAltitude > 0) ? pingHdr.SensorPrimaryAltitude : 0;
+
+    //Ground ranged samples that are neither corrected nor normalized are copied from the packet as they are
+    decoder.copySamples = channel->CorrectionFlags == 2 && decoder.gainNormalizer == NULL && XtfSampleDecoder::isNative(channel->SampleFormat,channel->BytesPerSample);
+
+    if(decoder.copySamples){
+        return;
+    }
+
+    //we will boil down all the types to double. This is not a pretty hack, but we need to support every sample type
+    rawSamples.resize(pingChanHdr.NumSamples);
+
+    if(pingChanHdr.NumSamples > 0){
+        sampleConverters[pingChanHdr.ChannelNumber]((const unsigned char *)decoder.data,pingChanHdr.NumSamples,&rawSamples[0]);
+    }
+
+    if(channel->CorrectionFlags != 2 && !(decoder.altitude > 0) && pingChanHdr.SlantRange > 0 && !rawSamples.empty()){
+        //Altitude from the first bottom return of the channel
+        double tracked = decoder.bottomTracker.track(pingChanHdr.ChannelNumber,rawSamples.data(),rawSamples.size(),pingChanHdr.SlantRange/(double)rawSamples.size());
+
+        decoder.altitude = (tracked > 0) ? tracked : 0;
+    }
+}
+
+/**
+ * Correct the samples of a channel and store them in a ping
+ *
+ * @param pingHdr the ping header
+ * @param decoder the decoder of the channel
+ * @param microEpoch the timestamp of the ping
+ */
+void XtfParser::buildChannelPing(XtfPingHeader & pingHdr,XtfChannelDecoder & decoder,uint64_t microEpoch){
+    XtfPingChanHeader & pingChanHdr = *decoder.pingChanHdr;
+    std::vector<double> & rawSamples = decoder.rawSamples;
+    std::vector<double> & correctedSamples = decoder.correctedSamples;
+
+    SidescanPing * ping = pingPool.acquire();
     
     ping->setTimestamp(microEpoch);
     
     if(pingHdr.SensorXcoordinate != 0.0 && pingHdr.SensorYcoordinate != 0.0){ //this would cause weird issues at coordinates... (0.0,0.0)
         ping->setPosition(
-            new Position(
+            Position(
                     microEpoch,
                     // pingHdr.SensorXcoordinate,
                     // pingHdr.SensorYcoordinate,                    
@@ -752,31 +905,54 @@ void XtfParser::processSidescanData(XtfPingHeader & pingHdr,XtfPingChanHeader &
     }
     
     ping->setChannelNumber(pingChanHdr.ChannelNumber);
+
+    //Normalized samples brighter than the mean of their bin would saturate in an integer type
+    ping->setSampleType(decoder.gainNormalizer ? SIDESCAN_SAMPLE_FLOAT : sampleTypes[pingChanHdr.ChannelNumber]);
     
-    if(channels[pingChanHdr.ChannelNumber]->CorrectionFlags == 2){
+    if(decoder.copySamples){
+        //ground ranged images in a sample type of the ping, copied without conversion
+        ping->copySamples(sampleTypes[pingChanHdr.ChannelNumber],decoder.data,pingChanHdr.NumSamples);
+        ping->setDistancePerSample(pingChanHdr.GroundRange/(double)pingChanHdr.NumSamples);
+    }
+    else if(channels[pingChanHdr.ChannelNumber]->CorrectionFlags == 2){
         //ground ranged images, use as-is
+        if(decoder.gainNormalizer){
+            decoder.gainNormalizer->normalize(pingChanHdr.ChannelNumber,rawSamples.data(),rawSamples.size(),pingChanHdr.GroundRange/(double)rawSamples.size(),decoder.altitude);
+        }
+
         ping->setSamples(rawSamples);
         ping->setDistancePerSample(pingChanHdr.GroundRange/(double)rawSamples.size());
     }
     else{       
         //Slant-range image, apply corrections to raw samples
-        std::vector<double> correctedSamples;
+        double altitude = decoder.altitude;
 
-        //Get beam angle , between nadir and slant        
-        double beamAngle = 20;
+        if(altitude > 0 && pingChanHdr.SlantRange > 0 && !rawSamples.empty()){
+            //Flat seafloor at the altitude of the sensor
+            decoder.slantRangeResampler.resample(rawSamples,pingChanHdr.SlantRange,altitude,correctedSamples);
+        }
+        else{
+            //No altitude, get beam angle , between nadir and slant
+            double beamAngle = 20;
 
-        if(channels[pingChanHdr.ChannelNumber]->TiltAngle > 0){
-            beamAngle = channels[pingChanHdr.ChannelNumber]->TiltAngle;
+            if(channels[pingChanHdr.ChannelNumber]->TiltAngle > 0){
+                beamAngle = channels[pingChanHdr.ChannelNumber]->TiltAngle;
+            }
+
+            //Apply corrections, to a cleared buffer since bins without samples are left as they are
+            correctedSamples.clear();
+            SlantRangeCorrection::correct(rawSamples,pingChanHdr.SlantRange,0,beamAngle,correctedSamples);
         }
-        
-        //Apply corrections
-        SlantRangeCorrection::correct(rawSamples,pingChanHdr.SlantRange,0,beamAngle,correctedSamples);
-        
+
+        if(decoder.gainNormalizer){
+            decoder.gainNormalizer->normalize(pingChanHdr.ChannelNumber,correctedSamples.data(),correctedSamples.size(),(double)pingChanHdr.SlantRange/(double)rawSamples.size(),altitude);
+        }
+
         ping->setSamples(correctedSamples);
         ping->setDistancePerSample((double)pingChanHdr.SlantRange/(double)rawSamples.size());
-        
-        processor.processSidescanData(ping);
     }
+
+    decoder.ping = ping;
 }
 
 
@@ -789,137 +965,30 @@ void XtfParser::processSidescanData(XtfPingHeader & pingHdr,XtfPingChanHeader &
  */
 void XtfParser::processQuinsyR2SonicBathy(XtfPacketHeader & hdr,unsigned char * packet){
 
-    if(htonl(((XtfHeaderQuinsyR2SonicBathy*)packet)->PacketName)==0x42544830){ //BTH0
-        uint32_t nbBytes = htonl(((XtfHeaderQuinsyR2SonicBathy*)packet)->PacketSize);
-
-        unsigned int packetIndex = sizeof(XtfHeaderQuinsyR2SonicBathy); //start after the header
-
-        uint16_t nbBeams = 0;
-
-        std::vector<Ping> pings;
-
-        while(packetIndex < nbBytes){
-            uint16_t sectionName  =  htons( * ((uint16_t*) (packet + packetIndex)));
-            uint16_t sectionBytes =  htons( * ((uint16_t*) (packet + packetIndex + sizeof(uint16_t))));
-
-            //printf("%c%c (%u bytes)\n",((char*)&sectionName)[1],((char*)&sectionName)[0],sectionBytes);
-
-            if(sectionName==0x4830){
-                //H0 - Main header
-                XtfHeaderQuinsyR2SonicBathy_H0 * h0 = (XtfHeaderQuinsyR2SonicBathy_H0*) (packet + packetIndex);
-                nbBeams = htons(h0->Points);
-                uint64_t microEpoch =  ((uint64_t)htonl(h0->TimeSeconds)*(uint64_t)1000000) + ((uint64_t)htonl((uint64_t)h0->TimeNanoseconds)/(uint64_t)1000);
-
-                //Init ping array
-                for(unsigned int i=0;i<nbBeams;i++){
-                    Ping p(i);
-                    p.setTimestamp(microEpoch);
-                    pings.push_back(p);
-                }
-
-                //surfaceSoundSpeed = htonl( * ((uint32_t*) & h0->SoundSpeed));
-            }
-            else if(sectionName==0x4130){
-                //A0 - equi-angle mode
-                XtfHeaderQuinsyR2SonicBathy_A0 * a0 = (XtfHeaderQuinsyR2SonicBathy_A0*) (packet + packetIndex);
-                uint32_t first = htonl( *((uint32_t*) &a0->AngleFirst) );
-                uint32_t last  = htonl( *((uint32_t*) &a0->AngleLast) );
-
-                double step = (   (*((float*)&first))   -   (*((float*)&last))   )/(double)nbBeams;
-
-                double angle = (*((float*)&first));
-
-                for(unsigned int i =0; i < nbBeams ;i++ ){
-                    pings[i].setAcrossTrackAngle(angle);
-                    angle += step;
-                }
-            }
-            else if(sectionName==0x4132){
-                //A2 - equidistant angle mode
-                XtfHeaderQuinsyR2SonicBathy_A2 * a2 = (XtfHeaderQuinsyR2SonicBathy_A2*) (packet + packetIndex);
-                uint32_t first         = htonl( *((uint32_t*)&a2->AngleFirst));
-                float    angleFirst    = *((float*)&first);
-
-                uint32_t scale         = htonl( *((uint32_t*)&a2->ScalingFactor));
-                float    scalingFactor = *((float*)&scale);
-                uint32_t sum           = 0;
-
-                for(unsigned int i=0;i<nbBeams;i++){
-                    sum += htons(((uint16_t*)&(a2->AngleStepArray))[i]);
-                    float angle = ( angleFirst + sum * scalingFactor ) * R2D;
-                    pings[i].setAcrossTrackAngle(angle);
-                }
-            }
-            else if(sectionName==0x4931){
-                //I1
-                XtfHeaderQuinsyR2SonicBathy_I1 * i1 = (XtfHeaderQuinsyR2SonicBathy_I1*) (packet + packetIndex);
-                uint32_t scale         = htonl( *((uint32_t*)&i1->ScalingFactor));
-                float    scalingFactor = *((float*)&scale);
-
-                for(unsigned int i=0;i<nbBeams;i++){
-                    double microPascals = htons(((uint16_t*)&(i1->IntensityArray))[i]) * scalingFactor;
-
-                    // dbSPL = 20 * LOG10(uPa * 1000000/0.00002)
-
-                    double intensityDb = (double)20 * log10((double)microPascals * (double)1000000 / (double)0.00002);
-
-                    pings[i].setIntensity( intensityDb );
-                }
-            }
-            else if(sectionName==0x4730){
-                //G0
-                //XtfHeaderQuinsyR2SonicBathy_G0 * g0 = (XtfHeaderQuinsyR2SonicBathy_G0*) (packet + packetIndex);
-                //TODO: process depth gates settings?
-            }
-            else if(sectionName==0x4731){
-                //G1
-                //XtfHeaderQuinsyR2SonicBathy_G1 * g1 = (XtfHeaderQuinsyR2SonicBathy_G1*) (packet + packetIndex);
-                //TODO: process depth gates settings?
-            }
-            else if(sectionName==0x5130){
-                //TODO: process quality data
-                //Q0
-                //XtfHeaderQuinsyR2SonicBathy_Q0 * q0 = (XtfHeaderQuinsyR2SonicBathy_Q0*) (packet + packetIndex);
-                for(unsigned int i=0;i<nbBeams;i++){
-                    uint32_t quality = 0;
-                    pings[i].setQuality( quality );
-                }
-            }
-            else if(sectionName==0x5230){
-                //R0
-                XtfHeaderQuinsyR2SonicBathy_R0 * r0 = (XtfHeaderQuinsyR2SonicBathy_R0*) (packet + packetIndex);
-                uint16_t * ranges = &r0->RangeArray;
-                uint32_t scalingFactor=htonl(* ((uint32_t *) &r0->ScalingFactor));
-
-                for(unsigned int i=0;i<nbBeams;i++){
-                    double twtt = (*((float*) &scalingFactor )) * htons(ranges[i]);
-                    pings[i].setTwoWayTravelTime( twtt );
-                }
-            }
-            else{
-                printf("Unknown QUINSy R2Sonic section type %.4X\n",sectionName);
-            }
-
-            packetIndex += sectionBytes;
-        }
-
-        //Process complete pings
-        for(auto i=pings.begin();i!=pings.end();i++){
-
-            processor.processPing(
-                    (*i).getTimestamp(),
-                    (*i).getId(),
-                    (*i).getAcrossTrackAngle(),
-                    (*i).getAlongTrackAngle(),
-                    (*i).getTwoWayTravelTime(),
-                    (*i).getQuality(),
-                    (*i).getIntensity()
-            );
-
-        }
-    }
-    else{
+    if(!r2SonicDecoder.decode(packet)){
         printf("Bad QUINSy R2Sonic header\n");
+        return;
+    }
+
+    uint64_t microEpoch = r2SonicDecoder.getTimestamp();
+    unsigned int nbBeams = r2SonicDecoder.getNbBeams();
+
+    const double * acrossTrackAngles = r2SonicDecoder.getAcrossTrackAngles();
+    const double * twoWayTravelTimes = r2SonicDecoder.getTwoWayTravelTimes();
+    const double * intensities = r2SonicDecoder.getIntensities();
+    const uint32_t * qualities = r2SonicDecoder.getQualities();
+
+    //Process the complete swath
+    for(unsigned int i=0;i<nbBeams;i++){
+        processor.processPing(
+                microEpoch,
+                i,
+                acrossTrackAngles[i],
+                0,
+                twoWayTravelTimes[i],
+                qualities[i],
+                intensities[i]
+        );
     }
 }
 
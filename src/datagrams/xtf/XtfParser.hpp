@@ -24,10 +24,25 @@
 #include <vector>
 #include "../../Ping.hpp"
 #include "../../math/SlantRangeCorrection.hpp"
+#include "XtfSampleDecoder.hpp"
+#include "QuinsyR2SonicDecoder.hpp"
+#include "../../sidescan/SidescanPingPool.hpp"
+#include "../../sidescan/SlantRangeResampler.hpp"
+#include "../../sidescan/BottomTracker.hpp"
+#include "../../sidescan/GainNormalizer.hpp"
+#include "../../sidescan/SidescanSwath.hpp"
+#include "../../utils/WorkerPool.hpp"
 
 #define MAGIC_NUMBER 123
 #define PACKET_MAGIC_NUMBER 0xFACE
 
+/*TypeOfChannel of the sidescan channels*/
+#define XTF_CHANNEL_PORT        1
+#define XTF_CHANNEL_STARBOARD   2
+
+/*Number of samples in a ping from which its channels are decoded in parallel*/
+#define XTF_PARALLEL_MIN_SAMPLES 8192
+
 /**
  * @author Guillaume Morissette
  *
@@ -35,6 +50,50 @@
  */
 
 
+/*!
+ * \brief XTF channel decoder
+ *
+ * Buffers and state of the decoding of one sidescan channel. Each channel has its own, so the channels of a ping
+ * are decoded concurrently.
+ */
+struct XtfChannelDecoder{
+        /**Create a channel decoder*/
+        XtfChannelDecoder() : gainNormalizer(NULL), pingChanHdr(NULL), data(NULL), copySamples(false), altitude(0), ping(NULL){}
+
+        /**Destroy the channel decoder*/
+        ~XtfChannelDecoder(){ if(gainNormalizer) delete gainNormalizer; }
+
+        /**samples of the channel being decoded, reused from packet to packet*/
+        std::vector<double> rawSamples;
+
+        /**slant range corrected samples of the channel being decoded, reused from packet to packet*/
+        std::vector<double> correctedSamples;
+
+        /**slant range to ground range resampler, which keeps the table of the last geometry*/
+        SlantRangeResampler slantRangeResampler;
+
+        /**finds the altitude of the sensor in the channel when the ping header does not give it*/
+        BottomTracker bottomTracker;
+
+        /**normalizes the gain of the ground range samples, NULL if disabled*/
+        GainNormalizer * gainNormalizer;
+
+        /**header of the channel in the packet being decoded, NULL between packets*/
+        XtfPingChanHeader * pingChanHdr;
+
+        /**raw samples of the channel in the packet being decoded*/
+        unsigned char * data;
+
+        /**true if the raw samples go to the ping as they are, without being converted to double*/
+        bool copySamples;
+
+        /**altitude of the sensor for the packet being decoded, 0 if unknown*/
+        double altitude;
+
+        /**ping of the packet being decoded*/
+        SidescanPing * ping;
+};
+
 /*!
  * \brief XTF parser class extention datagram parser
  * \author Guillaume Morissette
@@ -64,6 +123,22 @@ class XtfParser : public DatagramParser{
                 /**Return the number channels in the file*/
 		int getTotalNumberOfChannels();
 
+                /**
+                 * Normalize the across track gain of the sidescan channels while decoding them. The pings of normalized
+                 * channels store their samples as floats, so that targets brighter than their surroundings do not saturate.
+                 *
+                 * @param windowSize number of pings of each channel in the gain curve, 0 to disable normalization
+                 * @param nbBins number of bins of the gain curve
+                 */
+                void setGainNormalization(unsigned int windowSize,unsigned int nbBins = 90);
+
+                /**
+                 * Set the number of threads decoding the channels of a sidescan ping
+                 *
+                 * @param nbThreads number of threads, 0 for one thread per channel, 1 to decode the channels in sequence
+                 */
+                void setNbDecodingThreads(unsigned int nbThreads);
+
 	protected:
 
                 /**
@@ -110,13 +185,30 @@ class XtfParser : public DatagramParser{
 	        void processChanInfo(XtfChanInfo * c);
 
                 /**
-                 * Process sidescan data
-                 * @param hdr 
-                 * @param data
+                 * Decode the channels of a sidescan ping, in parallel, and give them to the processor as a swath
+                 *
+                 * @param pingHdr the ping header
+                 * @param decoders the decoders of the channels of the ping, located in the packet
                  */
-                void processSidescanData(XtfPingHeader & pingHdr,XtfPingChanHeader & pingChanHdr,void * data);
-                
-                
+                void processSidescanSwath(XtfPingHeader & pingHdr,std::vector<XtfChannelDecoder*> & decoders);
+
+                /**
+                 * Convert the samples of a channel, and find the altitude of the sensor if the ping header does not give it
+                 *
+                 * @param pingHdr the ping header
+                 * @param decoder the decoder of the channel
+                 */
+                void decodeChannelSamples(XtfPingHeader & pingHdr,XtfChannelDecoder & decoder);
+
+                /**
+                 * Correct the samples of a channel and store them in a ping
+                 *
+                 * @param pingHdr the ping header
+                 * @param decoder the decoder of the channel
+                 * @param microEpoch the timestamp of the ping
+                 */
+                void buildChannelPing(XtfPingHeader & pingHdr,XtfChannelDecoder & decoder,uint64_t microEpoch);
+
                 /**
                  * Process Quinsy R2Sonic packets
                  */
@@ -126,6 +218,36 @@ class XtfParser : public DatagramParser{
 		XtfFileHeader fileHeader;
                 
                 std::vector<XtfChanInfo*> channels;
+
+                /**sample converter of each channel, NULL if its sample format is not supported*/
+                std::vector<XtfSampleConverter> sampleConverters;
+
+                /**type in which the sidescan pings of each channel store their samples*/
+                std::vector<int> sampleTypes;
+
+                /**decoder of each channel*/
+                std::vector<XtfChannelDecoder*> channelDecoders;
+
+                /**decoders of the channels of the ping being decoded*/
+                std::vector<XtfChannelDecoder*> swathDecoders;
+
+                /**number of threads decoding the channels of a ping, 0 for one per channel*/
+                unsigned int nbDecodingThreads;
+
+                /**number of pings in the gain curve of each channel, 0 if gain normalization is disabled*/
+                unsigned int gainWindowSize;
+
+                /**number of bins of the gain curve of each channel*/
+                unsigned int gainNbBins;
+
+                /**decodes the QUINSy R2Sonic bathymetry packets, keeping its beam arrays from packet to packet*/
+                QuinsyR2SonicDecoder r2SonicDecoder;
+
+                /**recycles the sidescan pings given to the processor*/
+                SidescanPingPool pingPool;
+
+                /**decode the channels of the large pings in parallel, kept from ping to ping*/
+                WorkerPool decodingWorkers;
                 
 
 };
@@ -0,0 +1,122 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef XTFSAMPLEDECODER_HPP
+#define XTFSAMPLEDECODER_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include "../../sidescan/SidescanPing.hpp"
+
+/**
+* Converts the raw samples of a sidescan channel
+*
+* @param data the raw samples, in the byte order of the file, without any alignment
+* @param nbSamples the number of samples
+* @param samples receives the samples, with room for nbSamples
+*/
+typedef void (*XtfSampleConverter)(const unsigned char * data,unsigned int nbSamples,double * samples);
+
+/*!
+* \brief XTF sample decoder class
+*
+* Bulk converters of sidescan samples, one per sample type. A converter is selected once per channel, from the
+* SampleFormat and BytesPerSample of its XtfChanInfo, and converts a whole channel in a loop without branches that
+* the compiler vectorizes. Samples are copied with memcpy, since nothing aligns them in an XTF packet.
+*/
+class XtfSampleDecoder{
+public:
+
+  /**
+  * Returns the converter of a channel, or NULL if its samples are not supported
+  *
+  * @param sampleFormat the SampleFormat of the channel
+  * @param bytesPerSample the BytesPerSample of the channel
+  */
+  static XtfSampleConverter select(uint8_t sampleFormat,uint16_t bytesPerSample){
+    switch(sampleFormat){
+      case 0:
+        //Legacy: unsigned integers of BytesPerSample bytes
+        if(bytesPerSample == 1) return &convert<uint8_t>;
+        if(bytesPerSample == 2) return &convert<uint16_t>;
+        if(bytesPerSample == 4) return &convert<uint32_t>;
+        return NULL;
+
+      case 1:  return (bytesPerSample == 4) ? &convertIbmFloat : NULL;
+      case 2:  return &convert<uint32_t>;
+      case 3:  return &convert<uint16_t>;
+      case 5:  return &convert<float>;
+      case 8:  return &convert<uint8_t>;
+      default: return NULL;
+    }
+  }
+
+  /**
+  * Returns true if the samples of a channel are stored in the packets as a SIDESCAN_SAMPLE_ type, so that they can be
+  * copied into a ping without conversion
+  *
+  * @param sampleFormat the SampleFormat of the channel
+  * @param bytesPerSample the BytesPerSample of the channel
+  */
+  static bool isNative(uint8_t sampleFormat,uint16_t bytesPerSample){
+    XtfSampleConverter converter = select(sampleFormat,bytesPerSample);
+    return converter != NULL && converter != &convertIbmFloat;
+  }
+
+  /**
+  * Returns the SIDESCAN_SAMPLE_ type that holds the samples of a channel without loss, IBM floats becoming floats
+  *
+  * @param sampleFormat the SampleFormat of the channel
+  * @param bytesPerSample the BytesPerSample of the channel
+  */
+  static int getSampleType(uint8_t sampleFormat,uint16_t bytesPerSample){
+    XtfSampleConverter converter = select(sampleFormat,bytesPerSample);
+
+    if(converter == &convert<uint8_t>) return SIDESCAN_SAMPLE_UINT8;
+    if(converter == &convert<uint16_t>) return SIDESCAN_SAMPLE_UINT16;
+    if(converter == &convert<uint32_t>) return SIDESCAN_SAMPLE_UINT32;
+    if(converter == &convert<float> || converter == &convertIbmFloat) return SIDESCAN_SAMPLE_FLOAT;
+    return SIDESCAN_SAMPLE_DOUBLE;
+  }
+
+  /**
+  * Converts samples stored as a native type
+  *
+  * @param data the raw samples
+  * @param nbSamples the number of samples
+  * @param samples receives the samples
+  */
+  template<typename T>
+  static void convert(const unsigned char * data,unsigned int nbSamples,double * samples){
+    for(unsigned int i=0;i<nbSamples;i++){
+      T sample;
+      memcpy(&sample,data + i * sizeof(T),sizeof(T));
+      samples[i] = sample;
+    }
+  }
+
+  /**
+  * Converts samples stored as IBM System/360 single precision floats: a sign bit, a 7 bit base 16 exponent biased
+  * by 64 and a 24 bit fraction, the word being in the byte order of the file like the other sample types
+  *
+  * @param data the raw samples
+  * @param nbSamples the number of samples
+  * @param samples receives the samples
+  */
+  static void convertIbmFloat(const unsigned char * data,unsigned int nbSamples,double * samples){
+    for(unsigned int i=0;i<nbSamples;i++){
+      uint32_t word;
+      memcpy(&word,data + i * 4,4);
+
+      double fraction = (double)(word & 0x00FFFFFF);
+      int exponent = (int)((word >> 24) & 0x7F);
+      double sample = std::ldexp(fraction,4 * (exponent - 64) - 24);
+
+      samples[i] = (word & 0x80000000) ? -sample : sample;
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,136 @@
+/*
+ *  Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+#ifndef CONVEXHULLBENCHMARK_CPP
+#define CONVEXHULLBENCHMARK_CPP
+
+#ifdef _WIN32
+#include "../utils/getopt.h"
+#else
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <iostream>
+#include "../geometry/ConvexHull.hpp"
+
+using namespace std;
+
+/**Point of a synthetic line*/
+struct BenchmarkPoint{
+    float x;
+    float y;
+};
+
+/**Write the information about the program*/
+void printUsage(){
+	std::cerr << "\n\
+NAME\n\n\
+	convex-hull-benchmark - Times the convex hull of a synthetic line, sequential and parallel\n\n\
+SYNOPSIS\n \
+	convex-hull-benchmark [-n points] [-t threads]\n\n\
+DESCRIPTION\n \
+	-n Number of points of the line (default: 10000000)\n \
+	-t Number of threads of the parallel hull (default: all the hardware threads)\n\n \
+Copyright 2017-2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
+	exit(1);
+}
+
+/**
+  * Returns the seconds elapsed since a time
+  *
+  * @param start the time
+  */
+double secondsSince(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+  * Builds a curved swath of soundings and compares the sequential and parallel hulls
+  *
+  * @param argc number of argument
+  * @param argv value of the arguments
+  */
+int main (int argc , char ** argv){
+    unsigned long nbPoints = 10000000;
+    unsigned int nbThreads = 0;
+
+    int index;
+
+    while((index=getopt(argc,argv,"n:t:"))!=-1)
+    {
+        switch(index)
+        {
+            case 'n':
+                if(sscanf(optarg,"%lu", &nbPoints) != 1 || nbPoints == 0)
+                {
+                    std::cerr << "Invalid number of points (-n)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 't':
+                if(sscanf(optarg,"%u", &nbThreads) != 1)
+                {
+                    std::cerr << "Invalid number of threads (-t)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            default:
+                printUsage();
+            break;
+        }
+    }
+
+    //Pings of 400 beams across a 200 m swath, along a slowly turning track
+    std::mt19937 generator(42);
+    std::normal_distribution<float> noise(0.0f,0.05f);
+    std::vector<BenchmarkPoint> line(nbPoints);
+
+    for(unsigned long i=0;i<nbPoints;i++){
+        double along = (i / 400) * 0.2;
+        double across = (i % 400) * 0.5 - 100 + noise(generator);
+        double heading = along / 5000;
+
+        line[i].x = along * std::cos(heading) - across * std::sin(heading);
+        line[i].y = along * std::sin(heading) + across * std::cos(heading) + noise(generator);
+    }
+
+    std::cerr << "[+] " << nbPoints << " points" << std::endl;
+
+    //Sequential: copy and sort every point
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::vector<PointAndrews> copy;
+    copy.reserve(nbPoints);
+
+    for(uint64_t i=0;i<nbPoints;i++){
+        PointAndrews point = {line[i].x,line[i].y,i};
+        copy.push_back(point);
+    }
+
+    std::vector<PointAndrews> sequentialHull;
+    AndrewsConvex_hull(sequentialHull,copy);
+
+    double sequentialTime = secondsSince(start);
+
+    //Parallel, in place
+    start = std::chrono::steady_clock::now();
+
+    std::vector<PointAndrews> parallelHull;
+    ParallelConvexHull::compute(line,parallelHull,nbThreads);
+
+    double parallelTime = secondsSince(start);
+
+    std::cout << "Sequential: " << sequentialTime << " s, " << sequentialHull.size() << " vertices" << std::endl;
+    std::cout << "Parallel: " << parallelTime << " s, " << parallelHull.size() << " vertices" << std::endl;
+    std::cout << "Speedup: " << sequentialTime / parallelTime << std::endl;
+
+    return 0;
+}
+
+#endif
@@ -25,6 +25,7 @@
 #include "../filter/QualityFilter.hpp"
 #include "../filter/IntensityFilter.hpp"
 #include "../filter/InsanePositionFilter.hpp"
+#include "../filter/PlaneFitFilter.hpp"
 
 using namespace std;
 
@@ -34,8 +35,10 @@ void printUsage(){
   NAME\n\n\
      data-cleaning - Filtre les points d'un nuage\n\n\
   SYNOPSIS\n \
-	   data-cleaning [-q QualityFilter] [-i IntensityFilter]\n\n\
+	   data-cleaning [-q QualityFilter] [-i IntensityFilter] [-r maximum_residual] [-k neighbours]\n\n\
   DESCRIPTION\n\n \
+	-r Rejects the points further than maximum_residual from the plane fitted to their neighbours\n \
+	-k Number of neighbours used to fit the planes (default: 8)\n\n \
   Copyright 2017-2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
 	exit(1);
 }
@@ -58,7 +61,9 @@ int main(int argc,char** argv){
         int index;
         int quality;
         int intensity;
-        while((index=getopt(argc,argv,"q:i:"))!=-1)
+        double maximumResidual = -1;
+        int nbNeighbours = 8;
+        while((index=getopt(argc,argv,"q:i:r:k:"))!=-1)
         {
             switch(index)
             {
@@ -85,8 +90,34 @@ int main(int argc,char** argv){
                         filters.push_back(new IntensityFilter(intensity));
                     }
                 break;
+
+                case 'r':
+                    if(sscanf(optarg,"%lf", &maximumResidual) != 1 || maximumResidual < 0)
+                    {
+                        std::cerr << "Error: -r invalid maximum residual parameter" << std::endl;
+                        printUsage();
+                    }
+                break;
+
+                case 'k':
+                    if(sscanf(optarg,"%d", &nbNeighbours) != 1 || nbNeighbours < 3)
+                    {
+                        std::cerr << "Error: -k invalid neighbours parameter" << std::endl;
+                        printUsage();
+                    }
+                break;
             }
         }
+
+        //The plane fit needs the whole cleaned cloud, so its points are held until the end of the input
+        PlaneFitFilter * planeFitFilter = NULL;
+        std::vector<Eigen::Vector3d> cleanedPoints;
+        std::vector<std::pair<uint32_t,uint32_t> > cleanedAttributes;
+
+        if(maximumResidual >= 0){
+            planeFitFilter = new PlaneFitFilter(maximumResidual,nbNeighbours);
+        }
+
         unsigned int lineCount = 1;
         while((std::getline(std::cin,line))&&(line!="0")){
             double x,y,z;
@@ -105,7 +136,13 @@ int main(int argc,char** argv){
 		}
 
 		if(!doFilter){
-                    printf("%.6lf %.6lf %.6lf %d %d\n",x,y,z,quality,intensity);
+                    if(planeFitFilter){
+                        cleanedPoints.push_back(Eigen::Vector3d(x,y,z));
+                        cleanedAttributes.push_back(std::make_pair(quality,intensity));
+                    }
+                    else{
+                        printf("%.6lf %.6lf %.6lf %d %d\n",x,y,z,quality,intensity);
+                    }
 		}
             }
             else{
@@ -113,5 +150,19 @@ int main(int argc,char** argv){
             }
             lineCount++;
         }
+
+        if(planeFitFilter){
+            planeFitFilter->build(cleanedPoints);
+
+            for(unsigned int i=0;i<cleanedPoints.size();i++){
+                Eigen::Vector3d & point = cleanedPoints[i];
+
+                if(!planeFitFilter->filterPoint(0,point(0),point(1),point(2),cleanedAttributes[i].first,cleanedAttributes[i].second)){
+                    printf("%.6lf %.6lf %.6lf %d %d\n",point(0),point(1),point(2),cleanedAttributes[i].first,cleanedAttributes[i].second);
+                }
+            }
+
+            delete planeFitFilter;
+        }
     }
 #endif
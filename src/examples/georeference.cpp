@@ -12,6 +12,8 @@
 #include <fstream>
 #include <Eigen/Dense>
 #include "../georeferencing/DatagramGeoreferencer.hpp"
+#include "../georeferencing/IndexingGeoreferencer.hpp"
+#include "../georeferencing/MortonOrderGeoreferencer.hpp"
 #include "../datagrams/DatagramParserFactory.hpp"
 #include <iostream>
 #include <string>
@@ -30,11 +32,14 @@ void printUsage(){
 NAME\n\n\
 	georeference - Produces a georeferenced point cloud from binary multibeam echosounder datagrams files\n\n\
 SYNOPSIS\n \
-	georeference [-x lever_arm_x] [-y lever_arm_y] [-z lever_arm_z] [-r roll_angle] [-p pitch_angle] [-h heading_angle] [-s svp_file] [-S svpStrategy] file\n\n\
+	georeference [-x lever_arm_x] [-y lever_arm_y] [-z lever_arm_z] [-r roll_angle] [-p pitch_angle] [-h heading_angle] [-s svp_file] [-S svpStrategy] [-L | -T] [-c latitude,longitude[,height]] [-i index_file] [-m] file\n\n\
 DESCRIPTION\n \
-	-L Use a local geographic frame (NED)\n \
+	-L Use a local geographic frame (NED), centered on the mean of the positions of the file unless -c is given\n \
 	-T Use a terrestrial geographic frame (WGS84 ECEF)\n \
-        -S choose one: nearestTime or nearestLocation\n\n \
+	-c Center the local geographic frame on this position, so that lines georeferenced separately share it (implies -L)\n \
+        -S choose one: nearestTime or nearestLocation\n \
+	-i Write the points to a spatial index file, to be queried by bounding box, instead of the standard output\n \
+	-m Output the points in Morton (Z-curve) order instead of time order, for better spatial locality (needs -L or -c)\n\n \
 Copyright 2017-2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
 	exit(1);
 }
@@ -79,11 +84,17 @@ int main (int argc , char ** argv){
         Georeferencing * georef = NULL;
 
 	std::string	     svpFilename;
+	std::string	     indexFilename;
+	bool	     mortonOrder = false;
+	bool	     hasCentroid = false;
+	double	     centroidLatitude = 0.0;
+	double	     centroidLongitude = 0.0;
+	double	     centroidHeight = 0.0;
 	CarisSvpFile svps;
 
         int index;
 
-        while((index=getopt(argc,argv,"x:y:z:r:p:h:s:S:LT"))!=-1)
+        while((index=getopt(argc,argv,"x:y:z:r:p:h:s:S:i:c:mLT"))!=-1)
         {
             switch(index)
             {
@@ -160,6 +171,23 @@ int main (int argc , char ** argv){
                         }
                         break;
 
+                case 'i':
+                    indexFilename = optarg;
+                break;
+
+                case 'm':
+                    mortonOrder = true;
+                break;
+
+                case 'c':
+                    if(sscanf(optarg,"%lf,%lf,%lf", &centroidLatitude, &centroidLongitude, &centroidHeight) < 2)
+                    {
+                        std::cerr << "Invalid centroid (-c)" << std::endl;
+                        printUsage();
+                    }
+                    hasCentroid = true;
+                break;
+
                 case 'L':
                     georef = new GeoreferencingLGF();
                 break;
@@ -170,11 +198,35 @@ int main (int argc , char ** argv){
             }
         }
 
+        if(hasCentroid){
+            if(georef == NULL){
+                georef = new GeoreferencingLGF();
+            }
+
+            GeoreferencingLGF * lgf = dynamic_cast<GeoreferencingLGF*>(georef);
+
+            if(lgf == NULL){
+                std::cerr << "The centroid (-c) needs the local geographic frame (-L)" << std::endl;
+                printUsage();
+            }
+
+            Position centroid(0, centroidLatitude, centroidLongitude, centroidHeight);
+            lgf->setCentroid(centroid);
+
+            std::cerr << "[+] Centroid: " << centroid << std::endl;
+        }
+
         if(georef == NULL){
             std::cerr << "[+] No georeferencing method defined (-L or -T). Using TRF by default" << std::endl;
             georef = new GeoreferencingTRF();
         }
         
+        //The Z-order follows x and y: in ECEF they are not a horizontal plane
+        if(mortonOrder && dynamic_cast<GeoreferencingLGF*>(georef) == NULL){
+            std::cerr << "Morton order (-m) needs the local geographic frame (-L)" << std::endl;
+            printUsage();
+        }
+
         if(svpStrategy == NULL){
             std::cerr << "[+] Using nearest in time sound velocity profile selection strategy by default" << std::endl;
             svpStrategy = new SvpNearestByTime();
@@ -183,13 +235,24 @@ int main (int argc , char ** argv){
         try
         {
             DatagramParser * parser = NULL;
-            DatagramGeoreferencer  printer(*georef, *svpStrategy);
+            DatagramGeoreferencer * printer = NULL;
+            MortonSorter sorter;
+
+            if(!indexFilename.empty()){
+                printer = new IndexingGeoreferencer(*georef, *svpStrategy, indexFilename);
+            }
+            else if(mortonOrder){
+                printer = new MortonOrderGeoreferencer(*georef, *svpStrategy, sorter);
+            }
+            else{
+                printer = new DatagramGeoreferencer(*georef, *svpStrategy);
+            }
 
             std::cerr << "[+] Decoding " << fileName << std::endl;
             std::ifstream inFile;
             inFile.open(fileName);
             if (inFile) {
-                    parser = DatagramParserFactory::build(fileName,printer);
+                    parser = DatagramParserFactory::build(fileName,*printer);
             }
             else
             {
@@ -209,9 +272,10 @@ int main (int argc , char ** argv){
             Boresight::buildMatrix(boresight,boresightAngles);
             
             //Do the georeference dance
-            printer.georeference(leverArm, boresight, svps.getSvps());
+            printer->georeference(leverArm, boresight, svps.getSvps());
 
             delete parser;
+            delete printer;
         }
         catch(Exception * error)
         {
@@ -0,0 +1,294 @@
+/*
+ *  Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+#ifndef GRIDDING_CPP
+#define GRIDDING_CPP
+
+#ifdef _WIN32
+#include "../utils/getopt.h"
+#pragma comment(lib, "Ws2_32.lib")
+#endif
+
+#include <fstream>
+#include <Eigen/Dense>
+#include "../georeferencing/GriddingGeoreferencer.hpp"
+#include "../datagrams/DatagramParserFactory.hpp"
+#include <iostream>
+#include <string>
+#include "../utils/Exception.hpp"
+#include "../math/Boresight.hpp"
+#include "../svp/CarisSvpFile.hpp"
+#include "../svp/SvpSelectionStrategy.hpp"
+#include "../svp/SvpNearestByTime.hpp"
+#include "../svp/SvpNearestByLocation.hpp"
+
+using namespace std;
+
+/**Write the information about the program*/
+void printUsage(){
+	std::cerr << "\n\
+NAME\n\n\
+	gridding - Produces a gridded digital terrain model from binary multibeam echosounder datagrams files\n\n\
+SYNOPSIS\n \
+	gridding [-g resolution] [-t threads] [-o tile_directory] [-l levels] [-x lever_arm_x] [-y lever_arm_y] [-z lever_arm_z] [-r roll_angle] [-p pitch_angle] [-h heading_angle] [-s svp_file] [-S svpStrategy] file\n\n\
+DESCRIPTION\n \
+	-g Size of a grid cell, in meters with -L (default: 1) and in decimal degrees with -T (required)\n \
+	-t Number of gridding threads (default: all the hardware threads)\n \
+	-o Write the grid as a pyramid of tiles in this existing directory instead of the standard output\n \
+	-l Number of levels of the tile pyramid, each level halving the resolution of the level below (default: 1)\n \
+	Each cell is written as: x y count mean minimum maximum variance\n \
+	-L Use a local geographic frame (NED), the default\n \
+	-T Grid in longitude and latitude against the ellipsoidal height\n \
+        -S choose one: nearestTime or nearestLocation\n\n \
+Copyright 2017-2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
+	exit(1);
+}
+
+/**
+  * declare the parser depending on argument receive
+  * 
+  * @param argc number of argument
+  * @param argv value of the arguments
+  */
+int main (int argc , char ** argv){
+
+#ifdef __GNU__
+	setenv("TZ", "UTC", 1);
+#endif
+#ifdef _WIN32
+	putenv("TZ");
+#endif
+    if(argc < 2)
+    {
+        printUsage();
+    }
+    else
+    {
+        std::string fileName(argv[argc-1]);
+
+        //Lever arm
+        double leverArmX = 0.0;
+        double leverArmY = 0.0;
+        double leverArmZ = 0.0;
+
+        //Boresight
+        double roll     = 0.0;
+        double pitch    = 0.0;
+        double heading  = 0.0;
+        
+        //SVP strategy
+        std::string userSelectedStrategy;
+        SvpSelectionStrategy * svpStrategy = NULL;
+
+        //Georeference method
+        Georeferencing * georef = NULL;
+
+	std::string	     svpFilename;
+	CarisSvpFile svps;
+
+        //Grid
+        double resolution = 1.0;
+        bool hasResolution = false;
+        unsigned int nbThreads = 0;
+        std::string tileDirectory;
+        unsigned int nbLevels = 1;
+
+        int index;
+
+        while((index=getopt(argc,argv,"g:t:o:l:x:y:z:r:p:h:s:S:LT"))!=-1)
+        {
+            switch(index)
+            {
+                case 'g':
+                    if(sscanf(optarg,"%lf", &resolution) != 1 || resolution <= 0)
+                    {
+                        std::cerr << "Invalid grid resolution (-g)" << std::endl;
+                        printUsage();
+                    }
+                    hasResolution = true;
+                break;
+
+                case 't':
+                    if(sscanf(optarg,"%u", &nbThreads) != 1)
+                    {
+                        std::cerr << "Invalid number of threads (-t)" << std::endl;
+                        printUsage();
+                    }
+                break;
+
+                case 'o':
+                    tileDirectory = optarg;
+                break;
+
+                case 'l':
+                    if(sscanf(optarg,"%u", &nbLevels) != 1 || nbLevels < 1)
+                    {
+                        std::cerr << "Invalid number of levels (-l)" << std::endl;
+                        printUsage();
+                    }
+                break;
+
+                case 'x':
+                    if(sscanf(optarg,"%lf", &leverArmX) != 1)
+                    {
+                        std::cerr << "Invalid lever arm X offset (-x)" << std::endl;
+                        printUsage();
+                    }
+               break;
+
+                case 'y':
+                    if (sscanf(optarg,"%lf", &leverArmY) != 1)
+                    {
+                        std::cerr << "Invalid lever arm Y offset (-y)" << std::endl;
+                        printUsage();
+                    }
+                break;
+
+                case 'z':
+                    if (sscanf(optarg,"%lf", &leverArmZ) != 1)
+                    {
+                        std::cerr << "Invalid lever arm Z offset (-z)" << std::endl;
+                        printUsage();
+                    }
+                break;
+
+                case 'r':
+                    if (sscanf(optarg,"%lf", &roll) != 1)
+                    {
+                        std::cerr << "Invalid roll angle offset (-r)" << std::endl;
+                        printUsage();
+                    }
+                break;
+
+                case 'h':
+                    if (sscanf(optarg,"%lf", &heading) != 1)
+                    {
+                        std::cerr << "Invalid heading angle offset (-h)" << std::endl;
+                        printUsage();
+                    }
+                break;
+
+                case 'p':
+                    if (sscanf(optarg,"%lf", &pitch) != 1)
+                    {
+                        std::cerr << "Invalid pitch angle offset (-p)" << std::endl;
+                        printUsage();
+                    }
+                break;
+
+		case 's':
+			svpFilename = optarg;
+			if(!svps.readSvpFile(svpFilename)){
+				std::cerr << "Invalid SVP file (-s)" << std::endl;
+				printUsage();
+			}
+                        break;
+                        
+                case 'S':
+			userSelectedStrategy = optarg;
+                        if(userSelectedStrategy == "nearestLocation") {
+                            std::cerr << "[+] Using nearest location sound velocity profile selection strategy" << std::endl;
+                            svpStrategy = new SvpNearestByLocation();
+                        } else if(userSelectedStrategy == "nearestTime") {
+                            std::cerr << "[+] Using nearest location sound velocity profile selection strategy" << std::endl;
+                            svpStrategy = new SvpNearestByTime();
+                        } else {
+                            std::cerr << "Invalid SVP strategy (-S): " << userSelectedStrategy << std::endl;
+                            std::cerr << "Possible choices are:" << std::endl;
+                            std::cerr << "-S nearestTime" << std::endl;
+                            std::cerr << "-S nearestLocation" << std::endl;
+                            printUsage();
+                        }
+                        break;
+
+                case 'L':
+                    georef = new GeoreferencingLGF();
+                break;
+
+                case 'T':
+                    georef = new GeoreferencingTRF();
+                break;
+            }
+        }
+
+        if(georef == NULL){
+            std::cerr << "[+] No georeferencing method defined (-L or -T). Using LGF by default" << std::endl;
+            georef = new GeoreferencingLGF();
+        }
+
+        //A default of 1 degree would grid a survey into a cell or two
+        if(!hasResolution && dynamic_cast<GeoreferencingTRF*>(georef) != NULL){
+            std::cerr << "A grid resolution in decimal degrees (-g) is required with -T" << std::endl;
+            printUsage();
+        }
+        
+        if(svpStrategy == NULL){
+            std::cerr << "[+] Using nearest in time sound velocity profile selection strategy by default" << std::endl;
+            svpStrategy = new SvpNearestByTime();
+        }
+
+        try
+        {
+            DatagramParser * parser = NULL;
+            DtmGrid grid(resolution);
+            TiledDtm * tiles = NULL;
+            GriddingGeoreferencer * gridder = NULL;
+
+            if(tileDirectory.empty()){
+                gridder = new GriddingGeoreferencer(*georef, *svpStrategy, grid, nbThreads);
+            }
+            else{
+                tiles = new TiledDtm(resolution, tileDirectory);
+                gridder = new GriddingGeoreferencer(*georef, *svpStrategy, *tiles, nbThreads);
+            }
+
+            std::cerr << "[+] Decoding " << fileName << std::endl;
+            std::ifstream inFile;
+            inFile.open(fileName);
+            if (inFile) {
+                    parser = DatagramParserFactory::build(fileName,*gridder);
+            }
+            else
+            {
+                throw new Exception("File not found: " + fileName);
+            }
+            parser->parse(fileName);
+            std::cout << std::setprecision(6);
+            std::cout << std::fixed;
+
+            //Lever arm
+            Eigen::Vector3d leverArm;
+            leverArm << leverArmX,leverArmY,leverArmZ;
+
+            //Boresight
+            Attitude boresightAngles(0,roll,pitch,heading);
+            Eigen::Matrix3d boresight;
+            Boresight::buildMatrix(boresight,boresightAngles);
+            
+            //Do the georeference dance
+            gridder->georeference(leverArm, boresight, svps.getSvps());
+
+            if(tileDirectory.empty()){
+                std::cerr << "[+] Writing " << grid.getNbCells() << " cells" << std::endl;
+                grid.write(std::cout);
+            }
+            else{
+                tiles->buildPyramid(nbLevels);
+                tiles->flush();
+                std::cerr << "[+] Wrote " << tiles->getTiles(0).size() << " tiles at level 0 in " << tileDirectory << std::endl;
+            }
+
+            delete gridder;
+
+            if(tiles) delete tiles;
+
+            delete parser;
+        }
+        catch(Exception * error)
+        {
+            std::cerr << "[-] Error while parsing " << fileName << ": " << error->what() << std::endl;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ *  Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+#ifndef OVERLAPMATRIX_CPP
+#define OVERLAPMATRIX_CPP
+
+#ifdef _WIN32
+#include "../utils/getopt.h"
+#else
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <string>
+#include "../geometry/OverlapMatrix.hpp"
+#include "../utils/Exception.hpp"
+
+using namespace std;
+
+/**Write the information about the program*/
+void printUsage(){
+	std::cerr << "\n\
+NAME\n\n\
+	overlap-matrix - Finds every pair of overlapping lines in a survey\n\n\
+SYNOPSIS\n \
+	overlap-matrix [-f cell_size] [-t threads] file1 file2 ...\n\n\
+DESCRIPTION\n \
+	Each file is a line of georeferenced points, one \"x y z\" point per text line. Every line must be in the same\n \
+	horizontal frame, such as the output of georeference -c latitude,longitude with the same centroid for every line.\n \
+	The default frame of georeference (ECEF) is not horizontal, and -L alone centers each line on its own positions.\n \
+	-f Size of the cells of the line footprints (default: 1)\n \
+	-t Number of threads (default: all the hardware threads)\n \
+	Each overlapping pair is written as: file1 file2 cells points1 points2\n\n \
+Copyright 2017-2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
+	exit(1);
+}
+
+/**
+  * Reads the lines given as arguments and writes their overlap matrix
+  *
+  * @param argc number of argument
+  * @param argv value of the arguments
+  */
+int main (int argc , char ** argv){
+    double cellSize = 1.0;
+    unsigned int nbThreads = 0;
+
+    int index;
+
+    while((index=getopt(argc,argv,"f:t:"))!=-1)
+    {
+        switch(index)
+        {
+            case 'f':
+                if(sscanf(optarg,"%lf", &cellSize) != 1 || cellSize <= 0)
+                {
+                    std::cerr << "Invalid cell size (-f)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 't':
+                if(sscanf(optarg,"%u", &nbThreads) != 1)
+                {
+                    std::cerr << "Invalid number of threads (-t)" << std::endl;
+                    printUsage();
+                }
+            break;
+        }
+    }
+
+    if(optind + 2 > argc)
+    {
+        printUsage();
+    }
+
+    try
+    {
+        OverlapMatrix matrix(cellSize, nbThreads);
+
+        for(int i=optind;i<argc;i++){
+            std::string fileName(argv[i]);
+            std::ifstream inFile(fileName);
+
+            if(!inFile){
+                throw new Exception("File not found: " + fileName);
+            }
+
+            std::cerr << "[+] Reading " << fileName << std::endl;
+
+            uint32_t line = matrix.addLine(fileName);
+            std::string text;
+
+            //Header and malformed lines are skipped
+            while(std::getline(inFile, text)){
+                std::istringstream lineStream(text);
+                double x, y, z;
+
+                if(lineStream >> x >> y >> z){
+                    matrix.addPoint(line, x, y);
+                }
+            }
+        }
+
+        matrix.compute();
+
+        std::cerr << "[+] " << matrix.getOverlaps().size() << " overlapping pairs" << std::endl;
+
+        matrix.write(std::cout);
+    }
+    catch(Exception * error)
+    {
+        std::cerr << "[-] Error: " << error->what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+#endif
@@ -52,10 +52,15 @@ void printUsage(){
 	NAME\n\n\
 	overlap - Displays the overlap area between two multibeam echosounder datagram files\n\n\
 	SYNOPSIS\n \
-	overlap [-x lever_arm_x] [-y lever_arm_y] [-z lever_arm_z] [-r roll_angle] [-p pitch_angle] [-h heading_angle] [-s svp_file] [-c svp_file1] [-v svp_file2] file1 file2 a b c d alpha1 alpha2\n\n\
+	overlap [-x lever_arm_x] [-y lever_arm_y] [-z lever_arm_z] [-r roll_angle] [-p pitch_angle] [-h heading_angle] [-s svp_file] [-c svp_file1] [-v svp_file2] [-f cell_size] [-g resolution] [-d cell_size] file1 file2 a b c d alpha1 alpha2\n\n\
 	DESCRIPTION\n \
 	-L          Use a local geographic frame (NED)\n \
 	-T          Use a terrestrial geographic frame (WGS84 ECEF)\n \
+	-f          Find the overlap with raster footprints of cell_size instead of hulls (alpha1 and alpha2 are ignored)\n \
+	-g          Grid both lines in the overlap with cells of resolution and report the depth differences\n \
+	-d          Keep only the first point of each voxel of cell_size before finding the overlap. Expects -L: with -T\n \
+	            the voxels are cubes of the ECEF frame. It bounds the point clouds by the area covered, but the pings\n \
+	            of sonar files are still all read into memory before they are georeferenced\n \
 	a, b, c, d  Coefficients to define the projection plane, ax + by + cz + d = 0\n \
 	alpha1      Concave hull computation parameter to use with file #1\n \
 	alpha2      Concave hull computation parameter to use with file #2\n\n \
@@ -100,11 +105,20 @@ int main( int argc, char* argv[] )
     bool svpFilename1Provided = false;
     bool svpFilename2Provided = false;
 
+    // Raster footprint cell size, 0 to use hulls
+    double footprintCellSize = 0;
+
+    // Depth differences grid resolution, 0 to skip
+    double differenceResolution = 0;
+
+    // Decimation voxel size, 0 to keep every point
+    double decimationCellSize = 0;
+
     // Read -L or -T, optional parameters preceded by "-"
 
 	int index;
 
-	while((index=getopt(argc,argv,"x:y:z:r:p:h:s:c:v:LT"))!=-1)
+	while((index=getopt(argc,argv,"x:y:z:r:p:h:s:c:v:f:g:d:LT"))!=-1)
 	{
 		switch(index)
 		{
@@ -201,6 +215,30 @@ int main( int argc, char* argv[] )
                 break;  
 
 
+            case 'f':
+                if ( sscanf( optarg, "%lf", &footprintCellSize ) != 1 || footprintCellSize <= 0 )
+                {
+                    std::cerr << "Invalid footprint cell size (-f)" << std::endl;
+                    printUsage();
+                }
+                break;
+
+            case 'g':
+                if ( sscanf( optarg, "%lf", &differenceResolution ) != 1 || differenceResolution <= 0 )
+                {
+                    std::cerr << "Invalid depth differences grid resolution (-g)" << std::endl;
+                    printUsage();
+                }
+                break;
+
+            case 'd':
+                if ( sscanf( optarg, "%lf", &decimationCellSize ) != 1 || decimationCellSize <= 0 )
+                {
+                    std::cerr << "Invalid decimation cell size (-d)" << std::endl;
+                    printUsage();
+                }
+                break;
+
 			case 'L':
 				LorTPresent = true;
 				DoLGF = true;
@@ -214,6 +252,11 @@ int main( int argc, char* argv[] )
 	}
 
 
+	if ( decimationCellSize > 0 && LorTPresent && ! DoLGF )
+	{
+		std::cerr << "Decimation voxels (-d) are cubes of the ECEF frame with -T, use -L for horizontal voxels" << std::endl;
+	}
+
 	Eigen::Vector3d	leverArm( leverArmX, leverArmY, leverArmZ );
 
 	Attitude boresightAngles( 0, roll, pitch, heading );
@@ -325,6 +368,26 @@ int main( int argc, char* argv[] )
         if ( StringUtils::ends_with( twoFileNames[ count ].c_str(),".txt" ) )
         {
             readTextFileIntoPointCloud( twoFileNames[ count ], twoLines[ count ] );
+
+            if ( decimationCellSize > 0 )
+            {
+                // Decimate in place, keeping the first point of each voxel
+                VoxelDecimator decimator( decimationCellSize );
+
+                uint64_t kept = 0;
+
+                for ( uint64_t countPoint = 0; countPoint < twoLines[ count ]->points.size(); countPoint++ )
+                {
+                    const pcl::PointXYZ & point = twoLines[ count ]->points[ countPoint ];
+
+                    if ( decimator.add( point.x, point.y, point.z ) )
+                        twoLines[ count ]->points[ kept++ ] = point;
+                }
+
+                twoLines[ count ]->points.resize( kept );
+                twoLines[ count ]->width = kept;
+                twoLines[ count ]->height = 1;
+            }
         }
         else // Georeference
         {
@@ -343,7 +406,7 @@ int main( int argc, char* argv[] )
             try
             {
                 readSonarFileIntoPointCloud( twoFileNames[ count ], twoLines[ count ], leverArm , boresight, 
-                                                twoSvpFilenames[ count ], DoLGF );
+                                                twoSvpFilenames[ count ], DoLGF, decimationCellSize );
             }
             catch ( Exception * error )
             {
@@ -382,7 +445,9 @@ int main( int argc, char* argv[] )
 
     std::cout << "\n\nProcessing to find the overlap\n" << std::endl;
 
-    HullOverlap hullOverlap( line1, line2, a, b, c, d, "Andrew's", alphaLine1, alphaLine2 );
+    std::string hullMethod = ( footprintCellSize > 0 ) ? "Raster footprint" : "Andrew's";
+
+    HullOverlap hullOverlap( line1, line2, a, b, c, d, hullMethod, alphaLine1, alphaLine2, footprintCellSize );
 
 
     std::pair< uint64_t, uint64_t > inBothHulls = hullOverlap.computePointsInBothHulls( line1InBothHulls, 
@@ -391,6 +456,15 @@ int main( int argc, char* argv[] )
     std::cout << "Nb points line1 in both hulls: " << inBothHulls.first
         << "\nNb points line2 in both hulls: " << inBothHulls.second << "\n" << std::endl;
 
+    if ( differenceResolution > 0 )
+    {
+        OverlapDifference differences;
+        hullOverlap.computeDepthDifferences( line1InBothHulls, line2InBothHulls, differenceResolution, differences );
+
+        std::cout << "Depth differences, line #2 minus line #1:\n";
+        differences.write( std::cout );
+    }
+
 
     std::chrono::high_resolution_clock::time_point tEnd = std::chrono::high_resolution_clock::now();
     cout << "\n\nTotal time: " << std::chrono::duration_cast<std::chrono::seconds>(tEnd - tStart).count() << "s" << endl;       
@@ -0,0 +1,288 @@
+/*
+ *  Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+#ifndef SIDESCANMOSAIC_CPP
+#define SIDESCANMOSAIC_CPP
+
+#ifdef _WIN32
+#include "../utils/getopt.h"
+#else
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <Eigen/Dense>
+#include "../datagrams/DatagramParserFactory.hpp"
+#include "../sidescan/SidescanMosaic.hpp"
+#include "../math/CoordinateTransform.hpp"
+
+using namespace std;
+
+/**Write the information about the program*/
+void printUsage(){
+	std::cerr << "\n\
+NAME\n\n\
+	sidescan-mosaic - Mosaics the ground range sidescan pings of one or more lines\n\n\
+SYNOPSIS\n \
+	sidescan-mosaic [-r cellSize] [-b blend] [-n gap] [-g window] [-t threads] [-o output] file [file ...]\n\n\
+DESCRIPTION\n \
+	-r Size of a cell in meters (default: 0.5)\n \
+	-b Blend rule of the overlapping lines: mean, max, latest or nadir (default: mean)\n \
+	-n Ground range of the nadir gap in meters, whose samples are left out (default: 0)\n \
+	-g Normalize the across track gain of the XTF channels over this number of pings (default: no normalization)\n \
+	-t Number of threads (default: all the hardware threads)\n \
+	-o Output file, \"north east value\" per cell in the local frame of the first position (default: standard output)\n\n \
+Copyright 2017-2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
+	exit(1);
+}
+
+/*!
+* \brief Sidescan mosaic builder class
+*
+* Feeds the navigation and the sidescan swaths of the parsed files to a mosaic, in the local NED frame of the first
+* position
+*/
+class SidescanMosaicBuilder : public DatagramEventHandler{
+public:
+
+	/**
+	* Creates a sidescan mosaic builder
+	*
+	* @param mosaic the mosaic to fill
+	*/
+	SidescanMosaicBuilder(SidescanMosaic & mosaic) : mosaic(mosaic), hasOrigin(false){
+
+	}
+
+	/**Destroys the sidescan mosaic builder*/
+	~SidescanMosaicBuilder(){
+
+	}
+
+	/**
+	* Adds the heading of an attitude
+	*
+	* @param microEpoch the attitude timestamp
+	* @param heading the attitude heading
+	* @param pitch the attitude pitch
+	* @param roll the attitude roll
+	*/
+	void processAttitude(uint64_t microEpoch,double heading,double pitch,double roll){
+		mosaic.addHeading(microEpoch,heading);
+	}
+
+	/**
+	* Adds a position
+	*
+	* @param microEpoch the position timestamp
+	* @param longitude the position longitude
+	* @param latitude the position latitude
+	* @param height the position ellipsoidal height
+	*/
+	void processPosition(uint64_t microEpoch,double longitude,double latitude,double height){
+		Position position(microEpoch,latitude,longitude,height);
+		addPosition(position);
+	}
+
+	/**
+	* Adds the position of a swath, then its port and starboard channels
+	*
+	* @param swath the swath
+	*/
+	void processSidescanSwath(SidescanSwath * swath){
+		if(swath->getPosition() != NULL){
+			addPosition(*swath->getPosition());
+		}
+
+		mosaic.addSwath(*swath);
+
+		delete swath;
+	}
+
+private:
+
+	/**
+	* Adds a position in the local frame of the first position
+	*
+	* @param position the geographic position
+	*/
+	void addPosition(Position & position){
+		if(!hasOrigin){
+			CoordinateTransform::getTerrestialToLocalGeodeticReferenceFrameMatrix(navDCM,position);
+			CoordinateTransform::getPositionECEF(originECEF,position);
+			hasOrigin = true;
+		}
+
+		Eigen::Vector3d local;
+		CoordinateTransform::getPositionInNavigationFrame(local,position,navDCM,originECEF);
+
+		mosaic.addPosition(position.getTimestamp(),local(0),local(1));
+	}
+
+	/**Mosaic to fill*/
+	SidescanMosaic & mosaic;
+
+	/**True once the origin of the local frame is set*/
+	bool hasOrigin;
+
+	/**Rotation from ECEF to the local frame*/
+	Eigen::Matrix3d navDCM;
+
+	/**Origin of the local frame, in ECEF*/
+	Eigen::Vector3d originECEF;
+};
+
+/**
+  * Mosaics the sidescan files given as arguments, one line per file
+  *
+  * @param argc number of argument
+  * @param argv value of the arguments
+  */
+int main (int argc , char ** argv){
+    double cellSize = 0.5;
+    int blendRule = MOSAIC_BLEND_MEAN;
+    unsigned int nbThreads = 0;
+    unsigned int gainWindow = 0;
+    double nadirGap = 0;
+    std::string outputFile;
+
+    #ifdef __GNU__
+    setenv("TZ", "UTC", 1);
+    #endif
+    #ifdef _WIN32
+    putenv("TZ");
+    #endif
+
+    int index;
+
+    while((index=getopt(argc,argv,"r:b:n:g:t:o:"))!=-1)
+    {
+        switch(index)
+        {
+            case 'r':
+                if(sscanf(optarg,"%lf", &cellSize) != 1 || !(cellSize > 0))
+                {
+                    std::cerr << "Invalid cell size (-r)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 'b':
+            {
+                std::string blend(optarg);
+
+                if(blend == "mean") blendRule = MOSAIC_BLEND_MEAN;
+                else if(blend == "max") blendRule = MOSAIC_BLEND_MAXIMUM;
+                else if(blend == "latest") blendRule = MOSAIC_BLEND_LATEST_LINE;
+                else if(blend == "nadir") blendRule = MOSAIC_BLEND_NEAREST_NADIR;
+                else
+                {
+                    std::cerr << "Invalid blend rule (-b)" << std::endl;
+                    printUsage();
+                }
+            }
+            break;
+
+            case 'n':
+                if(sscanf(optarg,"%lf", &nadirGap) != 1 || nadirGap < 0)
+                {
+                    std::cerr << "Invalid nadir gap (-n)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 'g':
+                if(sscanf(optarg,"%u", &gainWindow) != 1)
+                {
+                    std::cerr << "Invalid gain normalization window (-g)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 't':
+                if(sscanf(optarg,"%u", &nbThreads) != 1)
+                {
+                    std::cerr << "Invalid number of threads (-t)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 'o':
+                outputFile = optarg;
+            break;
+
+            default:
+                printUsage();
+            break;
+        }
+    }
+
+    if(optind >= argc){
+        printUsage();
+    }
+
+    SidescanMosaic mosaic(cellSize,blendRule,256,nbThreads);
+    mosaic.setNadirGap(nadirGap);
+    SidescanMosaicBuilder builder(mosaic);
+
+    for(int i=optind;i<argc;i++){
+        std::string fileName(argv[i]);
+        DatagramParser * parser = NULL;
+
+        try{
+            std::cerr << "[+] Decoding " << fileName << std::endl;
+
+            mosaic.startLine();
+
+            parser = DatagramParserFactory::build(fileName,builder);
+
+            XtfParser * xtfParser = dynamic_cast<XtfParser *>(parser);
+
+            if(xtfParser){
+                xtfParser->setGainNormalization(gainWindow);
+            }
+
+            parser->parse(fileName);
+        }
+        catch(Exception * error){
+            std::cerr << "[-] Error while parsing " << fileName << ": " << error->what() << std::endl;
+        }
+        catch(const char * error){
+            std::cerr << "[-] Error while parsing " << fileName << ": " << error << std::endl;
+        }
+
+        if(parser) delete parser;
+    }
+
+    try{
+        mosaic.finish();
+    }
+    catch(Exception * error){
+        std::cerr << "[-] Error while mosaicking: " << error->what() << std::endl;
+        delete error;
+        return 1;
+    }
+
+    std::cerr << "[+] " << mosaic.getNbRenderedPings() << " pings in " << mosaic.getNbTiles() << " tiles" << std::endl;
+
+    if(outputFile.empty()){
+        mosaic.write(std::cout);
+    }
+    else{
+        std::ofstream out(outputFile.c_str());
+
+        if(!out.is_open()){
+            std::cerr << "[-] Cannot open " << outputFile << std::endl;
+            return 1;
+        }
+
+        mosaic.write(out);
+    }
+
+    return 0;
+}
+
+#endif
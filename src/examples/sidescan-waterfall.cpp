@@ -0,0 +1,158 @@
+/*
+ *  Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+#ifndef SIDESCANWATERFALL_CPP
+#define SIDESCANWATERFALL_CPP
+
+#ifdef _WIN32
+#include "../utils/getopt.h"
+#else
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include "../datagrams/DatagramParserFactory.hpp"
+#include "../sidescan/WaterfallPyramid.hpp"
+
+using namespace std;
+
+/**Write the information about the program*/
+void printUsage(){
+	std::cerr << "\n\
+NAME\n\n\
+	sidescan-waterfall - Writes the port and starboard waterfalls of sidescan files as tile pyramids\n\n\
+SYNOPSIS\n \
+	sidescan-waterfall [-s tileSize] [-l levels] file [file ...]\n\n\
+DESCRIPTION\n \
+	The pyramid of a file is written alongside it, with the .wfp extension appended\n \
+	-s Number of pixels on a side of a tile (default: 256)\n \
+	-l Number of levels of the pyramid, each level halving the pings and samples of the level below (default: 8)\n\n \
+Copyright 2017-2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés" << std::endl;
+	exit(1);
+}
+
+/*!
+* \brief Waterfall writer class
+*
+* Adds the sidescan swaths of a parsed file to a waterfall pyramid
+*/
+class WaterfallWriter : public DatagramEventHandler{
+public:
+
+	/**
+	* Creates a waterfall writer
+	*
+	* @param pyramid the pyramid to fill
+	*/
+	WaterfallWriter(WaterfallPyramid & pyramid) : pyramid(pyramid){
+
+	}
+
+	/**Destroys the waterfall writer*/
+	~WaterfallWriter(){
+
+	}
+
+	/**
+	* Adds the port and starboard channels of a swath
+	*
+	* @param swath the swath
+	*/
+	void processSidescanSwath(SidescanSwath * swath){
+		pyramid.add(*swath);
+
+		delete swath;
+	}
+
+private:
+
+	/**Pyramid to fill*/
+	WaterfallPyramid & pyramid;
+};
+
+/**
+  * Writes the waterfall pyramid of every file given as argument
+  *
+  * @param argc number of argument
+  * @param argv value of the arguments
+  */
+int main (int argc , char ** argv){
+    unsigned int tileSize = 256;
+    unsigned int nbLevels = 8;
+
+    #ifdef __GNU__
+    setenv("TZ", "UTC", 1);
+    #endif
+    #ifdef _WIN32
+    putenv("TZ");
+    #endif
+
+    int index;
+
+    while((index=getopt(argc,argv,"s:l:"))!=-1)
+    {
+        switch(index)
+        {
+            case 's':
+                if(sscanf(optarg,"%u", &tileSize) != 1 || tileSize == 0)
+                {
+                    std::cerr << "Invalid tile size (-s)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            case 'l':
+                if(sscanf(optarg,"%u", &nbLevels) != 1 || nbLevels == 0)
+                {
+                    std::cerr << "Invalid number of levels (-l)" << std::endl;
+                    printUsage();
+                }
+            break;
+
+            default:
+                printUsage();
+            break;
+        }
+    }
+
+    if(optind >= argc){
+        printUsage();
+    }
+
+    int status = 0;
+
+    for(int i=optind;i<argc;i++){
+        std::string fileName(argv[i]);
+        DatagramParser * parser = NULL;
+
+        try{
+            std::cerr << "[+] Decoding " << fileName << std::endl;
+
+            WaterfallPyramid pyramid(fileName + ".wfp",tileSize,nbLevels);
+            WaterfallWriter writer(pyramid);
+
+            parser = DatagramParserFactory::build(fileName,writer);
+            parser->parse(fileName);
+
+            pyramid.close();
+
+            std::cerr << "[+] " << pyramid.getNbRows(WATERFALL_PORT,0) << " port and " << pyramid.getNbRows(WATERFALL_STARBOARD,0) << " starboard pings in " << pyramid.getNbTiles() << " tiles" << std::endl;
+        }
+        catch(Exception * error){
+            std::cerr << "[-] Error while processing " << fileName << ": " << error->what() << std::endl;
+            status = 1;
+        }
+        catch(const char * error){
+            std::cerr << "[-] Error while processing " << fileName << ": " << error << std::endl;
+            status = 1;
+        }
+
+        if(parser) delete parser;
+    }
+
+    return status;
+}
+
+#endif
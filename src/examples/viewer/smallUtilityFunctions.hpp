@@ -42,7 +42,7 @@
 uint64_t readSonarFileIntoPointCloud( std::string fileName, pcl::PointCloud<pcl::PointXYZ>::Ptr cloudOut, 
                     Eigen::Vector3d & leverArm, Eigen::Matrix3d & boresight,
                     std::string svpFilename,
-                    const bool DoLGF = true )
+                    const bool DoLGF = true, const double decimationCellSize = 0 )
 {
 
 	Georeferencing * georef;
@@ -70,7 +70,7 @@ uint64_t readSonarFileIntoPointCloud( std::string fileName, pcl::PointCloud<pcl:
 
 
 
-	PointCloudGeoreferencer pointCloudGeoreferencer( cloudOut,*georef, *svpStrategy );
+	PointCloudGeoreferencer pointCloudGeoreferencer( cloudOut,*georef, *svpStrategy, decimationCellSize );
 
 	DatagramParser * parser = nullptr;
 
@@ -0,0 +1,244 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef ALONGTRACKSPIKEFILTER_HPP
+#define ALONGTRACKSPIKEFILTER_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/*!
+* \brief Along-track spike filter class
+*
+* Streaming filter that compares each sounding to the surface formed by the neighbouring beams of the
+* neighbouring pings. The last 2N+1 swaths are kept in a ring buffer, so memory stays constant and every
+* decision is emitted exactly N pings after its swath was received.
+*/
+class AlongTrackSpikeFilter{
+public:
+
+  /**
+  * Creates an along-track spike filter
+  *
+  * @param pingWindow number of pings (N) considered on each side of a swath, which is also the latency of the filter
+  * @param beamWindow number of beams considered on each side of a sounding
+  * @param threshold number of robust standard deviations a sounding may deviate from the local surface
+  * @param minimumDeviation deviation from the local surface under which a sounding is never rejected
+  */
+  AlongTrackSpikeFilter(unsigned int pingWindow = 2,unsigned int beamWindow = 2,double threshold = 3.0,double minimumDeviation = 0.1) :
+  pingWindow(pingWindow),
+  beamWindow(beamWindow),
+  threshold(threshold),
+  minimumDeviation(minimumDeviation),
+  swaths(2*pingWindow+1),
+  swathCount(0),
+  swathOpen(false){
+
+  }
+
+  /**Destroys the along-track spike filter*/
+  virtual ~AlongTrackSpikeFilter(){
+
+  }
+
+  /**
+  * Starts a new swath. The previous swath, if any, is closed.
+  *
+  * @param microEpoch timestamp of the swath
+  */
+  void startSwath(uint64_t microEpoch){
+    if(swathOpen) endSwath();
+
+    BufferedSwath & swath = swaths[swathCount % swaths.size()];
+    swath.timestamp = microEpoch;
+    swath.soundings.clear(); //keeps the capacity, no reallocation once the buffer is warm
+    swathOpen = true;
+  }
+
+  /**
+  * Adds a sounding to the current swath. Soundings must be added in across-track order.
+  *
+  * @param x x position of the sounding
+  * @param y y position of the sounding
+  * @param z z position of the sounding
+  * @param quality quality of the sounding
+  * @param intensity intensity of the sounding
+  */
+  void addSounding(double x,double y,double z,uint32_t quality,int32_t intensity){
+    if(!swathOpen) startSwath(0);
+
+    Sounding sounding;
+    sounding.x = x;
+    sounding.y = y;
+    sounding.z = z;
+    sounding.quality = quality;
+    sounding.intensity = intensity;
+
+    swaths[swathCount % swaths.size()].soundings.push_back(sounding);
+  }
+
+  /**
+  * Closes the current swath and emits the decisions for the swath received N pings ago
+  */
+  void endSwath(){
+    if(!swathOpen) return;
+
+    swathOpen = false;
+    swathCount++;
+
+    if(swathCount > pingWindow){
+      decideSwath(swathCount - 1 - pingWindow,swathCount - 1);
+    }
+  }
+
+  /**
+  * Emits the decisions for all the swaths still in the buffer, using the pings available after them
+  */
+  void flush(){
+    endSwath();
+
+    uint64_t first = (swathCount > pingWindow) ? swathCount - pingWindow : 0;
+
+    for(uint64_t i=first;i<swathCount;i++){
+      decideSwath(i,swathCount - 1);
+    }
+
+    swathCount = 0;
+  }
+
+  /**Returns the number of pings between the reception of a swath and the decisions on its soundings*/
+  unsigned int getLatency(){ return pingWindow; }
+
+protected:
+
+  /**
+  * Receives the decision taken for a sounding
+  *
+  * @param microEpoch timestamp of the swath of the sounding
+  * @param x x position of the sounding
+  * @param y y position of the sounding
+  * @param z z position of the sounding
+  * @param quality quality of the sounding
+  * @param intensity intensity of the sounding
+  * @param isSpike true if the sounding was rejected as a spike
+  */
+  virtual void processSpikeDecision(uint64_t microEpoch,double x,double y,double z,uint32_t quality,int32_t intensity,bool isSpike) = 0;
+
+private:
+
+  /**Sounding kept in the ring buffer*/
+  typedef struct{
+    double x;
+    double y;
+    double z;
+    uint32_t quality;
+    int32_t intensity;
+  } Sounding;
+
+  /**Swath kept in the ring buffer*/
+  typedef struct{
+    uint64_t timestamp;
+    std::vector<Sounding> soundings;
+  } BufferedSwath;
+
+  /**
+  * Decides which soundings of a swath are spikes
+  *
+  * @param center index of the swath to decide
+  * @param last index of the last swath received
+  */
+  void decideSwath(uint64_t center,uint64_t last){
+    uint64_t firstNeighbour = (center > pingWindow) ? center - pingWindow : 0;
+    uint64_t lastNeighbour  = std::min(center + pingWindow,last);
+
+    BufferedSwath & swath = swaths[center % swaths.size()];
+    long nbBeams = swath.soundings.size();
+
+    for(long beam=0;beam<nbBeams;beam++){
+      Sounding & sounding = swath.soundings[beam];
+
+      neighbours.clear();
+
+      for(uint64_t i=firstNeighbour;i<=lastNeighbour;i++){
+        BufferedSwath & neighbour = swaths[i % swaths.size()];
+        long nbNeighbourBeams = neighbour.soundings.size();
+
+        if(nbNeighbourBeams == 0) continue;
+
+        //Swaths may not have the same beam count, so align beams by their relative across-track position
+        long aligned = (nbBeams > 1) ? lround((double)beam * (nbNeighbourBeams-1) / (double)(nbBeams-1)) : nbNeighbourBeams/2;
+
+        long firstBeam = std::max(aligned - (long)beamWindow,(long)0);
+        long lastBeam  = std::min(aligned + (long)beamWindow,nbNeighbourBeams - 1);
+
+        for(long j=firstBeam;j<=lastBeam;j++){
+          if(i == center && j == beam) continue;
+
+          neighbours.push_back(neighbour.soundings[j].z);
+        }
+      }
+
+      processSpikeDecision(swath.timestamp,sounding.x,sounding.y,sounding.z,sounding.quality,sounding.intensity,isSpike(sounding.z));
+    }
+  }
+
+  /**
+  * Returns true if a depth deviates too much from the surface formed by the neighbours
+  *
+  * @param z depth of the sounding
+  */
+  bool isSpike(double z){
+    //Not enough support to call anything a spike
+    if(neighbours.size() < 3) return false;
+
+    size_t middle = neighbours.size() / 2;
+
+    std::nth_element(neighbours.begin(),neighbours.begin() + middle,neighbours.end());
+    double median = neighbours[middle];
+
+    deviations.clear();
+
+    for(auto i=neighbours.begin();i!=neighbours.end();i++){
+      deviations.push_back(std::abs(*i - median));
+    }
+
+    std::nth_element(deviations.begin(),deviations.begin() + middle,deviations.end());
+
+    //1.4826 scales the median absolute deviation to a standard deviation for normally distributed depths
+    double sigma = 1.4826 * deviations[middle];
+
+    return std::abs(z - median) > std::max(threshold * sigma,minimumDeviation);
+  }
+
+  /**Number of pings considered on each side of a swath*/
+  unsigned int pingWindow;
+
+  /**Number of beams considered on each side of a sounding*/
+  unsigned int beamWindow;
+
+  /**Number of robust standard deviations accepted*/
+  double threshold;
+
+  /**Deviation under which a sounding is never rejected*/
+  double minimumDeviation;
+
+  /**Ring buffer of the last 2N+1 swaths*/
+  std::vector<BufferedSwath> swaths;
+
+  /**Number of swaths received since the last flush*/
+  uint64_t swathCount;
+
+  /**True if a swath is being received*/
+  bool swathOpen;
+
+  /**Depths of the neighbours of the sounding being decided, reused between soundings*/
+  std::vector<double> neighbours;
+
+  /**Absolute deviations from the local surface, reused between soundings*/
+  std::vector<double> deviations;
+};
+
+#endif
@@ -0,0 +1,367 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef PLANEFITFILTER_HPP
+#define PLANEFITFILTER_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <Eigen/Dense>
+#include "PointFilter.hpp"
+
+/*!
+* \brief Plane fit filter class.
+*
+* Extends from the PointFilter class. Fits a least-squares plane to the k nearest neighbours of every point
+* of a cloud and rejects the points whose residual to that plane is too large. The neighbours are found with
+* a grid index built once over the whole cloud, and the fits are computed in parallel over tiles of the grid.
+*/
+class PlaneFitFilter : public PointFilter{
+public:
+
+  /**
+  * Creates a plane fit filter
+  *
+  * @param maximumResidual the largest vertical distance accepted between a point and the plane fitted to its neighbours
+  * @param nbNeighbours number of nearest neighbours used to fit the plane
+  * @param nbThreads number of threads used to fit the planes, 0 to use all the hardware threads
+  */
+  PlaneFitFilter(double maximumResidual,unsigned int nbNeighbours = 8,unsigned int nbThreads = 0) :
+  maximumResidual(maximumResidual),
+  nbNeighbours(std::max(nbNeighbours,3u)),
+  nbThreads(nbThreads),
+  cellSize(1),
+  nbColumns(0),
+  nbRows(0){
+
+  }
+
+  /**Destroys the plane fit filter*/
+  ~PlaneFitFilter(){
+
+  }
+
+  /**
+  * Builds the spatial index over a cloud and decides which of its points are outliers.
+  * Must be called before filterPoint().
+  *
+  * @param cloud the points to filter
+  */
+  void build(std::vector<Eigen::Vector3d> & cloud){
+    points.clear();
+    rejected.clear();
+    cellStart.clear();
+
+    if(cloud.empty()) return;
+
+    buildIndex(cloud);
+
+    residuals.assign(points.size(),0);
+    rejected.assign(points.size(),0);
+
+    unsigned int nbTilesX = (nbColumns + TILE_CELLS - 1) / TILE_CELLS;
+    unsigned int nbTilesY = (nbRows + TILE_CELLS - 1) / TILE_CELLS;
+    unsigned int nbTiles = nbTilesX * nbTilesY;
+
+    unsigned int threads = (nbThreads > 0) ? nbThreads : std::thread::hardware_concurrency();
+    threads = std::max(1u,std::min(threads,nbTiles));
+
+    //First pass computes every residual, second pass confirms the outliers without
+    //the neighbours that are worse than them, so a spike does not take its neighbours down with it
+    for(int pass=0;pass<2;pass++){
+      //Tiles are handed out dynamically since the point density varies a lot across a survey
+      std::atomic<unsigned int> nextTile(0);
+      std::vector<std::thread> workers;
+
+      for(unsigned int i=0;i<threads;i++){
+        workers.push_back(std::thread(&PlaneFitFilter::processTiles,this,std::ref(nextTile),nbTilesX,nbTiles,pass == 1));
+      }
+
+      for(auto i=workers.begin();i!=workers.end();i++){
+        i->join();
+      }
+    }
+
+    residuals.clear();
+  }
+
+  /**
+  * Returns true if the point was found to be an outlier when the filter was built
+  *
+  * @param microEpoch timestamp of the point
+  * @param x x position of the point
+  * @param y y position of the point
+  * @param z z position of the point
+  * @param quality quality of the point
+  * @param intensity intensity of the point
+  */
+  bool filterPoint(uint64_t microEpoch,double x,double y,double z, uint32_t quality,uint32_t intensity){
+    if(points.empty()) return false;
+
+    long column = (long)std::floor((x - originX) / cellSize);
+    long row    = (long)std::floor((y - originY) / cellSize);
+
+    if(column < 0 || row < 0 || column >= (long)nbColumns || row >= (long)nbRows) return false;
+
+    unsigned int cell = row * nbColumns + column;
+
+    for(unsigned int i=cellStart[cell];i<cellStart[cell+1];i++){
+      if(points[i](0) == x && points[i](1) == y && points[i](2) == z){
+        return rejected[i] != 0;
+      }
+    }
+
+    //Unknown points were not part of the cloud, leave them alone
+    return false;
+  }
+
+private:
+
+  /**Width of a tile, in cells*/
+  static const unsigned int TILE_CELLS = 16;
+
+  /**
+  * Sorts the points by grid cell so that every cell is a contiguous range of points
+  *
+  * @param cloud the points to index
+  */
+  void buildIndex(std::vector<Eigen::Vector3d> & cloud){
+    double minX = std::numeric_limits<double>::max();
+    double minY = std::numeric_limits<double>::max();
+    double maxX = -std::numeric_limits<double>::max();
+    double maxY = -std::numeric_limits<double>::max();
+
+    for(auto i=cloud.begin();i!=cloud.end();i++){
+      minX = std::min(minX,(*i)(0));
+      minY = std::min(minY,(*i)(1));
+      maxX = std::max(maxX,(*i)(0));
+      maxY = std::max(maxY,(*i)(1));
+    }
+
+    //Size the cells so that a cell holds about as many points as a neighbourhood. A narrow or collinear cloud has
+    //no area: its cells are then sized along its longest extent, which keeps the grid within the number of points.
+    double width = maxX - minX;
+    double height = maxY - minY;
+    double pointsPerNeighbourhood = cloud.size() / (double)nbNeighbours;
+
+    cellSize = std::max(std::sqrt(width * height / pointsPerNeighbourhood),std::max(width,height) / pointsPerNeighbourhood);
+
+    if(!(cellSize > 0)) cellSize = 1;
+
+    originX = minX;
+    originY = minY;
+    nbColumns = (unsigned int)std::floor((maxX - minX) / cellSize) + 1;
+    nbRows    = (unsigned int)std::floor((maxY - minY) / cellSize) + 1;
+
+    //Counting sort of the points by cell
+    std::vector<unsigned int> cellOfPoint(cloud.size());
+    cellStart.assign(nbColumns * nbRows + 1,0);
+
+    for(unsigned int i=0;i<cloud.size();i++){
+      unsigned int column = std::min((unsigned int)((cloud[i](0) - originX) / cellSize),nbColumns - 1);
+      unsigned int row    = std::min((unsigned int)((cloud[i](1) - originY) / cellSize),nbRows - 1);
+
+      cellOfPoint[i] = row * nbColumns + column;
+      cellStart[cellOfPoint[i] + 1]++;
+    }
+
+    for(unsigned int i=1;i<cellStart.size();i++){
+      cellStart[i] += cellStart[i-1];
+    }
+
+    std::vector<unsigned int> cursor(cellStart.begin(),cellStart.end() - 1);
+    points.resize(cloud.size());
+
+    for(unsigned int i=0;i<cloud.size();i++){
+      points[cursor[cellOfPoint[i]]++] = cloud[i];
+    }
+  }
+
+  /**
+  * Fits the planes of the points in the tiles taken from a shared counter, until none are left
+  *
+  * @param nextTile the next tile to process
+  * @param nbTilesX number of tiles in a row of tiles
+  * @param nbTiles total number of tiles
+  * @param confirm false to compute the residuals of all the points, true to confirm the points whose residual is too large
+  */
+  void processTiles(std::atomic<unsigned int> & nextTile,unsigned int nbTilesX,unsigned int nbTiles,bool confirm){
+    std::vector<std::pair<double,unsigned int> > candidates;
+
+    unsigned int tile;
+
+    while((tile = nextTile++) < nbTiles){
+      unsigned int firstColumn = (tile % nbTilesX) * TILE_CELLS;
+      unsigned int firstRow    = (tile / nbTilesX) * TILE_CELLS;
+      unsigned int lastColumn  = std::min(firstColumn + TILE_CELLS,nbColumns);
+      unsigned int lastRow     = std::min(firstRow + TILE_CELLS,nbRows);
+
+      for(unsigned int row=firstRow;row<lastRow;row++){
+        for(unsigned int column=firstColumn;column<lastColumn;column++){
+          unsigned int cell = row * nbColumns + column;
+
+          for(unsigned int i=cellStart[cell];i<cellStart[cell+1];i++){
+            if(confirm && residuals[i] <= maximumResidual) continue;
+
+            findNeighbours(i,column,row,candidates);
+
+            if(confirm){
+              //Leave out the neighbours that fit worse than this point
+              unsigned int kept = 0;
+
+              for(unsigned int j=0;j<candidates.size();j++){
+                if(residuals[candidates[j].second] <= residuals[i]){
+                  candidates[kept++] = candidates[j];
+                }
+              }
+
+              candidates.resize(kept);
+
+              if(candidates.size() >= 3 && residual(i,candidates) > maximumResidual){
+                rejected[i] = 1;
+              }
+            }
+            else if(candidates.size() >= 3){
+              residuals[i] = residual(i,candidates);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /**
+  * Finds the k nearest neighbours, in the horizontal plane, of a point by searching rings of cells around it
+  *
+  * @param index index of the point
+  * @param column column of the cell of the point
+  * @param row row of the cell of the point
+  * @param candidates the squared distances and indices of the neighbours found
+  */
+  void findNeighbours(unsigned int index,unsigned int column,unsigned int row,std::vector<std::pair<double,unsigned int> > & candidates){
+    candidates.clear();
+
+    const Eigen::Vector3d & point = points[index];
+    long maxRing = std::max(nbColumns,nbRows);
+
+    for(long ring=0;ring<=maxRing;ring++){
+      for(long r=(long)row-ring;r<=(long)row+ring;r++){
+        if(r < 0 || r >= (long)nbRows) continue;
+
+        for(long c=(long)column-ring;c<=(long)column+ring;c++){
+          if(c < 0 || c >= (long)nbColumns) continue;
+
+          //Only the cells on the border of the ring are new
+          if(std::abs(r - (long)row) != ring && std::abs(c - (long)column) != ring) continue;
+
+          unsigned int cell = r * nbColumns + c;
+
+          for(unsigned int i=cellStart[cell];i<cellStart[cell+1];i++){
+            if(i == index) continue;
+
+            double dx = points[i](0) - point(0);
+            double dy = points[i](1) - point(1);
+
+            candidates.push_back(std::make_pair(dx*dx + dy*dy,i));
+          }
+        }
+      }
+
+      if(candidates.size() >= nbNeighbours){
+        std::nth_element(candidates.begin(),candidates.begin() + (nbNeighbours - 1),candidates.end());
+
+        //Every point outside the searched rings is at least this far
+        double searched = ring * cellSize;
+
+        if(candidates[nbNeighbours - 1].first <= searched * searched){
+          candidates.resize(nbNeighbours);
+          return;
+        }
+      }
+    }
+
+    if(candidates.size() > nbNeighbours){
+      std::nth_element(candidates.begin(),candidates.begin() + (nbNeighbours - 1),candidates.end());
+      candidates.resize(nbNeighbours);
+    }
+  }
+
+  /**
+  * Returns the vertical distance between a point and the least-squares plane z = ax + by + c of its neighbours
+  *
+  * @param index index of the point
+  * @param neighbours the neighbours of the point
+  */
+  double residual(unsigned int index,std::vector<std::pair<double,unsigned int> > & neighbours){
+    const Eigen::Vector3d & point = points[index];
+
+    //Coordinates are centered on the point to keep the normal equations well conditioned
+    Eigen::Matrix3d normal = Eigen::Matrix3d::Zero();
+    Eigen::Vector3d rhs = Eigen::Vector3d::Zero();
+
+    for(auto i=neighbours.begin();i!=neighbours.end();i++){
+      const Eigen::Vector3d & neighbour = points[i->second];
+      Eigen::Vector3d row(neighbour(0) - point(0),neighbour(1) - point(1),1.0);
+
+      normal += row * row.transpose();
+      rhs += row * (neighbour(2) - point(2));
+    }
+
+    Eigen::FullPivLU<Eigen::Matrix3d> solver(normal);
+
+    //Degenerate neighbourhoods (collinear points) fall back to the mean depth
+    if(solver.rank() < 3){
+      return std::abs(rhs(2) / normal(2,2));
+    }
+
+    Eigen::Vector3d plane = solver.solve(rhs);
+
+    //At the point, the centered plane evaluates to its constant term
+    return std::abs(plane(2));
+  }
+
+  /**Largest residual accepted*/
+  double maximumResidual;
+
+  /**Number of neighbours used to fit the planes*/
+  unsigned int nbNeighbours;
+
+  /**Number of threads used to fit the planes*/
+  unsigned int nbThreads;
+
+  /**Size of a grid cell*/
+  double cellSize;
+
+  /**x coordinate of the grid origin*/
+  double originX;
+
+  /**y coordinate of the grid origin*/
+  double originY;
+
+  /**Number of columns in the grid*/
+  unsigned int nbColumns;
+
+  /**Number of rows in the grid*/
+  unsigned int nbRows;
+
+  /**Points sorted by cell*/
+  std::vector<Eigen::Vector3d> points;
+
+  /**Index in points of the first point of each cell, followed by the number of points*/
+  std::vector<unsigned int> cellStart;
+
+  /**Residual of each point to the plane of its neighbours, while the filter is built*/
+  std::vector<double> residuals;
+
+  /**Decision for each point, by index in points*/
+  std::vector<char> rejected;
+};
+
+#endif
@@ -18,7 +18,7 @@ public:
   }
 
   /**Destroys the point filter*/
-  ~PointFilter(){
+  virtual ~PointFilter(){
 
   }
 
@@ -0,0 +1,98 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef STATICFILTERCHAIN_HPP
+#define STATICFILTERCHAIN_HPP
+
+#include <cstdint>
+
+/*!
+* \brief Static filter chain class
+*
+* Filter chain whose filters are fixed at compile time, such as StaticFilterChain<InsanePositionFilter,QualityFilter,IntensityFilter>.
+* The filters are held by value and called through their concrete type, so the whole chain can be inlined
+* in the caller's loop instead of going through a std::list<PointFilter*> and a virtual call per filter.
+* Use it for fixed cleaning recipes, and the list of PointFilter for chains configured at run time.
+*/
+template<typename... Filters>
+class StaticFilterChain;
+
+/*!
+* \brief Empty static filter chain, which keeps every point
+*/
+template<>
+class StaticFilterChain<>{
+public:
+
+  /**Creates an empty filter chain*/
+  StaticFilterChain(){
+
+  }
+
+  /**
+  * Returns false, an empty chain never removes a point
+  *
+  * @param microEpoch timestamp of the point
+  * @param x x position of the point
+  * @param y y position of the point
+  * @param z z position of the point
+  * @param quality quality of the point
+  * @param intensity intensity of the point
+  */
+  inline bool filterPoint(uint64_t microEpoch,double x,double y,double z, uint32_t quality,uint32_t intensity){
+    return false;
+  }
+};
+
+/*!
+* \brief Static filter chain made of a first filter followed by the chain of the other filters
+*/
+template<typename First,typename... Rest>
+class StaticFilterChain<First,Rest...>{
+public:
+
+  /**
+  * Creates a filter chain
+  *
+  * @param first the first filter of the chain
+  * @param rest the other filters of the chain, in the order they are applied
+  */
+  StaticFilterChain(const First & first,const Rest &... rest) : first(first), rest(rest...){
+
+  }
+
+  /**
+  * Returns true if one of the filters of the chain removed this point. The filters after it are not applied.
+  *
+  * @param microEpoch timestamp of the point
+  * @param x x position of the point
+  * @param y y position of the point
+  * @param z z position of the point
+  * @param quality quality of the point
+  * @param intensity intensity of the point
+  */
+  inline bool filterPoint(uint64_t microEpoch,double x,double y,double z, uint32_t quality,uint32_t intensity){
+    return first.filterPoint(microEpoch,x,y,z,quality,intensity) || rest.filterPoint(microEpoch,x,y,z,quality,intensity);
+  }
+
+private:
+
+  /**First filter of the chain, called through its concrete type*/
+  First first;
+
+  /**Chain of the other filters*/
+  StaticFilterChain<Rest...> rest;
+};
+
+/**
+* Builds a static filter chain from filters, deducing its type
+*
+* @param filters the filters of the chain, in the order they are applied
+*/
+template<typename... Filters>
+StaticFilterChain<Filters...> makeFilterChain(const Filters &... filters){
+  return StaticFilterChain<Filters...>(filters...);
+}
+
+#endif
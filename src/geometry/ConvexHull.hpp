@@ -0,0 +1,244 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef CONVEXHULL_HPP
+#define CONVEXHULL_HPP
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "../utils/ThreadUtils.hpp"
+
+//-----------------------------------------------------------------------------------
+// Andrew's monotone chain convex hull algorithm
+// Adapted from
+// https://en.wikibooks.org/wiki/Algorithm_Implementation/Geometry/Convex_hull/Monotone_chain#C++
+
+typedef float coord_t;      // coordinate type (Use float because pcl::PointXYZ's coordinates are float)
+typedef double coord2_t;    // must be big enough to hold 2*max(|coordinate|)^2
+
+struct PointAndrews
+{
+	coord_t x;
+    coord_t y;
+    uint64_t index;
+
+	bool operator <( const PointAndrews &p ) const
+    {
+		return x < p.x || (x == p.x && y < p.y);
+	}
+};
+
+
+// 3D cross product of OA and OB vectors, (i.e z-component of their "2D" cross product,
+// but remember that it is not defined in "2D").
+// Returns a positive value, if OAB makes a counter-clockwise turn,
+// negative for clockwise turn, and zero if the points are collinear.
+inline coord2_t cross( const PointAndrews &O, const PointAndrews &A, const PointAndrews &B )
+{
+	return (A.x - O.x) * (B.y - O.y) - (A.y - O.y) * (B.x - O.x);
+}
+
+// Returns a list of points on the convex hull in counter-clockwise order.
+// Note: the last point in the returned list is the same as the first one.
+// CB: vector points is modified by getting sorted.
+inline void AndrewsConvex_hull( std::vector<PointAndrews> & hull, std::vector<PointAndrews> & points )
+{
+	size_t n = points.size(), k = 0;
+
+    hull.clear();
+
+    if ( n <= 3 )
+    {
+        hull.reserve( n );
+
+        for ( size_t count = 0; count < n; count++ )
+            hull.push_back( points[ count ] );
+
+        return;
+    }
+
+    hull.resize( 2 * n );
+
+	// Sort points lexicographically
+	sort(points.begin(), points.end());
+
+	// Build lower hull
+	for (size_t i = 0; i < n; ++i)
+    {
+		while (k >= 2 && cross(hull[k-2], hull[k-1], points[i]) <= 0)
+            k--;
+
+		hull[k++] = points[i];
+	}
+
+	// Build upper hull
+	for (size_t i = n-1, t = k+1; i > 0; --i)
+    {
+		while (k >= t && cross(hull[k-2], hull[k-1], points[i-1]) <= 0)
+            k--;
+
+		hull[k++] = points[i-1];
+	}
+
+	hull.resize(k-1);
+
+}
+
+//-----------------------------------------------------------------------------------
+/*!
+* \brief Parallel convex hull class
+*
+* Convex hull of a large point set with Andrew's monotone chain. The points are read where they are instead of being
+* copied, in blocks of consecutive points. The extreme points of a block in eight directions bound an octagon, and
+* the points of the block strictly inside it cannot be hull vertices. Soundings come ping after ping, so a block
+* covers a short stretch of the swath and nearly all its points are dropped before anything is sorted. Each thread
+* hulls the points left in its blocks, and the hulls of the threads are merged with a last monotone chain.
+*/
+class ParallelConvexHull{
+public:
+
+  /**
+  * Computes the convex hull of points, in counter-clockwise order, like AndrewsConvex_hull()
+  *
+  * @param points the points, any container of objects with x and y members, such as the points of a pcl::PointCloud
+  * @param hull receives the vertices of the hull, whose index member is the position of the vertex in points
+  * @param nbThreads number of threads, 0 to use all the hardware threads
+  */
+  template<typename Points>
+  static void compute(const Points & points,std::vector<PointAndrews> & hull,unsigned int nbThreads = 0){
+    size_t n = points.size();
+    size_t nbBlocks = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    unsigned int threads = std::min<size_t>(ThreadUtils::getNbThreads(nbThreads),nbBlocks);
+
+    hull.clear();
+
+    if(n == 0) return;
+
+    std::vector<std::vector<PointAndrews> > hulls(threads);
+
+    ThreadUtils::runChunks(threads,nbBlocks,[&](unsigned int thread,size_t firstBlock,size_t lastBlock){
+      std::vector<PointAndrews> candidates;
+      std::vector<PointAndrews> octagon;
+
+      for(size_t block=firstBlock;block<lastBlock;block++){
+        size_t begin = block * BLOCK_SIZE;
+        size_t end = std::min(begin + (size_t)BLOCK_SIZE,n);
+
+        computeOctagon(points,begin,end,octagon);
+
+        for(size_t i=begin;i<end;i++){
+          PointAndrews point = toPointAndrews(points,i);
+
+          if(!isStrictlyInside(octagon,point)){
+            candidates.push_back(point);
+          }
+        }
+      }
+
+      AndrewsConvex_hull(hulls[thread],candidates);
+    });
+
+    std::vector<PointAndrews> merged;
+
+    for(auto i=hulls.begin();i!=hulls.end();i++){
+      merged.insert(merged.end(),i->begin(),i->end());
+    }
+
+    AndrewsConvex_hull(hull,merged);
+  }
+
+private:
+
+  /**Number of consecutive points sharing an octagon*/
+  static const size_t BLOCK_SIZE = 4096;
+
+  /**
+  * Builds the counter-clockwise octagon of the extreme points of a range, without repeated vertices
+  *
+  * @param points the points
+  * @param begin position of the first point of the range
+  * @param end position after the last point of the range
+  * @param octagon receives the vertices of the octagon
+  */
+  template<typename Points>
+  static void computeOctagon(const Points & points,size_t begin,size_t end,std::vector<PointAndrews> & octagon){
+    //Counter-clockwise from the lowest point: min y, max x-y, max x, max x+y, max y, min x-y, min x, min x+y
+    size_t extremes[8];
+    double best[8];
+
+    for(unsigned int direction=0;direction<8;direction++){
+      extremes[direction] = begin;
+    }
+
+    double x = points[begin].x;
+    double y = points[begin].y;
+    best[0] = y;     best[1] = x - y; best[2] = x; best[3] = x + y;
+    best[4] = y;     best[5] = x - y; best[6] = x; best[7] = x + y;
+
+    for(size_t i=begin + 1;i<end;i++){
+      x = points[i].x;
+      y = points[i].y;
+
+      double difference = x - y;
+      double sum = x + y;
+
+      if(y < best[0])          { best[0] = y;          extremes[0] = i; }
+      if(difference > best[1]) { best[1] = difference; extremes[1] = i; }
+      if(x > best[2])          { best[2] = x;          extremes[2] = i; }
+      if(sum > best[3])        { best[3] = sum;        extremes[3] = i; }
+      if(y > best[4])          { best[4] = y;          extremes[4] = i; }
+      if(difference < best[5]) { best[5] = difference; extremes[5] = i; }
+      if(x < best[6])          { best[6] = x;          extremes[6] = i; }
+      if(sum < best[7])        { best[7] = sum;        extremes[7] = i; }
+    }
+
+    octagon.clear();
+
+    for(unsigned int direction=0;direction<8;direction++){
+      PointAndrews vertex = toPointAndrews(points,extremes[direction]);
+
+      if(octagon.empty() || octagon.back().x != vertex.x || octagon.back().y != vertex.y){
+        octagon.push_back(vertex);
+      }
+    }
+
+    while(octagon.size() > 1 && octagon.back().x == octagon.front().x && octagon.back().y == octagon.front().y){
+      octagon.pop_back();
+    }
+  }
+
+  /**
+  * Returns a point of a container as a PointAndrews
+  *
+  * @param points the points
+  * @param i the position of the point
+  */
+  template<typename Points>
+  static PointAndrews toPointAndrews(const Points & points,uint64_t i){
+    PointAndrews point;
+    point.x = points[i].x;
+    point.y = points[i].y;
+    point.index = i;
+    return point;
+  }
+
+  /**
+  * Returns true if a point is strictly inside a counter-clockwise convex polygon
+  *
+  * @param polygon the polygon, false is returned if it has less than 3 vertices
+  * @param point the point
+  */
+  static bool isStrictlyInside(const std::vector<PointAndrews> & polygon,const PointAndrews & point){
+    if(polygon.size() < 3) return false;
+
+    for(size_t i=0;i<polygon.size();i++){
+      if(cross(polygon[i],polygon[(i + 1) % polygon.size()],point) <= 0) return false;
+    }
+
+    return true;
+  }
+};
+
+#endif
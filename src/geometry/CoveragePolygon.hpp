@@ -0,0 +1,288 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef COVERAGEPOLYGON_HPP
+#define COVERAGEPOLYGON_HPP
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "../utils/Exception.hpp"
+
+/*!
+* \brief Coverage vertex
+*
+* Vertex of a coverage polygon
+*/
+struct CoverageVertex{
+  /**x position*/
+  double x;
+
+  /**y position*/
+  double y;
+};
+
+/*!
+* \brief Streaming polyline class
+*
+* Polyline simplified as its points arrive, with the sleeve fitting method. From the last vertex kept, every point
+* farther than the tolerance narrows the range of directions in which the next vertex can be while staying within the
+* tolerance of it. When a point falls outside that range, the point before it becomes a vertex. Only the vertices and
+* the range are stored, not the points between the vertices.
+*/
+class StreamingPolyline{
+public:
+
+  /**
+  * Creates a streaming polyline
+  *
+  * @param tolerance the largest distance between a point and the simplified polyline
+  */
+  StreamingPolyline(double tolerance) : tolerance(tolerance), hasLast(false), hasSleeve(false), reference(0), low(0), high(0){
+
+  }
+
+  /**Destroys the streaming polyline*/
+  ~StreamingPolyline(){
+
+  }
+
+  /**
+  * Adds a point at the end of the polyline
+  *
+  * @param x x position
+  * @param y y position
+  */
+  void add(double x,double y){
+    if(vertices.empty()){
+      CoverageVertex first = {x,y};
+      vertices.push_back(first);
+      return;
+    }
+
+    const CoverageVertex & anchor = vertices.back();
+    double dx = x - anchor.x;
+    double dy = y - anchor.y;
+    double distance = std::sqrt(dx * dx + dy * dy);
+
+    if(distance <= tolerance){
+      setLast(x,y);
+      return;
+    }
+
+    double direction = std::atan2(dy,dx);
+    double halfWidth = std::asin(tolerance / distance);
+
+    if(!hasSleeve){
+      reference = direction;
+      low = -halfWidth;
+      high = halfWidth;
+      hasSleeve = true;
+      setLast(x,y);
+      return;
+    }
+
+    double relative = direction - reference;
+
+    if(relative > M_PI) relative -= 2 * M_PI;
+    if(relative < -M_PI) relative += 2 * M_PI;
+
+    if(relative < low || relative > high){
+      //The previous point is the farthest the current segment can go
+      vertices.push_back(last);
+      hasLast = false;
+      hasSleeve = false;
+      add(x,y);
+      return;
+    }
+
+    low = std::max(low,relative - halfWidth);
+    high = std::min(high,relative + halfWidth);
+    setLast(x,y);
+  }
+
+  /**
+  * Appends the vertices of the polyline, the last point received included
+  *
+  * @param points receives the vertices
+  */
+  void getVertices(std::vector<CoverageVertex> & points) const {
+    points.insert(points.end(),vertices.begin(),vertices.end());
+
+    if(hasLast) points.push_back(last);
+  }
+
+  /**Returns the number of vertices, the last point received included*/
+  size_t getNbVertices() const { return vertices.size() + (hasLast ? 1 : 0); }
+
+  /**Returns the tolerance*/
+  double getTolerance() const { return tolerance; }
+
+private:
+
+  /**
+  * Sets the last point received
+  *
+  * @param x x position
+  * @param y y position
+  */
+  void setLast(double x,double y){
+    last.x = x;
+    last.y = y;
+    hasLast = true;
+  }
+
+  /**Largest distance between a point and the simplified polyline*/
+  double tolerance;
+
+  /**Vertices kept*/
+  std::vector<CoverageVertex> vertices;
+
+  /**Last point received, if it is not a vertex*/
+  CoverageVertex last;
+
+  /**True if last is set*/
+  bool hasLast;
+
+  /**True once a point farther than the tolerance from the last vertex was received*/
+  bool hasSleeve;
+
+  /**Direction of the first point of the sleeve from the last vertex*/
+  double reference;
+
+  /**Smallest direction of the next vertex, relative to the reference*/
+  double low;
+
+  /**Largest direction of the next vertex, relative to the reference*/
+  double high;
+};
+
+/*!
+* \brief Coverage polygon class
+*
+* Footprint of a line being logged, built from the outermost port and starboard soundings of each ping. Both edges
+* of the swath are simplified as they grow, and the polygon is the port edge followed by the starboard edge in
+* reverse. The number of vertices can be bounded: when it is exceeded, the tolerance is doubled and the edges are
+* simplified again, so the memory used does not depend on the length of the line.
+*/
+class CoveragePolygon{
+public:
+
+  /**
+  * Creates a coverage polygon
+  *
+  * @param tolerance the largest distance between an outer sounding and the edge of the polygon
+  * @param maxVertices the largest number of vertices, 0 for no limit
+  */
+  CoveragePolygon(double tolerance,unsigned int maxVertices = 0) :
+  maxVertices((maxVertices == 0) ? 0 : std::max(maxVertices,8u)),
+  nbPings(0),
+  port(tolerance),
+  starboard(tolerance){
+    if(!(tolerance > 0)){
+      throw new Exception("The tolerance of a coverage polygon must be positive");
+    }
+  }
+
+  /**Destroys the coverage polygon*/
+  ~CoveragePolygon(){
+
+  }
+
+  /**
+  * Adds the outermost soundings of a ping
+  *
+  * @param portX x position of the outermost port sounding
+  * @param portY y position of the outermost port sounding
+  * @param starboardX x position of the outermost starboard sounding
+  * @param starboardY y position of the outermost starboard sounding
+  */
+  void add(double portX,double portY,double starboardX,double starboardY){
+    port.add(portX,portY);
+    starboard.add(starboardX,starboardY);
+    nbPings++;
+
+    while(maxVertices > 0 && getNbVertices() > maxVertices){
+      double tolerance = port.getTolerance() * 2;
+      port = coarsen(port,tolerance);
+      starboard = coarsen(starboard,tolerance);
+    }
+  }
+
+  /**
+  * Returns the vertices of the polygon: the port edge from the first ping to the last one, then the starboard edge
+  * from the last ping to the first one. The polygon is not closed by repeating the first vertex.
+  *
+  * @param polygon receives the vertices
+  */
+  void getPolygon(std::vector<CoverageVertex> & polygon) const {
+    polygon.clear();
+    port.getVertices(polygon);
+
+    std::vector<CoverageVertex> edge;
+    starboard.getVertices(edge);
+    polygon.insert(polygon.end(),edge.rbegin(),edge.rend());
+  }
+
+  /**Returns the area of the polygon*/
+  double getArea() const {
+    std::vector<CoverageVertex> polygon;
+    getPolygon(polygon);
+
+    double area = 0;
+
+    for(size_t i=0;i<polygon.size();i++){
+      const CoverageVertex & a = polygon[i];
+      const CoverageVertex & b = polygon[(i + 1) % polygon.size()];
+      area += a.x * b.y - b.x * a.y;
+    }
+
+    return std::fabs(area) / 2;
+  }
+
+  /**Returns the number of pings added*/
+  uint64_t getNbPings() const { return nbPings; }
+
+  /**Returns the number of vertices of the polygon*/
+  size_t getNbVertices() const { return port.getNbVertices() + starboard.getNbVertices(); }
+
+  /**Returns the current tolerance, larger than the initial one if the edges were coarsened*/
+  double getTolerance() const { return port.getTolerance(); }
+
+private:
+
+  /**
+  * Returns an edge simplified again with a larger tolerance
+  *
+  * @param edge the edge
+  * @param tolerance the new tolerance
+  */
+  static StreamingPolyline coarsen(const StreamingPolyline & edge,double tolerance){
+    std::vector<CoverageVertex> vertices;
+    edge.getVertices(vertices);
+
+    StreamingPolyline coarser(tolerance);
+
+    for(auto i=vertices.begin();i!=vertices.end();i++){
+      coarser.add(i->x,i->y);
+    }
+
+    return coarser;
+  }
+
+  /**Largest number of vertices, 0 for no limit*/
+  unsigned int maxVertices;
+
+  /**Number of pings added*/
+  uint64_t nbPings;
+
+  /**Port edge*/
+  StreamingPolyline port;
+
+  /**Starboard edge*/
+  StreamingPolyline starboard;
+};
+
+#endif
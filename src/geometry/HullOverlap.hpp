@@ -35,84 +35,13 @@
 #include <Eigen/Dense>
 #include <Eigen/Geometry> // For cross product
 
+#include "ConvexHull.hpp"
+#include "RasterFootprint.hpp"
+#include "PolygonIndex.hpp"
 
-//-----------------------------------------------------------------------------------
-// Andrew's monotone chain convex hull algorithm
-// Adapted from
-// https://en.wikibooks.org/wiki/Algorithm_Implementation/Geometry/Convex_hull/Monotone_chain#C++
-
-typedef float coord_t;      // coordinate type (Use float because pcl::PointXYZ's coordinates are float)
-typedef double coord2_t;    // must be big enough to hold 2*max(|coordinate|)^2
-
-struct PointAndrews
-{
-	coord_t x;
-    coord_t y;
-    uint64_t index;
-
-	bool operator <( const PointAndrews &p ) const
-    {
-		return x < p.x || (x == p.x && y < p.y);
-	}
-};
-
-
-// 3D cross product of OA and OB vectors, (i.e z-component of their "2D" cross product,
-// but remember that it is not defined in "2D").
-// Returns a positive value, if OAB makes a counter-clockwise turn,
-// negative for clockwise turn, and zero if the points are collinear.
-coord2_t cross( const PointAndrews &O, const PointAndrews &A, const PointAndrews &B )
-{
-	return (A.x - O.x) * (B.y - O.y) - (A.y - O.y) * (B.x - O.x);
-}
-
-// Returns a list of points on the convex hull in counter-clockwise order.
-// Note: the last point in the returned list is the same as the first one.
-// CB: vector points is modified by getting sorted.
-void AndrewsConvex_hull( std::vector<PointAndrews> & hull, std::vector<PointAndrews> & points )
-{
-	size_t n = points.size(), k = 0;
-
-    hull.clear();
-
-    if ( n <= 3 )
-    {
-        hull.reserve( n );
-
-        for ( int count = 0; count < n; count++ )
-            hull.push_back( points[ count ] );
-
-        return;
-    }
-
-    hull.resize( 2 * n );
-
-	// Sort points lexicographically
-	sort(points.begin(), points.end());
-
-	// Build lower hull
-	for (size_t i = 0; i < n; ++i)
-    {
-		while (k >= 2 && cross(hull[k-2], hull[k-1], points[i]) <= 0)
-            k--;
-
-		hull[k++] = points[i];
-	}
-
-	// Build upper hull
-	for (size_t i = n-1, t = k+1; i > 0; --i)
-    {
-		while (k >= t && cross(hull[k-2], hull[k-1], points[i-1]) <= 0)
-            k--;
-
-		hull[k++] = points[i-1];
-	}
-
-	hull.resize(k-1);
-
-}
-
-//-----------------------------------------------------------------------------------
+#include "../gridding/DtmGrid.hpp"
+#include "../gridding/ParallelGridder.hpp"
+#include "../gridding/OverlapDifference.hpp"
 
 
 
@@ -130,20 +59,23 @@ public:
     * @param b projection plane coefficient 'b' in ax + by + cz + d = 0
     * @param c projection plane coefficient 'c' in ax + by + cz + d = 0
     * @param d projection plane coefficient 'd' in ax + by + cz + d = 0
-    * @param hullMethod Method to find the hulls, possible values: "PCL ConcaveHull", "Andrew's"
+    * @param hullMethod Method to find the hulls, possible values: "PCL ConcaveHull", "Andrew's", "Raster footprint"
     * @param alpha1 Concave hull computation parameter to use with line #1
     * @param alpha2 Concave hull computation parameter to use with line #2
+    * @param footprintCellSize Size of the cells of the footprints, with the "Raster footprint" method
 	*/
     HullOverlap( pcl::PointCloud<pcl::PointXYZ>::ConstPtr line1In,
                     pcl::PointCloud<pcl::PointXYZ>::ConstPtr line2In,
                     double a, double b, double c, double d, std::string hullMethod = "Andrew's",
-                    double alphaLine1 = 1.0, double alphaLine2 = 1.0 )
+                    double alphaLine1 = 1.0, double alphaLine2 = 1.0, double footprintCellSize = 1.0 )
                     :   line1( line1In ), line2( line2In ),
                         a( a ), b( b ), c( c ), d( d ),
                         hullMethod( hullMethod ),
 
                         alphaLine1( alphaLine1 ), alphaLine2( alphaLine2 ),
 
+                        footprintCellSize( footprintCellSize ),
+
                         coefficients ( new pcl::ModelCoefficients() ),
 
                         line1InPlane (new pcl::PointCloud<pcl::PointXYZ>),
@@ -165,7 +97,7 @@ public:
         coefficients->values[2] = c;
         coefficients->values[3] = d;
 
-        if ( hullMethod != "PCL ConcaveHull" && hullMethod != "Andrew's" )
+        if ( hullMethod != "PCL ConcaveHull" && hullMethod != "Andrew's" && hullMethod != "Raster footprint" )
         {
             std::cerr << "\n\nHullOverlap::HullOverlap(), method \""<<  hullMethod
                 << "\" is not a valid method to find the hull.\n\n" << std::endl;
@@ -259,6 +191,8 @@ public:
         std::cout << "line2InPlane2D->points.size(): " << line2InPlane2D->points.size() << "\n" << std::endl;
 
 
+        if ( hullMethod == "Raster footprint" )
+            return computePointsInBothFootprints( line1InBothHull, line2InBothHull, minimalMemory );
 
         // const std::string method = "Andrew's";
 
@@ -629,6 +563,36 @@ public:
     }
 
 
+	/**
+	* Grids the points of both lines in the overlap on a shared lattice of the projection plane, and differences
+    * the two surfaces cell by cell. The depth of a point is its signed distance to the projection plane.
+    * Must be called after the overlap was computed, which sets the 2D coordinate system of the plane.
+    *
+	* @param[in] line1InBothHull Point cloud of points in line #1 in the overlap area of the two lines
+	* @param[in] line2InBothHull Point cloud of points in line #2 in the overlap area of the two lines
+    * @param[in] resolution Size of the grid cells on the projection plane
+    * @param[out] differences Statistics of the depth differences, line #2 minus line #1
+	*/
+    void computeDepthDifferences( pcl::PointCloud<pcl::PointXYZ>::ConstPtr line1InBothHull,
+                                    pcl::PointCloud<pcl::PointXYZ>::ConstPtr line2InBothHull,
+                                    const double resolution, OverlapDifference & differences )
+    {
+        DtmGrid grid1( resolution );
+        DtmGrid grid2( resolution );
+
+        std::cout << "\nGridding the overlap with cells of " << resolution << "\n" << std::endl;
+
+        gridInPlane2D( line1InBothHull, grid1 );
+        gridInPlane2D( line2InBothHull, grid2 );
+
+        differences.compute( grid1, grid2 );
+
+        std::cout << "Cells line 1: " << grid1.getNbCells() << "\n"
+            << "Cells line 2: " << grid2.getNbCells() << "\n"
+            << "Cells compared: " << differences.getNbCells() << "\n" << std::endl;
+    }
+
+
     const Eigen::Vector3d & getVector1()
     {
         return vector1;
@@ -818,26 +782,11 @@ private:
                                         pcl::PointIndices & hullPointIndices, const bool keepInformation = true )
     {
 
-        std::cout << "\nBefore building vector for Andrews\n" << std::endl;
-
-        std::vector< PointAndrews > points;
-        points.reserve( cloudIn->size() );
-
-        for ( uint64_t count = 0; count < cloudIn->size(); count++ )
-        {
-            PointAndrews point;
-
-            point.x = cloudIn->points[ count ].x;
-            point.y = cloudIn->points[ count ].y;
-            point.index = count;
-
-            points.push_back( point );
-        }
-
         std::cout << "\nBefore calling Andrews\n" << std::endl;
 
+        // Points are read in place, the interior ones are dropped before sorting
         std::vector< PointAndrews > hullAndrews;
-        AndrewsConvex_hull( hullAndrews, points );
+        ParallelConvexHull::compute( cloudIn->points, hullAndrews );
 
         hullVertices->clear();
         hullVertices->reserve( hullAndrews.size() );
@@ -917,14 +866,15 @@ private:
             return;
 
 
-        for ( uint64_t count = 0; count < cloudIn->points.size(); count++ )
-        {
-            if ( pcl::isXYPointIn2DXYPolygon( cloudIn->points[ count ], *hullVertices ) )
-            {
-                cloudOut->push_back( lineOriginal->points[ count ] );
-                indexPointInHull.push_back( count );
-            }
-        }
+        // Only the hull edges near a point are tested, and the points are split between threads
+        PolygonIndex hullIndex( hullVertices->points );
+
+        hullIndex.findPointsInside( cloudIn->points, indexPointInHull );
+
+        cloudOut->reserve( indexPointInHull.size() );
+
+        for ( uint64_t count = 0; count < indexPointInHull.size(); count++ )
+            cloudOut->push_back( lineOriginal->points[ indexPointInHull[ count ] ] );
 
     }
 
@@ -967,12 +917,11 @@ private:
         if ( collinear )
             return;
 
-        
-        for ( uint64_t count = 0; count < cloudIn->points.size(); count++ )
-        {
-            if ( pcl::isXYPointIn2DXYPolygon( cloudIn->points[ count ], *hullVertices ) )
-                indexPointInHull.push_back( count );
-        }
+
+        // Only the hull edges near a point are tested, and the points are split between threads
+        PolygonIndex hullIndex( hullVertices->points );
+
+        hullIndex.findPointsInside( cloudIn->points, indexPointInHull );
 
     }
 
@@ -1025,15 +974,159 @@ private:
             return;
 
 
+        // Only the hull edges near a point are tested, and the points are split between threads
+        PolygonIndex hullIndex( hullVertices->points );
+
+        std::vector< uint64_t > indexPointInHull;
+        hullIndex.findPointsInside( cloudIn->points, indexPointInHull );
+
+        cloudOut->reserve( indexPointInHull.size() );
+
+        for ( uint64_t count = 0; count < indexPointInHull.size(); count++ )
+            cloudOut->push_back( lineOriginal->points[ indexPointInHull[ count ] ] );
+
+    }
+
+
+
+
+	/**
+	* Same as computeHullsAndPointsInBothHulls() once the lines are expressed in 2D, for the "Raster footprint" method.
+    * Each line is rasterized into an occupancy grid, the overlap is the intersection of the two grids,
+    * and the points of each line falling in an overlap cell are kept. The hull vertices are set to the longest
+    * ring of the outline of each footprint, for display.
+    *
+	* @param[out] line1InBothHull Point cloud of points in line #1 in the overlap area of the two lines, or nullptr
+	* @param[out] line2InBothHull Point cloud of points in line #2 in the overlap area of the two lines, or nullptr
+    * @param[in] minimalMemory bool variable, true to specify to try and minimize the memory usage
+	*/
+    std::pair< uint64_t, uint64_t > computePointsInBothFootprints( pcl::PointCloud<pcl::PointXYZ>::Ptr line1InBothHull,
+                                                                    pcl::PointCloud<pcl::PointXYZ>::Ptr line2InBothHull,
+                                                                    const bool minimalMemory )
+    {
+        std::cout << "\nRasterizing footprints with cells of " << footprintCellSize << "\n" << std::endl;
+
+        RasterFootprint footprint1( footprintCellSize );
+        RasterFootprint footprint2( footprintCellSize );
+
+        footprint1.rasterize( line1InPlane2D->points );
+        footprint2.rasterize( line2InPlane2D->points );
+
+        setVerticesFromFootprint( footprint1, hull1Vertices );
+        setVerticesFromFootprint( footprint2, hull2Vertices );
+
+        // No point of the lines is a vertex of the outline
+        hull1PointIndices.indices.clear();
+        hull2PointIndices.indices.clear();
+
+        RasterFootprint overlap = RasterFootprint::intersect( footprint1, footprint2 );
+
+        std::cout << "Cells in footprint 1: " << footprint1.getNbOccupiedCells() << "\n"
+            << "Cells in footprint 2: " << footprint2.getNbOccupiedCells() << "\n"
+            << "Cells in overlap: " << overlap.getNbOccupiedCells() << "\n" << std::endl;
+
+        overlap.findPointsInside( line1InPlane2D->points, line1InBothHullPointIndices );
+        overlap.findPointsInside( line2InPlane2D->points, line2InBothHullPointIndices );
+
+        if ( line1InBothHull != nullptr && line2InBothHull != nullptr )
+        {
+            line1InBothHull->reserve( line1InBothHullPointIndices.size() );
+
+            for ( uint64_t count = 0; count < line1InBothHullPointIndices.size(); count++ )
+                line1InBothHull->push_back( line1->points[ line1InBothHullPointIndices[ count ] ] );
+
+            line2InBothHull->reserve( line2InBothHullPointIndices.size() );
+
+            for ( uint64_t count = 0; count < line2InBothHullPointIndices.size(); count++ )
+                line2InBothHull->push_back( line2->points[ line2InBothHullPointIndices[ count ] ] );
+
+            if ( minimalMemory )
+            {
+                // Delete the dynamically allocated memory
+                line1InPlane2D.reset();
+                line1InPlane2D = nullptr;
+
+                line2InPlane2D.reset();
+                line2InPlane2D = nullptr;
+
+                line1InBothHullPointIndices.clear();
+                line1InBothHullPointIndices.shrink_to_fit();
+
+                line2InBothHullPointIndices.clear();
+                line2InBothHullPointIndices.shrink_to_fit();
+            }
+
+            std::cout << "line1InBothHull->points.size(): " << line1InBothHull->points.size() << "\n"
+                << "line2InBothHull->points.size(): " << line2InBothHull->points.size() << "\n" << std::endl;
+
+            return std::make_pair( line1InBothHull->size(), line2InBothHull->size() );
+        }
+
+        std::cout << "line1InBothHullPointIndices.size(): " << line1InBothHullPointIndices.size() << "\n"
+            << "line2InBothHullPointIndices.size(): " << line2InBothHullPointIndices.size() << "\n" << std::endl;
+
+        return std::make_pair( line1InBothHullPointIndices.size(), line2InBothHullPointIndices.size() );
+    }
+
+
+	/**
+	* Grids points in the 2D coordinate system of the projection plane, their depth being the signed distance to the plane
+    *
+    * @param[in] cloudIn Point cloud to grid
+    * @param[out] grid Grid receiving the points
+	*/
+    void gridInPlane2D( pcl::PointCloud<pcl::PointXYZ>::ConstPtr cloudIn, DtmGrid & grid )
+    {
+        const double normalNorm = std::sqrt( a * a + b * b + c * c );
+
+        ParallelGridder gridder( grid.getResolution() );
+
         for ( uint64_t count = 0; count < cloudIn->points.size(); count++ )
         {
-            if ( pcl::isXYPointIn2DXYPolygon( cloudIn->points[ count ], *hullVertices ) )
-                cloudOut->push_back( lineOriginal->points[ count ] );
+            const pcl::PointXYZ & point = cloudIn->points[ count ];
+
+            // vector1 and vector2 lie in the plane, so the projection of a point is not needed to express it in 2D
+            double x = ( point.x - refPoint.x ) * vector1( 0 ) + ( point.y - refPoint.y ) * vector1( 1 ) + ( point.z - refPoint.z ) * vector1( 2 );
+            double y = ( point.x - refPoint.x ) * vector2( 0 ) + ( point.y - refPoint.y ) * vector2( 1 ) + ( point.z - refPoint.z ) * vector2( 2 );
+
+            double depth = ( a * point.x + b * point.y + c * point.z + d ) / normalNorm;
+
+            gridder.add( x, y, depth );
         }
 
+        gridder.finish( grid );
     }
 
 
+	/**
+	* Sets hull vertices to the longest ring of the outline of a footprint
+    *
+    * @param[in] footprint Footprint of a line on the projection plane expressed in 2D
+    * @param[out] hullVertices Vertices of the longest ring of the outline
+	*/
+    void setVerticesFromFootprint( const RasterFootprint & footprint, pcl::PointCloud<pcl::PointXYZ>::Ptr hullVertices )
+    {
+        hullVertices->clear();
+
+        std::vector< std::vector< RasterFootprintVertex > > rings;
+        footprint.computeOutline( rings );
+
+        if ( rings.empty() )
+            return;
+
+        uint64_t longest = 0;
+
+        for ( uint64_t count = 1; count < rings.size(); count++ )
+        {
+            if ( rings[ count ].size() > rings[ longest ].size() )
+                longest = count;
+        }
+
+        hullVertices->reserve( rings[ longest ].size() );
+
+        for ( uint64_t count = 0; count < rings[ longest ].size(); count++ )
+            hullVertices->push_back( pcl::PointXYZ( rings[ longest ][ count ].x, rings[ longest ][ count ].y, 0 ) );
+    }
 
 
 // ----------------------------- Variables ------------------------------------------------
@@ -1057,7 +1150,7 @@ private:
     /**Projection plane coefficient 'd' in ax + by + cz + d = 0*/
     const double d;
 
-    //** Method to find the hulls, possible values: "PCL ConcaveHull", "Andrew's"*/
+    //** Method to find the hulls, possible values: "PCL ConcaveHull", "Andrew's", "Raster footprint"*/
     std::string hullMethod;
 
     /**Concave hull computation parameter to use with line #1*/
@@ -1066,6 +1159,9 @@ private:
     /**Concave hull computation parameter to use with line #2*/
     double alphaLine2; // Alpha value to compute the concave hull for line #2
 
+    /**Size of the cells of the footprints, with the "Raster footprint" method*/
+    double footprintCellSize;
+
     /**Coefficients for the plane, ax + by + cz + d = 0 */
     pcl::ModelCoefficients::Ptr coefficients;
 
@@ -0,0 +1,269 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef OVERLAPMATRIX_HPP
+#define OVERLAPMATRIX_HPP
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+#include "RasterFootprint.hpp"
+#include "../gridding/DtmGrid.hpp"
+#include "../index/RTree.hpp"
+#include "../utils/ThreadUtils.hpp"
+#include "../utils/Exception.hpp"
+
+/*!
+* \brief Line overlap
+*
+* Overlap between two lines of a survey
+*/
+struct LineOverlap{
+  /**Index of the first line*/
+  uint32_t line1;
+
+  /**Index of the second line, larger than the first one*/
+  uint32_t line2;
+
+  /**Number of cells covered by both lines*/
+  uint64_t nbCells;
+
+  /**Number of points of the first line in the overlap*/
+  uint64_t nbPoints1;
+
+  /**Number of points of the second line in the overlap*/
+  uint64_t nbPoints2;
+};
+
+/*!
+* \brief Overlap matrix class
+*
+* Finds every pair of overlapping lines of a survey. The footprint of a line is a RasterFootprint, as in the "Raster
+* footprint" method of HullOverlap, built while the points are added, with a point count per cell instead of the
+* points. The bounding boxes of the footprints are indexed in an R-tree to find the candidate pairs, and the
+* candidates are intersected in parallel. The result is a sparse matrix: only the pairs that overlap are kept.
+*/
+class OverlapMatrix{
+public:
+
+  /**
+  * Creates an overlap matrix
+  *
+  * @param cellSize the size of a footprint cell
+  * @param nbThreads number of threads intersecting the footprints, 0 to use all the hardware threads
+  */
+  OverlapMatrix(double cellSize,unsigned int nbThreads = 0) : cellSize(cellSize), nbThreads(ThreadUtils::getNbThreads(nbThreads)){
+    if(!(cellSize > 0)){
+      throw new Exception("The cell size of an overlap matrix must be positive");
+    }
+  }
+
+  /**Destroys the overlap matrix*/
+  ~OverlapMatrix(){
+
+  }
+
+  /**
+  * Adds a line and returns its index
+  *
+  * @param name the name of the line
+  */
+  uint32_t addLine(const std::string & name){
+    names.push_back(name);
+    footprints.push_back(RasterFootprint(cellSize,1));
+    counting.push_back(std::unordered_map<uint64_t,uint32_t>());
+    counts.push_back(std::vector<std::pair<uint64_t,uint32_t> >());
+    return names.size() - 1;
+  }
+
+  /**
+  * Adds a point to the footprint of a line. Throws if the point is beyond the cell indices of the footprints.
+  *
+  * @param line the index of the line
+  * @param x x position
+  * @param y y position
+  */
+  void addPoint(uint32_t line,double x,double y){
+    footprints[line].addPoint(x,y);
+    counting[line][DtmGrid::cellKey(DtmGrid::cellIndex(x,cellSize),DtmGrid::cellIndex(y,cellSize))]++;
+  }
+
+  /**Finds the overlapping pairs among the lines added so far*/
+  void compute(){
+    //Point counts sorted by cell key, to be looked up in the overlaps
+    for(uint32_t line=0;line<counting.size();line++){
+      if(counting[line].empty()) continue;
+
+      std::vector<std::pair<uint64_t,uint32_t> > & cells = counts[line];
+
+      cells.insert(cells.end(),counting[line].begin(),counting[line].end());
+      std::sort(cells.begin(),cells.end());
+
+      //Points added after a previous computation fall in cells that may already be there
+      size_t last = 0;
+
+      for(size_t i=1;i<cells.size();i++){
+        if(cells[i].first == cells[last].first){
+          cells[last].second += cells[i].second;
+        }
+        else{
+          cells[++last] = cells[i];
+        }
+      }
+
+      cells.resize(last + 1);
+
+      std::unordered_map<uint64_t,uint32_t>().swap(counting[line]);
+    }
+
+    //Candidate pairs have intersecting bounding boxes
+    std::vector<BoundingBox> boxes(footprints.size());
+
+    for(uint32_t line=0;line<footprints.size();line++){
+      const RasterFootprint & footprint = footprints[line];
+
+      if(footprint.getNbColumns() == 0) continue;
+
+      boxes[line].expand(footprint.getFirstColumn() * cellSize,footprint.getFirstRow() * cellSize);
+      boxes[line].expand((footprint.getFirstColumn() + footprint.getNbColumns()) * cellSize,(footprint.getFirstRow() + footprint.getNbRows()) * cellSize);
+    }
+
+    RTree tree(boxes);
+
+    std::vector<std::pair<uint32_t,uint32_t> > candidates;
+    std::vector<uint32_t> found;
+
+    for(uint32_t line=0;line<boxes.size();line++){
+      if(boxes[line].isEmpty()) continue;
+
+      tree.query(boxes[line],found);
+
+      for(auto i=found.begin();i!=found.end();i++){
+        if(*i > line) candidates.push_back(std::make_pair(line,*i));
+      }
+    }
+
+    std::sort(candidates.begin(),candidates.end());
+
+    //Candidates have very different costs, threads take the next one as they finish
+    std::vector<LineOverlap> evaluated(candidates.size());
+    std::atomic<size_t> next(0);
+
+    unsigned int threads = std::min<size_t>(nbThreads,candidates.size());
+
+    ThreadUtils::runChunks(threads,threads,[&](unsigned int thread,size_t begin,size_t end){
+      for(size_t i=next++;i<candidates.size();i=next++){
+        evaluated[i] = intersect(candidates[i].first,candidates[i].second);
+      }
+    });
+
+    overlaps.clear();
+
+    for(auto i=evaluated.begin();i!=evaluated.end();i++){
+      if(i->nbCells > 0) overlaps.push_back(*i);
+    }
+  }
+
+  /**Returns the overlapping pairs found by compute(), sorted by line*/
+  const std::vector<LineOverlap> & getOverlaps() const { return overlaps; }
+
+  /**Returns the number of lines*/
+  uint32_t getNbLines() const { return names.size(); }
+
+  /**
+  * Returns the name of a line
+  *
+  * @param line the index of the line
+  */
+  const std::string & getName(uint32_t line) const { return names[line]; }
+
+  /**
+  * Returns the number of cells in the footprint of a line, once computed
+  *
+  * @param line the index of the line
+  */
+  uint64_t getNbCells(uint32_t line) const { return footprints[line].getNbOccupiedCells(); }
+
+  /**
+  * Writes one line per overlapping pair: "line1 line2 cells points1 points2", the lines being named
+  *
+  * @param out the stream to write to
+  */
+  void write(std::ostream & out) const {
+    for(auto i=overlaps.begin();i!=overlaps.end();i++){
+      out << names[i->line1] << " " << names[i->line2] << " " << i->nbCells << " " << i->nbPoints1 << " " << i->nbPoints2 << std::endl;
+    }
+  }
+
+private:
+
+  /**
+  * Intersects the footprints of two lines
+  *
+  * @param line1 the index of the first line
+  * @param line2 the index of the second line
+  */
+  LineOverlap intersect(uint32_t line1,uint32_t line2) const {
+    LineOverlap overlap;
+    overlap.line1 = line1;
+    overlap.line2 = line2;
+    overlap.nbCells = 0;
+    overlap.nbPoints1 = 0;
+    overlap.nbPoints2 = 0;
+
+    RasterFootprint common = RasterFootprint::intersect(footprints[line1],footprints[line2]);
+
+    common.forEachCell([&](int64_t column,int64_t row){
+      uint64_t key = DtmGrid::cellKey((int32_t)column,(int32_t)row);
+
+      overlap.nbCells++;
+      overlap.nbPoints1 += getCount(line1,key);
+      overlap.nbPoints2 += getCount(line2,key);
+    });
+
+    return overlap;
+  }
+
+  /**
+  * Returns the number of points of a line in a cell, once computed
+  *
+  * @param line the index of the line
+  * @param key the key of the cell
+  */
+  uint32_t getCount(uint32_t line,uint64_t key) const {
+    const std::vector<std::pair<uint64_t,uint32_t> > & cells = counts[line];
+
+    auto cell = std::lower_bound(cells.begin(),cells.end(),std::make_pair(key,(uint32_t)0));
+
+    return (cell != cells.end() && cell->first == key) ? cell->second : 0;
+  }
+
+  /**Size of a footprint cell*/
+  double cellSize;
+
+  /**Number of threads*/
+  unsigned int nbThreads;
+
+  /**Names of the lines*/
+  std::vector<std::string> names;
+
+  /**Footprints of the lines*/
+  std::vector<RasterFootprint> footprints;
+
+  /**Point count of the cells of the lines, while points are added*/
+  std::vector<std::unordered_map<uint64_t,uint32_t> > counting;
+
+  /**Cells of the lines and their point count, sorted by cell key*/
+  std::vector<std::vector<std::pair<uint64_t,uint32_t> > > counts;
+
+  /**Overlapping pairs*/
+  std::vector<LineOverlap> overlaps;
+};
+
+#endif
@@ -0,0 +1,229 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef POLYGONINDEX_HPP
+#define POLYGONINDEX_HPP
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "../utils/ThreadUtils.hpp"
+
+/*!
+* \brief Polygon index class
+*
+* Point in polygon test backed by bands. Every edge of the polygon is filed in the bands it covers, so a point is
+* tested by crossing number against the few edges of its own band instead of against every edge. Bands are cut
+* across the longest side of the bounding box, so that the long sides of the footprint of a line are spread over
+* all the bands. With as many bands as vertices, a band holds a couple of edges for a convex hull and a handful
+* for the concave hull of a line, and a test costs about the same whatever the size of the polygon.
+*/
+class PolygonIndex{
+public:
+
+  /**
+  * Indexes a polygon
+  *
+  * @param vertices the vertices of the polygon, any container of objects with x and y members, not closed
+  * @param nbThreads number of threads used to test many points, 0 to use all the hardware threads
+  */
+  template<typename Vertices>
+  PolygonIndex(const Vertices & vertices,unsigned int nbThreads = 0) :
+  nbThreads(ThreadUtils::getNbThreads(nbThreads)),
+  swapped(false),
+  minX(0),
+  maxX(0),
+  minY(0),
+  maxY(0),
+  bandHeight(1){
+    x.reserve(vertices.size());
+    y.reserve(vertices.size());
+
+    for(size_t i=0;i<vertices.size();i++){
+      x.push_back(vertices[i].x);
+      y.push_back(vertices[i].y);
+    }
+
+    buildBands();
+  }
+
+  /**Destroys the index*/
+  ~PolygonIndex(){
+
+  }
+
+  /**
+  * Returns true if a position is inside the polygon
+  *
+  * @param px x position
+  * @param py y position
+  */
+  bool contains(double px,double py) const {
+    if(swapped) std::swap(px,py);
+
+    if(bandStart.empty() || px < minX || px > maxX || py < minY || py > maxY) return false;
+
+    size_t band = getBand(py);
+    bool inside = false;
+
+    for(uint32_t i=bandStart[band];i<bandStart[band + 1];i++){
+      uint32_t edge = bandEdges[i];
+      uint32_t next = (edge + 1 == x.size()) ? 0 : edge + 1;
+
+      if((y[edge] > py) != (y[next] > py) && px < (x[next] - x[edge]) * (py - y[edge]) / (y[next] - y[edge]) + x[edge]){
+        inside = !inside;
+      }
+    }
+
+    return inside;
+  }
+
+  /**
+  * Finds the points inside the polygon
+  *
+  * @param points the points, any container of objects with x and y members
+  * @param indices receives the indices of the points inside the polygon, in increasing order
+  */
+  template<typename Points>
+  void findPointsInside(const Points & points,std::vector<uint64_t> & indices) const {
+    size_t n = points.size();
+
+    ThreadUtils::selectIndices((n < 65536) ? 1 : nbThreads,n,[&](size_t i){
+      return contains(points[i].x,points[i].y);
+    },indices);
+  }
+
+  /**Returns the number of bands*/
+  size_t getNbBands() const { return bandStart.empty() ? 0 : bandStart.size() - 1; }
+
+  /**Returns the largest number of edges in a band*/
+  uint32_t getMaxEdgesPerBand() const {
+    uint32_t largest = 0;
+
+    for(size_t i=0;i + 1<bandStart.size();i++){
+      largest = std::max(largest,bandStart[i + 1] - bandStart[i]);
+    }
+
+    return largest;
+  }
+
+private:
+
+  /**Files the edges in the bands, leaving no band for a polygon without area*/
+  void buildBands(){
+    if(x.size() < 3) return;
+
+    minX = maxX = x[0];
+    minY = maxY = y[0];
+
+    for(size_t i=1;i<x.size();i++){
+      minX = std::min(minX,x[i]);
+      maxX = std::max(maxX,x[i]);
+      minY = std::min(minY,y[i]);
+      maxY = std::max(maxY,y[i]);
+    }
+
+    if(!(maxY > minY) || !(maxX > minX)) return;
+
+    //Work in a frame where the bands are across the longest side
+    if(maxX - minX > maxY - minY){
+      swapped = true;
+      x.swap(y);
+      std::swap(minX,minY);
+      std::swap(maxX,maxY);
+    }
+
+    size_t nbBands = x.size();
+    bandHeight = (maxY - minY) / nbBands;
+
+    //Count, then place the edges of every band
+    bandStart.assign(nbBands + 1,0);
+
+    for(size_t edge=0;edge<x.size();edge++){
+      size_t first,last;
+      getEdgeBands(edge,first,last);
+
+      for(size_t band=first;band<=last;band++){
+        bandStart[band + 1]++;
+      }
+    }
+
+    for(size_t band=0;band<nbBands;band++){
+      bandStart[band + 1] += bandStart[band];
+    }
+
+    bandEdges.resize(bandStart[nbBands]);
+
+    std::vector<uint32_t> cursor(bandStart.begin(),bandStart.end() - 1);
+
+    for(size_t edge=0;edge<x.size();edge++){
+      size_t first,last;
+      getEdgeBands(edge,first,last);
+
+      for(size_t band=first;band<=last;band++){
+        bandEdges[cursor[band]++] = edge;
+      }
+    }
+  }
+
+  /**
+  * Returns the band of a y position inside the bounding box
+  *
+  * @param py y position
+  */
+  size_t getBand(double py) const {
+    size_t band = (size_t)((py - minY) / bandHeight);
+    return std::min(band,bandStart.size() - 2);
+  }
+
+  /**
+  * Returns the bands covered by an edge
+  *
+  * @param edge the edge, from vertex edge to the next one
+  * @param first receives the first band
+  * @param last receives the last band
+  */
+  void getEdgeBands(size_t edge,size_t & first,size_t & last) const {
+    size_t next = (edge + 1 == x.size()) ? 0 : edge + 1;
+
+    first = getBand(std::min(y[edge],y[next]));
+    last  = getBand(std::max(y[edge],y[next]));
+  }
+
+  /**Number of threads*/
+  unsigned int nbThreads;
+
+  /**True if x and y are swapped, the bands being cut along x*/
+  bool swapped;
+
+  /**x of the vertices*/
+  std::vector<double> x;
+
+  /**y of the vertices*/
+  std::vector<double> y;
+
+  /**Smallest x of the polygon*/
+  double minX;
+
+  /**Largest x of the polygon*/
+  double maxX;
+
+  /**Smallest y of the polygon*/
+  double minY;
+
+  /**Largest y of the polygon*/
+  double maxY;
+
+  /**Height of a band*/
+  double bandHeight;
+
+  /**Position of the first edge of every band in bandEdges, plus the end of the last band*/
+  std::vector<uint32_t> bandStart;
+
+  /**Edges of the bands, band after band*/
+  std::vector<uint32_t> bandEdges;
+};
+
+#endif
@@ -0,0 +1,622 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef RASTERFOOTPRINT_HPP
+#define RASTERFOOTPRINT_HPP
+
+#include <vector>
+#include <unordered_map>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <thread>
+#include <bitset>
+#include "../utils/Exception.hpp"
+#include "../gridding/DtmGrid.hpp"
+#include "../utils/ThreadUtils.hpp"
+
+/*!
+* \brief Raster footprint vertex
+*
+* A vertex of the outline of a footprint
+*/
+struct RasterFootprintVertex{
+  /**x position*/
+  double x;
+
+  /**y position*/
+  double y;
+};
+
+/*!
+* \brief Raster footprint class
+*
+* Footprint of a line, as the cells of a regular grid that contain at least one point. All footprints with the
+* same cell size share the same lattice, whose cell (0,0) starts at the origin, so that the overlap of two lines
+* is the intersection of their grids. Building a footprint, intersecting two of them and testing points against
+* one are linear in the number of points or cells, and the work is split across chunks of points or of tiles between
+* threads. The cell size plays the role of the alpha of a concave hull: it must be larger than the spacing between
+* soundings for the footprint not to have holes.
+*
+* The grid is sparse: cells are stored as bits in tiles of 64 x 64 cells, and only the tiles holding an occupied cell
+* exist. Memory follows the area covered by the line, not its bounding box, so a long diagonal line at a fine cell
+* size stays small.
+*/
+class RasterFootprint{
+public:
+
+  /**
+  * Creates an empty footprint
+  *
+  * @param cellSize the size of a cell
+  * @param nbThreads number of threads, 0 to use all the hardware threads
+  */
+  RasterFootprint(double cellSize,unsigned int nbThreads = 0) :
+  cellSize(cellSize),
+  nbThreads(ThreadUtils::getNbThreads(nbThreads)),
+  originColumn(0),
+  originRow(0),
+  columns(0),
+  rows(0){
+    if(!(cellSize > 0)){
+      throw new Exception("The cell size of a raster footprint must be positive");
+    }
+  }
+
+  /**Destroys the footprint*/
+  ~RasterFootprint(){
+
+  }
+
+  /**
+  * Replaces the footprint by the cells containing the given points
+  *
+  * @param points the points, any container of objects with x and y members, such as the points of a pcl::PointCloud
+  */
+  template<typename Points>
+  void rasterize(const Points & points){
+    tiles.clear();
+    columns = 0;
+    rows = 0;
+
+    size_t n = points.size();
+
+    if(n == 0) return;
+
+    //Every chunk of points is marked in its own tiles, with its bounds
+    unsigned int threads = (n < 65536) ? 1 : nbThreads;
+
+    std::vector<int64_t> bounds(threads * 4);
+    std::vector<TileMap> marked(threads);
+
+    ThreadUtils::runChunks(threads,n,[&](unsigned int thread,size_t begin,size_t end){
+      int64_t * bound = &bounds[thread * 4];
+
+      bound[0] = bound[1] = std::numeric_limits<int64_t>::max();
+      bound[2] = bound[3] = std::numeric_limits<int64_t>::min();
+
+      TileMap & local = marked[thread];
+
+      //Consecutive points of a line usually fall in the same tile
+      uint64_t lastKey = 0;
+      Tile * lastTile = NULL;
+
+      for(size_t i=begin;i<end;i++){
+        int64_t column = toLattice(points[i].x);
+        int64_t row    = toLattice(points[i].y);
+
+        bound[0] = std::min(bound[0],column);
+        bound[1] = std::min(bound[1],row);
+        bound[2] = std::max(bound[2],column);
+        bound[3] = std::max(bound[3],row);
+
+        uint64_t key = tileKey(tileOf(column),tileOf(row));
+
+        if(lastTile == NULL || key != lastKey){
+          lastTile = &local[key];
+          lastKey = key;
+        }
+
+        setCell(*lastTile,column,row);
+      }
+    });
+
+    int64_t minColumn = bounds[0],minRow = bounds[1],maxColumn = bounds[2],maxRow = bounds[3];
+
+    for(unsigned int thread=1;thread<threads;thread++){
+      if(bounds[thread * 4] > bounds[thread * 4 + 2]) continue; //empty chunk
+
+      minColumn = std::min(minColumn,bounds[thread * 4]);
+      minRow    = std::min(minRow,bounds[thread * 4 + 1]);
+      maxColumn = std::max(maxColumn,bounds[thread * 4 + 2]);
+      maxRow    = std::max(maxRow,bounds[thread * 4 + 3]);
+    }
+
+    originColumn = minColumn;
+    originRow = minRow;
+    columns = maxColumn - minColumn + 1;
+    rows = maxRow - minRow + 1;
+
+    //Merge the tiles of the chunks
+    tiles.swap(marked[0]);
+
+    for(unsigned int thread=1;thread<threads;thread++){
+      for(auto i=marked[thread].begin();i!=marked[thread].end();i++){
+        Tile & tile = tiles[i->first];
+
+        for(int64_t row=0;row<TILE_CELLS;row++){
+          tile.rows[row] |= i->second.rows[row];
+        }
+      }
+    }
+  }
+
+  /**
+  * Adds the cell containing a point to the footprint, for points that come one at a time. Throws if the point is
+  * beyond the cell indices of the lattice.
+  *
+  * @param x x position
+  * @param y y position
+  */
+  void addPoint(double x,double y){
+    int64_t column = DtmGrid::cellIndex(x,cellSize);
+    int64_t row    = DtmGrid::cellIndex(y,cellSize);
+
+    if(columns == 0){
+      originColumn = column;
+      originRow = row;
+      columns = 1;
+      rows = 1;
+    }
+    else{
+      int64_t maxColumn = std::max(originColumn + columns - 1,column);
+      int64_t maxRow    = std::max(originRow + rows - 1,row);
+
+      originColumn = std::min(originColumn,column);
+      originRow = std::min(originRow,row);
+      columns = maxColumn - originColumn + 1;
+      rows = maxRow - originRow + 1;
+    }
+
+    setCell(tiles[tileKey(tileOf(column),tileOf(row))],column,row);
+  }
+
+  /**
+  * Returns the footprint of the cells occupied in both footprints
+  *
+  * @param a the first footprint
+  * @param b the second footprint, with the same cell size as the first one
+  */
+  static RasterFootprint intersect(const RasterFootprint & a,const RasterFootprint & b){
+    if(a.cellSize != b.cellSize){
+      throw new Exception("Raster footprints with different cell sizes cannot be intersected");
+    }
+
+    RasterFootprint overlap(a.cellSize,a.nbThreads);
+
+    int64_t minColumn = std::max(a.originColumn,b.originColumn);
+    int64_t minRow    = std::max(a.originRow,b.originRow);
+    int64_t maxColumn = std::min(a.originColumn + a.columns,b.originColumn + b.columns);
+    int64_t maxRow    = std::min(a.originRow + a.rows,b.originRow + b.rows);
+
+    if(minColumn >= maxColumn || minRow >= maxRow) return overlap;
+
+    overlap.originColumn = minColumn;
+    overlap.originRow = minRow;
+    overlap.columns = maxColumn - minColumn;
+    overlap.rows = maxRow - minRow;
+
+    //Tiles occupied in both footprints, intersected in chunks
+    std::vector<std::pair<uint64_t,const Tile *> > candidates;
+
+    for(auto i=a.tiles.begin();i!=a.tiles.end();i++){
+      candidates.push_back(std::make_pair(i->first,&i->second));
+    }
+
+    unsigned int threads = overlap.tileThreads(candidates.size());
+    std::vector<std::vector<std::pair<uint64_t,Tile> > > found(threads);
+
+    ThreadUtils::runChunks(threads,candidates.size(),[&](unsigned int thread,size_t begin,size_t end){
+      for(size_t i=begin;i<end;i++){
+        auto other = b.tiles.find(candidates[i].first);
+
+        if(other == b.tiles.end()) continue;
+
+        Tile tile;
+        uint64_t occupied = 0;
+
+        for(int64_t row=0;row<TILE_CELLS;row++){
+          tile.rows[row] = candidates[i].second->rows[row] & other->second.rows[row];
+          occupied |= tile.rows[row];
+        }
+
+        if(occupied) found[thread].push_back(std::make_pair(candidates[i].first,tile));
+      }
+    });
+
+    for(auto i=found.begin();i!=found.end();i++){
+      overlap.tiles.insert(i->begin(),i->end());
+    }
+
+    return overlap;
+  }
+
+  /**
+  * Returns true if a position falls in an occupied cell
+  *
+  * @param x x position
+  * @param y y position
+  */
+  bool contains(double x,double y) const {
+    int64_t column = toLattice(x);
+    int64_t row    = toLattice(y);
+
+    if(column < originColumn || row < originRow || column >= originColumn + columns || row >= originRow + rows) return false;
+
+    return isOccupied(column,row);
+  }
+
+  /**
+  * Finds the points that fall in an occupied cell
+  *
+  * @param points the points, any container of objects with x and y members
+  * @param indices receives the indices of the points inside the footprint, in increasing order
+  */
+  template<typename Points>
+  void findPointsInside(const Points & points,std::vector<uint64_t> & indices) const {
+    indices.clear();
+
+    size_t n = points.size();
+
+    if(n == 0 || tiles.empty()) return;
+
+    ThreadUtils::selectIndices((n < 65536) ? 1 : nbThreads,n,[&](size_t i){
+      return contains(points[i].x,points[i].y);
+    },indices);
+  }
+
+  /**
+  * Extracts the outline of the footprint with marching squares, through the middle of the edges between occupied
+  * and empty cells. Outer rings are counter-clockwise and holes are clockwise. Diagonal neighbours are not connected.
+  * Only the squares of the tiles next to occupied tiles are visited.
+  *
+  * @param rings receives the closed rings, whose first vertex is not repeated at the end
+  */
+  void computeOutline(std::vector<std::vector<RasterFootprintVertex> > & rings) const {
+    rings.clear();
+
+    if(tiles.empty()) return;
+
+    //Square (i,j) has cell (i,j) at its top right corner and belongs to the tile of that cell: a square touching
+    //an occupied cell belongs to the tile of that cell or to the tile on its right, above or above right
+    std::vector<std::pair<int64_t,int64_t> > squareTiles;
+
+    for(auto i=tiles.begin();i!=tiles.end();i++){
+      int64_t tileColumn = keyColumn(i->first);
+      int64_t tileRow    = keyRow(i->first);
+
+      for(int64_t dy=0;dy<2;dy++){
+        for(int64_t dx=0;dx<2;dx++){
+          squareTiles.push_back(std::make_pair(tileRow + dy,tileColumn + dx));
+        }
+      }
+    }
+
+    //Row order keeps the rings in the same order from run to run
+    std::sort(squareTiles.begin(),squareTiles.end());
+    squareTiles.erase(std::unique(squareTiles.begin(),squareTiles.end()),squareTiles.end());
+
+    //Crossings are numbered on the grid of the bounding box padded with an empty border, where the bottom left
+    //sample of square (c,r) relative to the origin is (c,r)
+    int64_t sampleColumns = columns + 2;
+
+    unsigned int threads = tileThreads(squareTiles.size());
+    std::vector<std::vector<std::pair<uint64_t,uint64_t> > > segments(threads);
+
+    ThreadUtils::runChunks(threads,squareTiles.size(),[&](unsigned int thread,size_t begin,size_t end){
+      std::vector<std::pair<uint64_t,uint64_t> > & out = segments[thread];
+
+      for(size_t t=begin;t<end;t++){
+        int64_t tileRow    = squareTiles[t].first;
+        int64_t tileColumn = squareTiles[t].second;
+
+        //This tile and the tiles on its left, below and below left: [above][right]
+        const Tile * neighbours[2][2] = {
+          { findTile(tileColumn - 1,tileRow - 1),findTile(tileColumn,tileRow - 1) },
+          { findTile(tileColumn - 1,tileRow),findTile(tileColumn,tileRow) }
+        };
+
+        //Cell of the neighbourhood, from -1 to TILE_CELLS - 1 in the tile
+        auto cell = [&](int64_t column,int64_t row) -> unsigned int {
+          const Tile * tile = neighbours[row >= 0][column >= 0];
+
+          if(tile == NULL) return 0;
+
+          return (tile->rows[(row + TILE_CELLS) % TILE_CELLS] >> ((column + TILE_CELLS) % TILE_CELLS)) & 1;
+        };
+
+        for(int64_t j=0;j<TILE_CELLS;j++){
+          for(int64_t i=0;i<TILE_CELLS;i++){
+            unsigned int square = cell(i - 1,j - 1)
+                                | (cell(i,j - 1) << 1)
+                                | (cell(i,j) << 2)
+                                | (cell(i - 1,j) << 3);
+
+            if(square == 0 || square == 15) continue;
+
+            uint64_t column = tileColumn * TILE_CELLS + i - originColumn;
+            uint64_t row    = tileRow * TILE_CELLS + j - originRow;
+
+            //Edge crossings, numbered from the sample they start at
+            uint64_t bottom = 2 * (row * sampleColumns + column);
+            uint64_t top    = 2 * ((row + 1) * sampleColumns + column);
+            uint64_t left   = bottom + 1;
+            uint64_t right  = 2 * (row * sampleColumns + column + 1) + 1;
+
+            //Segments keep the occupied cells on their left
+            switch(square){
+              case 1:  out.push_back(std::make_pair(bottom,left));  break;
+              case 2:  out.push_back(std::make_pair(right,bottom)); break;
+              case 3:  out.push_back(std::make_pair(right,left));   break;
+              case 4:  out.push_back(std::make_pair(top,right));    break;
+              case 5:  out.push_back(std::make_pair(bottom,left));
+                       out.push_back(std::make_pair(top,right));    break;
+              case 6:  out.push_back(std::make_pair(top,bottom));   break;
+              case 7:  out.push_back(std::make_pair(top,left));     break;
+              case 8:  out.push_back(std::make_pair(left,top));     break;
+              case 9:  out.push_back(std::make_pair(bottom,top));   break;
+              case 10: out.push_back(std::make_pair(right,bottom));
+                       out.push_back(std::make_pair(left,top));     break;
+              case 11: out.push_back(std::make_pair(right,top));    break;
+              case 12: out.push_back(std::make_pair(left,right));   break;
+              case 13: out.push_back(std::make_pair(bottom,right)); break;
+              case 14: out.push_back(std::make_pair(left,bottom));  break;
+            }
+          }
+        }
+      }
+    });
+
+    //Every crossing starts exactly one segment and ends exactly one
+    std::unordered_map<uint64_t,uint64_t> next;
+
+    for(auto i=segments.begin();i!=segments.end();i++){
+      for(auto j=i->begin();j!=i->end();j++){
+        next[j->first] = j->second;
+      }
+    }
+
+    for(auto i=segments.begin();i!=segments.end();i++){
+      for(auto j=i->begin();j!=i->end();j++){
+        auto start = next.find(j->first);
+
+        if(start == next.end()) continue; //already in a ring
+
+        std::vector<RasterFootprintVertex> ring;
+        uint64_t crossing = j->first;
+
+        while(true){
+          auto k = next.find(crossing);
+
+          if(k == next.end()) break;
+
+          ring.push_back(crossingPosition(crossing));
+          crossing = k->second;
+          next.erase(k);
+        }
+
+        rings.push_back(ring);
+      }
+    }
+  }
+
+  /**
+  * Calls a function with the lattice column and row of every occupied cell, tile by tile
+  *
+  * @param function called with the column and the row of a cell
+  */
+  template<typename Function>
+  void forEachCell(Function function) const {
+    for(auto i=tiles.begin();i!=tiles.end();i++){
+      int64_t firstColumn = keyColumn(i->first) * TILE_CELLS;
+      int64_t firstRow    = keyRow(i->first) * TILE_CELLS;
+
+      for(int64_t row=0;row<TILE_CELLS;row++){
+        uint64_t bits = i->second.rows[row];
+
+        for(int64_t column=0;bits != 0;column++,bits >>= 1){
+          if(bits & 1) function(firstColumn + column,firstRow + row);
+        }
+      }
+    }
+  }
+
+  /**Returns the number of occupied cells*/
+  uint64_t getNbOccupiedCells() const {
+    uint64_t count = 0;
+
+    for(auto i=tiles.begin();i!=tiles.end();i++){
+      for(int64_t row=0;row<TILE_CELLS;row++){
+        count += std::bitset<64>(i->second.rows[row]).count();
+      }
+    }
+
+    return count;
+  }
+
+  /**Returns the area covered by the occupied cells*/
+  double getArea() const { return getNbOccupiedCells() * cellSize * cellSize; }
+
+  /**Returns the size of a cell*/
+  double getCellSize() const { return cellSize; }
+
+  /**Returns the lattice column of the first column of the bounding box of the footprint*/
+  int64_t getFirstColumn() const { return originColumn; }
+
+  /**Returns the lattice row of the first row of the bounding box of the footprint*/
+  int64_t getFirstRow() const { return originRow; }
+
+  /**Returns the number of columns of the bounding box of the footprint*/
+  int64_t getNbColumns() const { return columns; }
+
+  /**Returns the number of rows of the bounding box of the footprint*/
+  int64_t getNbRows() const { return rows; }
+
+  /**Returns the number of tiles holding occupied cells*/
+  size_t getNbTiles() const { return tiles.size(); }
+
+  /**Returns true if no cell is occupied*/
+  bool isEmpty() const { return getNbOccupiedCells() == 0; }
+
+private:
+
+  /**Width of a tile, in cells: a row of a tile is a 64 bit word*/
+  static const int64_t TILE_CELLS = 64;
+
+  /**
+  * Occupancy of the cells of a tile, one bit per cell
+  */
+  struct Tile{
+    /**Creates an empty tile*/
+    Tile(){
+      std::fill(rows,rows + TILE_CELLS,0);
+    }
+
+    /**Rows of the tile, bit c of row r being cell (c,r)*/
+    uint64_t rows[TILE_CELLS];
+  };
+
+  /**Tiles by tile key*/
+  typedef std::unordered_map<uint64_t,Tile> TileMap;
+
+  /**
+  * Returns the number of threads to use over a number of tiles, one for few tiles
+  *
+  * @param nbTiles the number of tiles
+  */
+  unsigned int tileThreads(size_t nbTiles) const {
+    return (nbTiles < 16) ? 1 : (unsigned int)std::min<size_t>(nbThreads,nbTiles);
+  }
+
+  /**
+  * Marks a cell of a tile
+  *
+  * @param tile the tile of the cell
+  * @param column the lattice column of the cell
+  * @param row the lattice row of the cell
+  */
+  static void setCell(Tile & tile,int64_t column,int64_t row){
+    tile.rows[row - tileOf(row) * TILE_CELLS] |= (uint64_t)1 << (column - tileOf(column) * TILE_CELLS);
+  }
+
+  /**
+  * Returns the lattice index of a coordinate
+  *
+  * @param value the coordinate
+  */
+  int64_t toLattice(double value) const {
+    return (int64_t)std::floor(value / cellSize);
+  }
+
+  /**
+  * Returns the tile of a lattice index
+  *
+  * @param index the column or row of a cell
+  */
+  static int64_t tileOf(int64_t index){
+    return (index >= 0) ? index / TILE_CELLS : -((-index + TILE_CELLS - 1) / TILE_CELLS);
+  }
+
+  /**
+  * Returns the key of a tile
+  *
+  * @param tileColumn the column of the tile
+  * @param tileRow the row of the tile
+  */
+  static uint64_t tileKey(int64_t tileColumn,int64_t tileRow){
+    return ((uint64_t)(uint32_t)(int32_t)tileColumn << 32) | (uint64_t)(uint32_t)(int32_t)tileRow;
+  }
+
+  /**Returns the column of a tile key*/
+  static int64_t keyColumn(uint64_t key){ return (int32_t)(uint32_t)(key >> 32); }
+
+  /**Returns the row of a tile key*/
+  static int64_t keyRow(uint64_t key){ return (int32_t)(uint32_t)(key & 0xFFFFFFFF); }
+
+  /**
+  * Returns a tile, NULL if it holds no occupied cell
+  *
+  * @param tileColumn the column of the tile
+  * @param tileRow the row of the tile
+  */
+  const Tile * findTile(int64_t tileColumn,int64_t tileRow) const {
+    auto i = tiles.find(tileKey(tileColumn,tileRow));
+    return (i != tiles.end()) ? &i->second : NULL;
+  }
+
+  /**
+  * Returns true if a cell of the lattice is occupied
+  *
+  * @param column the lattice column of the cell
+  * @param row the lattice row of the cell
+  */
+  bool isOccupied(int64_t column,int64_t row) const {
+    const Tile * tile = findTile(tileOf(column),tileOf(row));
+
+    if(tile == NULL) return false;
+
+    return (tile->rows[row - tileOf(row) * TILE_CELLS] >> (column - tileOf(column) * TILE_CELLS)) & 1;
+  }
+
+  /**
+  * Returns the position of an edge crossing
+  *
+  * @param crossing the crossing number, twice the sample it starts at, plus one if the edge goes up
+  */
+  RasterFootprintVertex crossingPosition(uint64_t crossing) const {
+    int64_t sampleIndex = crossing / 2;
+    int64_t column = sampleIndex % (columns + 2);
+    int64_t row    = sampleIndex / (columns + 2);
+
+    //Sample (c,r) is the center of cell (c-1,r-1)
+    double x = originColumn + column - 0.5;
+    double y = originRow + row - 0.5;
+
+    if(crossing % 2 == 0){
+      x += 0.5;
+    }
+    else{
+      y += 0.5;
+    }
+
+    RasterFootprintVertex vertex;
+    vertex.x = x * cellSize;
+    vertex.y = y * cellSize;
+    return vertex;
+  }
+
+  /**Size of a cell*/
+  double cellSize;
+
+  /**Number of threads*/
+  unsigned int nbThreads;
+
+  /**Lattice column of the first column of the bounding box*/
+  int64_t originColumn;
+
+  /**Lattice row of the first row of the bounding box*/
+  int64_t originRow;
+
+  /**Number of columns of the bounding box*/
+  int64_t columns;
+
+  /**Number of rows of the bounding box*/
+  int64_t rows;
+
+  /**Tiles holding at least one occupied cell*/
+  TileMap tiles;
+};
+
+#endif
@@ -0,0 +1,127 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef COVERAGEGEOREFERENCER_HPP
+#define COVERAGEGEOREFERENCER_HPP
+
+#include "StreamingGeoreferencer.hpp"
+#include "../geometry/CoveragePolygon.hpp"
+#include "../math/CoordinateTransform.hpp"
+
+/*!
+* \brief Coverage georeferencer class
+*
+* Extends from StreamingGeoreferencer. Of each georeferenced swath, only the beams with the smallest and the largest
+* across track angle are kept, and they are added to a coverage polygon at the end of the swath. The coverage of
+* the line is up to date after every ping, without storing the soundings or computing their hull.
+* With LGF georeferencing, the polygon is in the local NED frame (x north, y east, in meters).
+* With TRF georeferencing, the polygon is in longitude and latitude (decimal degrees).
+*/
+class CoverageGeoreferencer : public StreamingGeoreferencer{
+public:
+
+  /**
+  * Creates a coverage georeferencer
+  *
+  * @param geo the georeferencing method
+  * @param svpStrat the svp selection strategy
+  * @param leverArm lever arm
+  * @param boresight boresight (dPhi,dTheta,dPsi)
+  * @param coverage the coverage polygon receiving the swaths
+  */
+  CoverageGeoreferencer(Georeferencing & geo,SvpSelectionStrategy & svpStrat,Eigen::Vector3d & leverArm,Eigen::Matrix3d & boresight,CoveragePolygon & coverage) :
+  StreamingGeoreferencer(geo,svpStrat,leverArm,boresight),
+  coverage(coverage),
+  geographic(dynamic_cast<GeoreferencingTRF*>(&geo) != NULL),
+  geographicPosition(0,0,0,0),
+  hasBeams(false),
+  portAngle(0),
+  starboardAngle(0){
+
+  }
+
+  /**Destroys the coverage georeferencer*/
+  virtual ~CoverageGeoreferencer(){
+
+  }
+
+  virtual void processGeoreferencedSwathStart(uint64_t microEpoch){
+    hasBeams = false;
+  }
+
+  virtual void processGeoreferencedBeam(Eigen::Vector3d & georeferencedPing,Ping & ping){
+    double angle = ping.getAcrossTrackAngle();
+
+    if(!hasBeams || angle < portAngle){
+      portAngle = angle;
+      toPlane(georeferencedPing,portX,portY);
+    }
+
+    if(!hasBeams || angle > starboardAngle){
+      starboardAngle = angle;
+      toPlane(georeferencedPing,starboardX,starboardY);
+    }
+
+    hasBeams = true;
+  }
+
+  virtual void processGeoreferencedSwathEnd(){
+    if(hasBeams){
+      coverage.add(portX,portY,starboardX,starboardY);
+    }
+  }
+
+private:
+
+  /**
+  * Returns the horizontal position of a georeferenced beam in the frame of the polygon
+  *
+  * @param georeferencedPing the georeferenced beam
+  * @param x receives the x position
+  * @param y receives the y position
+  */
+  void toPlane(Eigen::Vector3d & georeferencedPing,double & x,double & y){
+    if(geographic){
+      CoordinateTransform::convertECEFToLongitudeLatitudeElevation(georeferencedPing,geographicPosition);
+      x = geographicPosition.getLongitude();
+      y = geographicPosition.getLatitude();
+    }
+    else{
+      x = georeferencedPing(0);
+      y = georeferencedPing(1);
+    }
+  }
+
+  /**The coverage polygon*/
+  CoveragePolygon & coverage;
+
+  /**True if the points are converted from ECEF to geographic coordinates*/
+  bool geographic;
+
+  /**Conversion buffer*/
+  Position geographicPosition;
+
+  /**True once a beam of the current swath was received*/
+  bool hasBeams;
+
+  /**Across track angle of the outermost port beam of the current swath*/
+  double portAngle;
+
+  /**Across track angle of the outermost starboard beam of the current swath*/
+  double starboardAngle;
+
+  /**x position of the outermost port beam of the current swath*/
+  double portX;
+
+  /**y position of the outermost port beam of the current swath*/
+  double portY;
+
+  /**x position of the outermost starboard beam of the current swath*/
+  double starboardX;
+
+  /**y position of the outermost starboard beam of the current swath*/
+  double starboardY;
+};
+
+#endif
@@ -137,7 +137,8 @@ public:
         //Sort everything
         std::sort(positions.begin(), positions.end(), &Position::sortByTimestamp);
         std::sort(attitudes.begin(), attitudes.end(), &Attitude::sortByTimestamp);
-        std::sort(pings.begin(), pings.end(), &Ping::sortByTimestamp);
+        //stable sort keeps the beams of a swath in their across-track order
+        std::stable_sort(pings.begin(), pings.end(), &Ping::sortByTimestamp);
 
         fprintf(stderr, "[+] Position data points: %ld [%lu to %lu]\n", positions.size(), positions[0].getTimestamp(), positions[positions.size() - 1].getTimestamp());
         fprintf(stderr, "[+] Attitude data points: %ld [%lu to %lu]\n", attitudes.size(), attitudes[0].getTimestamp(), attitudes[attitudes.size() - 1].getTimestamp());
@@ -147,6 +148,10 @@ public:
         unsigned int attitudeIndex = 0;
         unsigned int positionIndex = 0;
 
+        //Beams sharing a timestamp belong to the same swath
+        bool swathStarted = false;
+        uint64_t swathTimestamp = 0;
+
         //Georef pings
         for (auto i = pings.begin(); i != pings.end(); i++) {
 
@@ -186,6 +191,16 @@ public:
             Attitude * interpolatedAttitude = Interpolator::interpolateAttitude(beforeAttitude, afterAttitude, (*i).getTimestamp());
             Position * interpolatedPosition = Interpolator::interpolatePosition(beforePosition, afterPosition, (*i).getTimestamp());
 
+            if (!swathStarted || (*i).getTimestamp() != swathTimestamp) {
+                if (swathStarted) {
+                    processGeoreferencedSwathEnd();
+                }
+
+                swathStarted = true;
+                swathTimestamp = (*i).getTimestamp();
+                processGeoreferencedSwathStart(swathTimestamp);
+            }
+
             //georeference
             Eigen::Vector3d georeferencedPing;
             georef.georeference(georeferencedPing, *interpolatedAttitude, *interpolatedPosition, (*i), *(svpStrategy.chooseSvp(*interpolatedPosition, *i)), leverArm, boresight);
@@ -195,6 +210,24 @@ public:
             delete interpolatedAttitude;
             delete interpolatedPosition;
         }
+
+        if (swathStarted) {
+            processGeoreferencedSwathEnd();
+        }
+    }
+
+    /**
+     * Called before the georeferenced beams of a new swath are processed
+     *
+     * @param microEpoch the swath timestamp
+     */
+    virtual void processGeoreferencedSwathStart(uint64_t microEpoch) {
+    }
+
+    /**
+     * Called once all the georeferenced beams of the current swath have been processed
+     */
+    virtual void processGeoreferencedSwathEnd() {
     }
 
     virtual void processGeoreferencedPing(Eigen::Vector3d & georeferencedPing, uint32_t quality, int32_t intensity, int positionIndex, int attitudeIndex) {
@@ -0,0 +1,103 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef GRIDDINGGEOREFERENCER_HPP
+#define GRIDDINGGEOREFERENCER_HPP
+
+#include "DatagramGeoreferencer.hpp"
+#include "../gridding/DtmGrid.hpp"
+#include "../gridding/TiledDtm.hpp"
+#include "../gridding/ParallelGridder.hpp"
+
+/*!
+* \brief Gridding georeferencer class
+*
+* Extends from DatagramGeoreferencer. Grids the georeferenced pings as they are produced instead of printing them.
+* With LGF georeferencing, the grid is in the local NED frame (x north, y east, z down, in meters).
+* With TRF georeferencing, the grid is in longitude and latitude (decimal degrees) against the ellipsoidal height.
+*/
+class GriddingGeoreferencer : public DatagramGeoreferencer{
+public:
+
+  /**
+  * Creates a gridding georeferencer
+  *
+  * @param geo the georeferencing method
+  * @param svpStrat the svp selection strategy
+  * @param grid the grid receiving the pings, whose resolution is in the units of the georeferencing method
+  * @param nbThreads number of gridding threads, 0 to use all the hardware threads
+  */
+  GriddingGeoreferencer(Georeferencing & geo,SvpSelectionStrategy & svpStrat,DtmGrid & grid,unsigned int nbThreads = 0)
+  : DatagramGeoreferencer(geo,svpStrat), grid(&grid), tiles(NULL), nbThreads(nbThreads), gridder(NULL){
+
+  }
+
+  /**
+  * Creates a gridding georeferencer writing into the level 0 of a tiled DTM
+  *
+  * @param geo the georeferencing method
+  * @param svpStrat the svp selection strategy
+  * @param tiles the tiled DTM receiving the pings, whose resolution is in the units of the georeferencing method
+  * @param nbThreads number of gridding threads, 0 to use all the hardware threads
+  */
+  GriddingGeoreferencer(Georeferencing & geo,SvpSelectionStrategy & svpStrat,TiledDtm & tiles,unsigned int nbThreads = 0)
+  : DatagramGeoreferencer(geo,svpStrat), grid(NULL), tiles(&tiles), nbThreads(nbThreads), gridder(NULL){
+
+  }
+
+  /**Destroys the gridding georeferencer*/
+  virtual ~GriddingGeoreferencer(){
+    if(gridder) delete gridder;
+  }
+
+  /**
+  * Georeferences all pings into the grid or the tiled DTM
+  *
+  * @param leverArm lever arm
+  * @param boresight boresight (dPhi,dTheta,dPsi)
+  * @param externalSvps svps specified by the user
+  */
+  virtual void georeference(Eigen::Vector3d & leverArm, Eigen::Matrix3d & boresight, std::vector<SoundVelocityProfile*> & externalSvps){
+    bool geographic = (dynamic_cast<GeoreferencingTRF*>(&georef) != NULL);
+
+    if(tiles){
+      gridder = new ParallelGridder(*tiles,nbThreads,geographic);
+    }
+    else{
+      gridder = new ParallelGridder(grid->getResolution(),nbThreads,geographic);
+    }
+
+    DatagramGeoreferencer::georeference(leverArm,boresight,externalSvps);
+
+    if(tiles){
+      gridder->finish();
+    }
+    else{
+      gridder->finish(*grid);
+    }
+
+    delete gridder;
+    gridder = NULL;
+  }
+
+  virtual void processGeoreferencedPing(Eigen::Vector3d & georeferencedPing, uint32_t quality, int32_t intensity, int positionIndex, int attitudeIndex){
+    gridder->add(georeferencedPing(0),georeferencedPing(1),georeferencedPing(2));
+  }
+
+private:
+
+  /**The grid receiving the pings, or NULL*/
+  DtmGrid * grid;
+
+  /**The tiled DTM receiving the pings, or NULL*/
+  TiledDtm * tiles;
+
+  /**Number of gridding threads*/
+  unsigned int nbThreads;
+
+  /**Gridder of the current georeferencing*/
+  ParallelGridder * gridder;
+};
+
+#endif
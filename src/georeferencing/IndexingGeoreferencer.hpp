@@ -0,0 +1,67 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef INDEXINGGEOREFERENCER_HPP
+#define INDEXINGGEOREFERENCER_HPP
+
+#include <string>
+#include "DatagramGeoreferencer.hpp"
+#include "../index/SoundingIndex.hpp"
+
+/*!
+* \brief Indexing georeferencer class
+*
+* Extends from DatagramGeoreferencer. Writes the georeferenced pings to a sounding index file instead of printing them,
+* so that they can later be queried by bounding box with SoundingIndex.
+*/
+class IndexingGeoreferencer : public DatagramGeoreferencer{
+public:
+
+  /**
+  * Creates an indexing georeferencer
+  *
+  * @param geo the georeferencing method
+  * @param svpStrat the svp selection strategy
+  * @param indexFilename the sounding index file to write
+  * @param nbThreads number of threads used to build the index, 0 to use all the hardware threads
+  */
+  IndexingGeoreferencer(Georeferencing & geo,SvpSelectionStrategy & svpStrat,const std::string & indexFilename,unsigned int nbThreads = 0)
+  : DatagramGeoreferencer(geo,svpStrat), indexFilename(indexFilename), builder(256,nbThreads){
+
+  }
+
+  /**Destroys the indexing georeferencer*/
+  virtual ~IndexingGeoreferencer(){
+
+  }
+
+  /**
+  * Georeferences all pings, then builds and writes the index
+  *
+  * @param leverArm lever arm
+  * @param boresight boresight (dPhi,dTheta,dPsi)
+  * @param externalSvps svps specified by the user
+  */
+  virtual void georeference(Eigen::Vector3d & leverArm, Eigen::Matrix3d & boresight, std::vector<SoundVelocityProfile*> & externalSvps){
+    DatagramGeoreferencer::georeference(leverArm,boresight,externalSvps);
+
+    std::cerr << "[+] Indexing " << builder.getNbSoundings() << " soundings in " << indexFilename << std::endl;
+
+    builder.write(indexFilename);
+  }
+
+  virtual void processGeoreferencedPing(Eigen::Vector3d & georeferencedPing, uint32_t quality, int32_t intensity, int positionIndex, int attitudeIndex){
+    builder.add(georeferencedPing(0),georeferencedPing(1),georeferencedPing(2),quality,intensity);
+  }
+
+private:
+
+  /**The sounding index file to write*/
+  std::string indexFilename;
+
+  /**The sounding index builder*/
+  SoundingIndexBuilder builder;
+};
+
+#endif
@@ -0,0 +1,71 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef LIVEGRIDDINGGEOREFERENCER_HPP
+#define LIVEGRIDDINGGEOREFERENCER_HPP
+
+#include "StreamingGeoreferencer.hpp"
+#include "../gridding/LiveDtm.hpp"
+#include "../math/CoordinateTransform.hpp"
+
+/*!
+* \brief Live gridding georeferencer class
+*
+* Extends from StreamingGeoreferencer. Adds each swath to a live DTM as soon as it is georeferenced, and
+* publishes a new snapshot of the DTM at the end of every swath.
+* With LGF georeferencing, the grid is in the local NED frame (x north, y east, z down, in meters).
+* With TRF georeferencing, the grid is in longitude and latitude (decimal degrees) against the ellipsoidal height.
+*/
+class LiveGriddingGeoreferencer : public StreamingGeoreferencer{
+public:
+
+  /**
+  * Creates a live gridding georeferencer
+  *
+  * @param geo the georeferencing method
+  * @param svpStrat the svp selection strategy
+  * @param leverArm lever arm
+  * @param boresight boresight (dPhi,dTheta,dPsi)
+  * @param dtm the live DTM receiving the swaths
+  */
+  LiveGriddingGeoreferencer(Georeferencing & geo,SvpSelectionStrategy & svpStrat,Eigen::Vector3d & leverArm,Eigen::Matrix3d & boresight,LiveDtm & dtm) :
+  StreamingGeoreferencer(geo,svpStrat,leverArm,boresight),
+  dtm(dtm),
+  geographic(dynamic_cast<GeoreferencingTRF*>(&geo) != NULL),
+  geographicPosition(0,0,0,0){
+
+  }
+
+  /**Destroys the live gridding georeferencer*/
+  virtual ~LiveGriddingGeoreferencer(){
+
+  }
+
+  virtual void processGeoreferencedPing(Eigen::Vector3d & georeferencedPing,uint32_t quality,int32_t intensity){
+    if(geographic){
+      CoordinateTransform::convertECEFToLongitudeLatitudeElevation(georeferencedPing,geographicPosition);
+      dtm.add(geographicPosition.getLongitude(),geographicPosition.getLatitude(),geographicPosition.getEllipsoidalHeight());
+    }
+    else{
+      dtm.add(georeferencedPing(0),georeferencedPing(1),georeferencedPing(2));
+    }
+  }
+
+  virtual void processGeoreferencedSwathEnd(){
+    dtm.publish();
+  }
+
+private:
+
+  /**The live DTM*/
+  LiveDtm & dtm;
+
+  /**True if the points are converted from ECEF to geographic coordinates*/
+  bool geographic;
+
+  /**Conversion buffer*/
+  Position geographicPosition;
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef MORTONORDERGEOREFERENCER_HPP
+#define MORTONORDERGEOREFERENCER_HPP
+
+#include "DatagramGeoreferencer.hpp"
+#include "../index/MortonSorter.hpp"
+
+/*!
+* \brief Morton order georeferencer class
+*
+* Extends from DatagramGeoreferencer. Hands the georeferenced pings to a Morton sorter, which outputs them in
+* Z-order once all pings are georeferenced instead of in time order.
+*/
+class MortonOrderGeoreferencer : public DatagramGeoreferencer{
+public:
+
+  /**
+  * Creates a Morton order georeferencer
+  *
+  * @param geo the georeferencing method
+  * @param svpStrat the svp selection strategy
+  * @param sorter the Morton sorter receiving the georeferenced pings
+  */
+  MortonOrderGeoreferencer(Georeferencing & geo,SvpSelectionStrategy & svpStrat,MortonSorter & sorter)
+  : DatagramGeoreferencer(geo,svpStrat), sorter(sorter){
+
+  }
+
+  /**Destroys the Morton order georeferencer*/
+  virtual ~MortonOrderGeoreferencer(){
+
+  }
+
+  /**
+  * Georeferences all pings, then outputs them in Morton order
+  *
+  * @param leverArm lever arm
+  * @param boresight boresight (dPhi,dTheta,dPsi)
+  * @param externalSvps svps specified by the user
+  */
+  virtual void georeference(Eigen::Vector3d & leverArm, Eigen::Matrix3d & boresight, std::vector<SoundVelocityProfile*> & externalSvps){
+    DatagramGeoreferencer::georeference(leverArm,boresight,externalSvps);
+    sorter.finish();
+  }
+
+  virtual void processGeoreferencedPing(Eigen::Vector3d & georeferencedPing, uint32_t quality, int32_t intensity, int positionIndex, int attitudeIndex){
+    sorter.add(georeferencedPing(0),georeferencedPing(1),georeferencedPing(2),quality,intensity);
+  }
+
+private:
+
+  /**The Morton sorter*/
+  MortonSorter & sorter;
+};
+
+#endif
@@ -8,6 +8,7 @@
 
 
 #include <cstdint>
+#include <memory>
 
 #include <pcl/common/common_headers.h>
 
@@ -16,13 +17,18 @@
 
 #include "../svp/SvpSelectionStrategy.hpp"
 
+#include "../gridding/VoxelDecimator.hpp"
+
 
 
 /*!
 * \brief PCL point cloud georeferencer class
 * \author Guillaume Labbe-Morissette, Christian Bouchard
 *
-* Extends from DatagramGeoreferencer
+* Extends from DatagramGeoreferencer. Can keep only the first ping of each voxel, so that the size of the
+* point cloud follows the area covered instead of the number of soundings. The voxels are cells of the frame of the
+* georeferencing: horizontal in the local geographic frame, but cubes of the ECEF frame in the terrestrial frame.
+* The pings of the datagrams are still all kept by DatagramGeoreferencer until they are georeferenced.
 */
 
 
@@ -35,15 +41,21 @@ public:
 	*
 	* @param cloud Point cloud
 	* @param georef The georeferencer
+	* @param svpStrat the svp selection strategy
+	* @param decimationCellSize size of the decimation voxels, 0 to keep every ping
 	*/
 	PointCloudGeoreferencer( pcl::PointCloud<pcl::PointXYZ>::Ptr cloud, Georeferencing & georef,
-							SvpSelectionStrategy & svpStrat )
+							SvpSelectionStrategy & svpStrat, double decimationCellSize = 0 )
 	: cloud( cloud ),DatagramGeoreferencer(georef, svpStrat) {
 
+		if ( decimationCellSize > 0 )
+			decimator.reset( new VoxelDecimator( decimationCellSize ) );
 	}
 
 	/** Destroys a PointCloudGeoreferencer  */
-	virtual ~PointCloudGeoreferencer() {}
+	virtual ~PointCloudGeoreferencer() {
+
+	}
 
 	/**
 	* Inserts georeferenced ping's position at the end of a point cloud
@@ -55,6 +67,9 @@ public:
 	virtual void processGeoreferencedPing(Eigen::Vector3d & georeferencedPing, uint32_t quality, 
 											int32_t intensity, int positionIndex, int attitudeIndex){
 
+		if ( decimator && ! decimator->add( georeferencedPing(0), georeferencedPing(1), georeferencedPing(2) ) )
+			return;
+
 		pcl::PointXYZ point;
 
 		point.x = georeferencedPing(0);
@@ -68,6 +83,9 @@ public:
 private:
 	/** Point cloud */
 	pcl::PointCloud<pcl::PointXYZ>::Ptr cloud;
+
+	/** Decimator of the pings, or NULL to keep every ping */
+	std::unique_ptr<VoxelDecimator> decimator;
 };
 
 
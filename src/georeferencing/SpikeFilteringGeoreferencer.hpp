@@ -0,0 +1,67 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef SPIKEFILTERINGGEOREFERENCER_HPP
+#define SPIKEFILTERINGGEOREFERENCER_HPP
+
+#include "DatagramGeoreferencer.hpp"
+#include "../filter/AlongTrackSpikeFilter.hpp"
+
+/*!
+* \brief Spike filtering georeferencer class
+*
+* Extends from DatagramGeoreferencer. Feeds the georeferenced swaths to an along-track spike filter,
+* which receives its decisions with a latency of its ping window.
+*/
+class SpikeFilteringGeoreferencer : public DatagramGeoreferencer{
+public:
+
+  /**
+  * Creates a spike filtering georeferencer
+  *
+  * @param geo the georeferencing method
+  * @param svpStrat the svp selection strategy
+  * @param filter the along-track spike filter receiving the georeferenced swaths
+  */
+  SpikeFilteringGeoreferencer(Georeferencing & geo,SvpSelectionStrategy & svpStrat,AlongTrackSpikeFilter & filter)
+  : DatagramGeoreferencer(geo,svpStrat), filter(filter){
+
+  }
+
+  /**Destroys the spike filtering georeferencer*/
+  virtual ~SpikeFilteringGeoreferencer(){
+
+  }
+
+  /**
+  * Georeferences all pings, then flushes the swaths still buffered in the filter
+  *
+  * @param leverArm lever arm
+  * @param boresight boresight (dPhi,dTheta,dPsi)
+  * @param externalSvps svps specified by the user
+  */
+  virtual void georeference(Eigen::Vector3d & leverArm, Eigen::Matrix3d & boresight, std::vector<SoundVelocityProfile*> & externalSvps){
+    DatagramGeoreferencer::georeference(leverArm,boresight,externalSvps);
+    filter.flush();
+  }
+
+  virtual void processGeoreferencedSwathStart(uint64_t microEpoch){
+    filter.startSwath(microEpoch);
+  }
+
+  virtual void processGeoreferencedPing(Eigen::Vector3d & georeferencedPing, uint32_t quality, int32_t intensity, int positionIndex, int attitudeIndex){
+    filter.addSounding(georeferencedPing(0),georeferencedPing(1),georeferencedPing(2),quality,intensity);
+  }
+
+  virtual void processGeoreferencedSwathEnd(){
+    filter.endSwath();
+  }
+
+private:
+
+  /**The along-track spike filter*/
+  AlongTrackSpikeFilter & filter;
+};
+
+#endif
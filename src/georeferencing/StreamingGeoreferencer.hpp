@@ -0,0 +1,265 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef STREAMINGGEOREFERENCER_HPP
+#define STREAMINGGEOREFERENCER_HPP
+
+#include <deque>
+#include <vector>
+#include "../Ping.hpp"
+#include "../Position.hpp"
+#include "../Attitude.hpp"
+#include "Georeferencing.hpp"
+#include "../svp/SoundVelocityProfileFactory.hpp"
+#include "../svp/SoundVelocityProfile.hpp"
+#include "../svp/SvpSelectionStrategy.hpp"
+#include "../datagrams/DatagramEventHandler.hpp"
+#include "../math/Interpolation.hpp"
+
+/*!
+* \brief Streaming georeferencer class
+*
+* Extends from DatagramEventHandler. Unlike DatagramGeoreferencer, which georeferences a whole file once it has
+* been parsed, a swath is georeferenced as soon as positions and attitudes on both sides of it have been received.
+* The navigation older than the oldest swath waiting for it is dropped, so memory does not grow with the length
+* of the acquisition. Positions and attitudes are expected in chronological order, as they arrive from a live sensor.
+*
+* With LGF georeferencing, the centroid must be set beforehand. If it is not, the first position received is used.
+*/
+class StreamingGeoreferencer : public DatagramEventHandler{
+public:
+
+  /**
+  * Creates a streaming georeferencer
+  *
+  * @param geo the georeferencing method
+  * @param svpStrat the svp selection strategy
+  * @param leverArm lever arm
+  * @param boresight boresight (dPhi,dTheta,dPsi)
+  */
+  StreamingGeoreferencer(Georeferencing & geo,SvpSelectionStrategy & svpStrat,Eigen::Vector3d & leverArm,Eigen::Matrix3d & boresight) :
+  georef(geo),
+  svpStrategy(svpStrat),
+  leverArm(leverArm),
+  boresight(boresight),
+  currentSurfaceSoundSpeed(0),
+  hasSvp(false){
+
+  }
+
+  /**Destroys the streaming georeferencer*/
+  virtual ~StreamingGeoreferencer(){
+
+  }
+
+  /**
+  * Adds an attitude, and georeferences the swaths it completes
+  *
+  * @param microEpoch the attitude timestamp
+  * @param heading the attitude heading
+  * @param pitch the attitude pitch
+  * @param roll the attitude roll
+  */
+  void processAttitude(uint64_t microEpoch,double heading,double pitch,double roll){
+    if(!attitudes.empty() && attitudes.back().getTimestamp() >= microEpoch) return;
+
+    attitudes.push_back(Attitude(microEpoch,roll,pitch,heading));
+    georeferenceSwaths();
+  }
+
+  /**
+  * Adds a position, and georeferences the swaths it completes
+  *
+  * @param microEpoch the position timestamp
+  * @param longitude the position longitude
+  * @param latitude the position latitude
+  * @param height the position ellipsoidal height
+  */
+  void processPosition(uint64_t microEpoch,double longitude,double latitude,double height){
+    if(!positions.empty() && positions.back().getTimestamp() >= microEpoch) return;
+
+    positions.push_back(Position(microEpoch,latitude,longitude,height));
+
+    if(GeoreferencingLGF * lgf = dynamic_cast<GeoreferencingLGF*>(&georef)){
+      if(lgf->getCentroid() == NULL){
+        lgf->setCentroid(positions.back());
+      }
+    }
+
+    georeferenceSwaths();
+  }
+
+  /**
+  * Adds a beam to the current swath. A beam with another timestamp closes the current swath.
+  *
+  * @param microEpoch the ping timestamp
+  * @param id the ping id
+  * @param beamAngle the ping beam angle
+  * @param tiltAngle the ping tilt angle
+  * @param twoWayTravelTime the ping two way travel time
+  * @param quality the ping quality
+  * @param intensity the ping intensity
+  */
+  void processPing(uint64_t microEpoch,long id,double beamAngle,double tiltAngle,double twoWayTravelTime,uint32_t quality,int32_t intensity){
+    if(!currentSwath.empty() && currentSwath.back().getTimestamp() != microEpoch){
+      closeSwath();
+    }
+
+    currentSwath.push_back(Ping(microEpoch,id,quality,intensity,currentSurfaceSoundSpeed,twoWayTravelTime,tiltAngle,beamAngle));
+  }
+
+  /**
+  * Closes the current swath and changes the current surface sound speed
+  *
+  * @param surfaceSoundSpeed the new current surface sound speed
+  */
+  void processSwathStart(double surfaceSoundSpeed){
+    closeSwath();
+    currentSurfaceSoundSpeed = surfaceSoundSpeed;
+  }
+
+  /**
+  * Adds a sound velocity profile to the svp selection strategy
+  *
+  * @param svp the sound velocity profile
+  */
+  void processSoundVelocityProfile(SoundVelocityProfile * svp){
+    svpStrategy.addSvp(svp);
+    hasSvp = true;
+  }
+
+  /**Closes the current swath and georeferences every swath that can be. Call it at the end of the stream.*/
+  virtual void flush(){
+    closeSwath();
+  }
+
+  /**Returns the number of closed swaths waiting for navigation*/
+  unsigned int getNbPendingSwaths() const { return pendingSwaths.size(); }
+
+  /**
+  * Called before the georeferenced beams of a new swath are processed
+  *
+  * @param microEpoch the swath timestamp
+  */
+  virtual void processGeoreferencedSwathStart(uint64_t microEpoch){
+  }
+
+  /**
+  * Called for every georeferenced beam of the current swath
+  *
+  * @param georeferencedPing the georeferenced beam
+  * @param quality the quality of the beam
+  * @param intensity the intensity of the beam
+  */
+  virtual void processGeoreferencedPing(Eigen::Vector3d & georeferencedPing,uint32_t quality,int32_t intensity){
+  }
+
+  /**
+  * Called for every georeferenced beam of the current swath, with the beam it was computed from.
+  * Calls processGeoreferencedPing() unless overridden.
+  *
+  * @param georeferencedPing the georeferenced beam
+  * @param ping the beam in the sonar frame
+  */
+  virtual void processGeoreferencedBeam(Eigen::Vector3d & georeferencedPing,Ping & ping){
+    processGeoreferencedPing(georeferencedPing,ping.getQuality(),ping.getIntensity());
+  }
+
+  /**
+  * Called once all the georeferenced beams of the current swath have been processed
+  */
+  virtual void processGeoreferencedSwathEnd(){
+  }
+
+protected:
+
+  /**Moves the current swath to the swaths waiting for navigation*/
+  void closeSwath(){
+    if(currentSwath.empty()) return;
+
+    pendingSwaths.push_back(std::vector<Ping>());
+    pendingSwaths.back().swap(currentSwath);
+
+    georeferenceSwaths();
+  }
+
+  /**Georeferences the pending swaths, oldest first, until one is not yet surrounded by navigation*/
+  void georeferenceSwaths(){
+    while(!pendingSwaths.empty()){
+      std::vector<Ping> & swath = pendingSwaths.front();
+      uint64_t timestamp = swath[0].getTimestamp();
+
+      //Keep one sample at or before the swath
+      while(positions.size() > 1 && positions[1].getTimestamp() < timestamp) positions.pop_front();
+      while(attitudes.size() > 1 && attitudes[1].getTimestamp() < timestamp) attitudes.pop_front();
+
+      //Wait for a sample at or after the swath
+      if(positions.size() < 2 || attitudes.size() < 2) return;
+      if(positions.back().getTimestamp() < timestamp || attitudes.back().getTimestamp() < timestamp) return;
+
+      //No navigation before the swath, it will never be surrounded
+      if(positions[0].getTimestamp() > timestamp || attitudes[0].getTimestamp() > timestamp){
+        pendingSwaths.pop_front();
+        continue;
+      }
+
+      if(!hasSvp){
+        svpStrategy.addSvp(SoundVelocityProfileFactory::buildFreshWaterModel());
+        hasSvp = true;
+      }
+
+      //All the beams of a swath share the same navigation
+      Attitude * interpolatedAttitude = Interpolator::interpolateAttitude(attitudes[0],attitudes[1],timestamp);
+      Position * interpolatedPosition = Interpolator::interpolatePosition(positions[0],positions[1],timestamp);
+
+      processGeoreferencedSwathStart(timestamp);
+
+      for(auto i=swath.begin();i!=swath.end();i++){
+        Eigen::Vector3d georeferencedPing;
+        georef.georeference(georeferencedPing,*interpolatedAttitude,*interpolatedPosition,*i,*(svpStrategy.chooseSvp(*interpolatedPosition,*i)),leverArm,boresight);
+
+        processGeoreferencedBeam(georeferencedPing,*i);
+      }
+
+      processGeoreferencedSwathEnd();
+
+      delete interpolatedAttitude;
+      delete interpolatedPosition;
+
+      pendingSwaths.pop_front();
+    }
+  }
+
+  /**the georeferencing method*/
+  Georeferencing & georef;
+
+  /**the svp selection strategy*/
+  SvpSelectionStrategy & svpStrategy;
+
+  /**Lever arm*/
+  Eigen::Vector3d leverArm;
+
+  /**Boresight matrix*/
+  Eigen::Matrix3d boresight;
+
+  /**the current surface sound speed*/
+  double currentSurfaceSoundSpeed;
+
+  /**True once the svp selection strategy has a profile*/
+  bool hasSvp;
+
+  /**Beams of the swath being received*/
+  std::vector<Ping> currentSwath;
+
+  /**Swaths received, waiting for navigation*/
+  std::deque<std::vector<Ping> > pendingSwaths;
+
+  /**Positions still needed, in chronological order*/
+  std::deque<Position> positions;
+
+  /**Attitudes still needed, in chronological order*/
+  std::deque<Attitude> attitudes;
+};
+
+#endif
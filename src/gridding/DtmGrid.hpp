@@ -0,0 +1,267 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef DTMGRID_HPP
+#define DTMGRID_HPP
+
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include "../utils/Exception.hpp"
+
+/*!
+* \brief DTM cell class
+*
+* Running statistics of the depths that fell in a grid cell. The mean and variance are updated with
+* Welford's algorithm, and two cells are merged with Chan's parallel formula.
+*/
+class DtmCell{
+public:
+
+  /**Creates an empty cell*/
+  DtmCell() : count(0), mean(0), m2(0), minimum(std::numeric_limits<double>::max()), maximum(-std::numeric_limits<double>::max()){
+
+  }
+
+  /**
+  * Adds a depth to the cell
+  *
+  * @param z the depth
+  */
+  void add(double z){
+    count++;
+
+    double delta = z - mean;
+    mean += delta / count;
+    m2 += delta * (z - mean);
+
+    if(z < minimum) minimum = z;
+    if(z > maximum) maximum = z;
+  }
+
+  /**
+  * Adds the depths of another cell to this cell
+  *
+  * @param other the other cell
+  */
+  void merge(const DtmCell & other){
+    if(other.count == 0) return;
+
+    if(count == 0){
+      *this = other;
+      return;
+    }
+
+    uint64_t total = count + other.count;
+    double delta = other.mean - mean;
+
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * ((double)count * other.count / total);
+    count = total;
+
+    minimum = std::min(minimum,other.minimum);
+    maximum = std::max(maximum,other.maximum);
+  }
+
+  /**Returns the number of depths in the cell*/
+  uint64_t getCount() const { return count; }
+
+  /**Returns the mean depth*/
+  double getMean() const { return mean; }
+
+  /**Returns the smallest depth*/
+  double getMinimum() const { return minimum; }
+
+  /**Returns the largest depth*/
+  double getMaximum() const { return maximum; }
+
+  /**Returns the population variance of the depths*/
+  double getVariance() const { return (count > 0) ? m2 / count : 0; }
+
+private:
+
+  /**Number of depths*/
+  uint64_t count;
+
+  /**Mean depth*/
+  double mean;
+
+  /**Sum of the squared differences from the mean*/
+  double m2;
+
+  /**Smallest depth*/
+  double minimum;
+
+  /**Largest depth*/
+  double maximum;
+};
+
+/*!
+* \brief DTM grid class
+*
+* Sparse grid of DtmCell of a given resolution. Cell (column,row) covers [column*resolution,(column+1)*resolution[
+* along x and the same along y, so a grid of any extent can be built without knowing its bounds beforehand.
+*/
+class DtmGrid{
+public:
+
+  /**
+  * Creates a grid
+  *
+  * @param resolution the size of a cell, in the units of the gridded coordinates
+  */
+  DtmGrid(double resolution) : resolution(resolution){
+
+  }
+
+  /**Destroys the grid*/
+  ~DtmGrid(){
+
+  }
+
+  /**
+  * Adds a point to the cell it falls in
+  *
+  * @param x x position of the point
+  * @param y y position of the point
+  * @param z depth of the point
+  */
+  void add(double x,double y,double z){
+    cells[cellKey(getColumn(x),getRow(y))].add(z);
+  }
+
+  /**
+  * Adds the cells of another grid of the same resolution to this grid
+  *
+  * @param other the other grid
+  */
+  void merge(const DtmGrid & other){
+    for(auto i=other.cells.begin();i!=other.cells.end();i++){
+      cells[i->first].merge(i->second);
+    }
+  }
+
+  /**Removes all the cells*/
+  void clear(){
+    cells.clear();
+  }
+
+  /**
+  * Returns the cell at a position, or NULL if no point fell in it
+  *
+  * @param x x position
+  * @param y y position
+  */
+  const DtmCell * getCell(double x,double y) const {
+    auto i = cells.find(cellKey(getColumn(x),getRow(y)));
+    return (i != cells.end()) ? &i->second : NULL;
+  }
+
+  /**Returns the number of cells holding at least one point*/
+  size_t getNbCells() const { return cells.size(); }
+
+  /**Returns the size of a cell*/
+  double getResolution() const { return resolution; }
+
+  /**Returns the cells, by cell key*/
+  const std::unordered_map<uint64_t,DtmCell> & getCells() const { return cells; }
+
+  /**
+  * Returns the column of the cells containing an x position
+  *
+  * @param x x position
+  */
+  int32_t getColumn(double x) const { return cellIndex(x,resolution); }
+
+  /**
+  * Returns the row of the cells containing a y position
+  *
+  * @param y y position
+  */
+  int32_t getRow(double y) const { return cellIndex(y,resolution); }
+
+  /**
+  * Returns the index of the cells containing a position along an axis. Throws if the index does not fit 32 bits,
+  * which happens when the resolution is too fine for the extent of the coordinates.
+  *
+  * @param position the position
+  * @param resolution the size of a cell
+  */
+  static int32_t cellIndex(double position,double resolution){
+    double index = std::floor(position / resolution);
+
+    if(!(index >= (double)std::numeric_limits<int32_t>::min() && index <= (double)std::numeric_limits<int32_t>::max())){
+      throw new Exception("Position out of the range of the grid, the resolution is too fine");
+    }
+
+    return (int32_t)index;
+  }
+
+  /**
+  * Returns the key of a cell
+  *
+  * @param column column of the cell
+  * @param row row of the cell
+  */
+  static uint64_t cellKey(int32_t column,int32_t row){
+    return ((uint64_t)(uint32_t)column << 32) | (uint64_t)(uint32_t)row;
+  }
+
+  /**
+  * Returns the column of a cell key
+  *
+  * @param key the cell key
+  */
+  static int32_t keyColumn(uint64_t key){ return (int32_t)(uint32_t)(key >> 32); }
+
+  /**
+  * Returns the row of a cell key
+  *
+  * @param key the cell key
+  */
+  static int32_t keyRow(uint64_t key){ return (int32_t)(uint32_t)(key & 0xFFFFFFFF); }
+
+  /**
+  * Writes one line per cell, "x y count mean minimum maximum variance", x and y being the center of the cell.
+  * Cells are written row by row.
+  *
+  * @param out the stream to write to
+  */
+  void write(std::ostream & out) const {
+    std::vector<uint64_t> keys;
+    keys.reserve(cells.size());
+
+    for(auto i=cells.begin();i!=cells.end();i++){
+      keys.push_back(i->first);
+    }
+
+    std::sort(keys.begin(),keys.end(),&DtmGrid::sortByRow);
+
+    for(auto i=keys.begin();i!=keys.end();i++){
+      const DtmCell & cell = cells.find(*i)->second;
+
+      out << (keyColumn(*i) + 0.5) * resolution << " " << (keyRow(*i) + 0.5) * resolution << " "
+          << cell.getCount() << " " << cell.getMean() << " " << cell.getMinimum() << " " << cell.getMaximum() << " " << cell.getVariance() << std::endl;
+    }
+  }
+
+private:
+
+  /**Orders cell keys by row, then by column*/
+  static bool sortByRow(uint64_t k1,uint64_t k2){
+    return keyRow(k1) < keyRow(k2) || (keyRow(k1) == keyRow(k2) && keyColumn(k1) < keyColumn(k2));
+  }
+
+  /**Size of a cell*/
+  double resolution;
+
+  /**Cells holding at least one point, by cell key*/
+  std::unordered_map<uint64_t,DtmCell> cells;
+};
+
+#endif
@@ -0,0 +1,248 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef LIVEDTM_HPP
+#define LIVEDTM_HPP
+
+#include <map>
+#include <set>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <cstdint>
+#include "DtmGrid.hpp"
+#include "TiledDtm.hpp"
+
+/*!
+* \brief Live DTM tile class
+*
+* A tile of a LiveDtm, with the version of the DTM in which it was last modified
+*/
+class LiveDtmTile{
+public:
+
+  /**
+  * Creates a live DTM tile
+  *
+  * @param tile the cells of the tile
+  * @param version the version of the DTM in which the tile was last modified
+  */
+  LiveDtmTile(std::shared_ptr<DtmTile> tile,uint64_t version) : tile(tile), version(version){
+
+  }
+
+  /**The cells of the tile, shared between the snapshots in which the tile did not change*/
+  std::shared_ptr<DtmTile> tile;
+
+  /**The version of the DTM in which the tile was last modified*/
+  uint64_t version;
+};
+
+/*!
+* \brief Live DTM snapshot class
+*
+* Immutable view of a LiveDtm at a given version. A reader can keep it as long as it wants, the writer never modifies it.
+*/
+class LiveDtmSnapshot{
+public:
+
+  /**
+  * Creates a snapshot
+  *
+  * @param tiles the tiles of the DTM
+  * @param version the version of the DTM
+  * @param resolution the size of a cell
+  * @param tileSize number of cells on a side of a tile
+  */
+  LiveDtmSnapshot(const std::map<DtmTileKey,LiveDtmTile> & tiles,uint64_t version,double resolution,unsigned int tileSize) :
+  tiles(tiles), version(version), resolution(resolution), tileSize(tileSize){
+
+  }
+
+  /**Returns the version of the DTM in this snapshot*/
+  uint64_t getVersion() const { return version; }
+
+  /**Returns the size of a cell*/
+  double getResolution() const { return resolution; }
+
+  /**Returns the number of cells on a side of a tile*/
+  unsigned int getTileSize() const { return tileSize; }
+
+  /**Returns the tiles*/
+  const std::map<DtmTileKey,LiveDtmTile> & getTiles() const { return tiles; }
+
+  /**
+  * Returns the tiles modified after a version, to redraw only what changed since an older snapshot
+  *
+  * @param previousVersion the version of the older snapshot
+  */
+  std::vector<DtmTileKey> getTilesModifiedSince(uint64_t previousVersion) const {
+    std::vector<DtmTileKey> modified;
+
+    for(auto i=tiles.begin();i!=tiles.end();i++){
+      if(i->second.version > previousVersion){
+        modified.push_back(i->first);
+      }
+    }
+
+    return modified;
+  }
+
+  /**
+  * Returns the statistics of the cell at a position, empty if no point fell in it
+  *
+  * @param x x position
+  * @param y y position
+  */
+  DtmCell getCell(double x,double y) const {
+    int32_t column = DtmGrid::cellIndex(x,resolution);
+    int32_t row    = DtmGrid::cellIndex(y,resolution);
+
+    DtmTileKey key(0,floorDivide(column,tileSize),floorDivide(row,tileSize));
+
+    auto i = tiles.find(key);
+
+    if(i == tiles.end()) return DtmCell();
+
+    return i->second.tile->getCell(column - key.column * (int32_t)tileSize,row - key.row * (int32_t)tileSize);
+  }
+
+  /**
+  * Returns a / b rounded down
+  *
+  * @param a the dividend
+  * @param b the positive divisor
+  */
+  static int32_t floorDivide(int32_t a,int32_t b){
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+  }
+
+private:
+
+  /**The tiles*/
+  std::map<DtmTileKey,LiveDtmTile> tiles;
+
+  /**The version of the DTM*/
+  uint64_t version;
+
+  /**Size of a cell*/
+  double resolution;
+
+  /**Number of cells on a side of a tile*/
+  unsigned int tileSize;
+};
+
+/*!
+* \brief Live DTM class
+*
+* Grid updated incrementally by a single writer, such as one swath at a time during acquisition, and read
+* by any number of readers through snapshots. Tiles are copied on write: publishing a snapshot only copies
+* pointers to the tiles, and the writer duplicates a tile the first time it modifies it after it was published.
+* A reader taking a snapshot never waits for the writer to finish a swath.
+*/
+class LiveDtm{
+public:
+
+  /**
+  * Creates a live DTM
+  *
+  * @param resolution the size of a cell
+  * @param tileSize number of cells on a side of a tile
+  */
+  LiveDtm(double resolution,unsigned int tileSize = 128) : resolution(resolution), tileSize(tileSize), version(0){
+    std::shared_ptr<const LiveDtmSnapshot> empty(new LiveDtmSnapshot(tiles,version,resolution,tileSize));
+    std::atomic_store(&snapshot,empty);
+  }
+
+  /**Destroys the live DTM*/
+  ~LiveDtm(){
+
+  }
+
+  /**
+  * Adds a point to the cell it falls in. Readers see it once publish() is called. Writer only.
+  *
+  * @param x x position of the point
+  * @param y y position of the point
+  * @param z depth of the point
+  */
+  void add(double x,double y,double z){
+    int32_t column = DtmGrid::cellIndex(x,resolution);
+    int32_t row    = DtmGrid::cellIndex(y,resolution);
+
+    DtmTileKey key(0,LiveDtmSnapshot::floorDivide(column,tileSize),LiveDtmSnapshot::floorDivide(row,tileSize));
+
+    getTileToModify(key).getCell(column - key.column * (int32_t)tileSize,row - key.row * (int32_t)tileSize).add(z);
+  }
+
+  /**Makes the points added since the last call visible to the readers, as a new version. Writer only.*/
+  void publish(){
+    if(dirtyTiles.empty()) return;
+
+    version++;
+
+    for(auto i=dirtyTiles.begin();i!=dirtyTiles.end();i++){
+      tiles.find(*i)->second.version = version;
+    }
+
+    dirtyTiles.clear();
+
+    std::shared_ptr<const LiveDtmSnapshot> published(new LiveDtmSnapshot(tiles,version,resolution,tileSize));
+    std::atomic_store(&snapshot,published);
+  }
+
+  /**Returns the tiles modified since the last call to publish(). Writer only.*/
+  const std::set<DtmTileKey> & getDirtyTiles() const { return dirtyTiles; }
+
+  /**Returns the latest published snapshot. Any thread.*/
+  std::shared_ptr<const LiveDtmSnapshot> getSnapshot() const {
+    return std::atomic_load(&snapshot);
+  }
+
+  /**Returns the size of a cell*/
+  double getResolution() const { return resolution; }
+
+private:
+
+  /**
+  * Returns a tile that is not shared with any snapshot, creating or copying it if needed
+  *
+  * @param key the key of the tile
+  */
+  DtmTile & getTileToModify(const DtmTileKey & key){
+    auto i = tiles.find(key);
+
+    if(i == tiles.end()){
+      i = tiles.insert(std::make_pair(key,LiveDtmTile(std::shared_ptr<DtmTile>(new DtmTile(tileSize)),version))).first;
+    }
+    else if(dirtyTiles.count(key) == 0 && i->second.tile.use_count() > 1){
+      //First change since the tile was published: leave the published cells alone
+      i->second.tile = std::shared_ptr<DtmTile>(new DtmTile(*i->second.tile));
+    }
+
+    dirtyTiles.insert(key);
+
+    return *i->second.tile;
+  }
+
+  /**Size of a cell*/
+  double resolution;
+
+  /**Number of cells on a side of a tile*/
+  unsigned int tileSize;
+
+  /**Version of the latest snapshot*/
+  uint64_t version;
+
+  /**Tiles of the writer*/
+  std::map<DtmTileKey,LiveDtmTile> tiles;
+
+  /**Tiles modified since the latest snapshot*/
+  std::set<DtmTileKey> dirtyTiles;
+
+  /**Latest snapshot, swapped atomically*/
+  std::shared_ptr<const LiveDtmSnapshot> snapshot;
+};
+
+#endif
@@ -0,0 +1,176 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef OVERLAPDIFFERENCE_HPP
+#define OVERLAPDIFFERENCE_HPP
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+#include "DtmGrid.hpp"
+#include "../utils/ThreadUtils.hpp"
+#include "../utils/Exception.hpp"
+
+/*!
+* \brief Overlap difference class
+*
+* Compares the surfaces of two overlapping lines gridded on the same lattice. The mean depths of the cells covered
+* by both lines are differenced cell by cell, in parallel, and the statistics of the differences measure how
+* well the lines agree, without matching the soundings of one line to the nearest soundings of the other.
+*/
+class OverlapDifference{
+public:
+
+  /**
+  * Creates an overlap difference
+  *
+  * @param minCount number of soundings a cell needs in each line to be compared
+  * @param nbThreads number of threads, 0 to use all the hardware threads
+  */
+  OverlapDifference(uint64_t minCount = 1,unsigned int nbThreads = 0) :
+  minCount(std::max(minCount,(uint64_t)1)),
+  nbThreads(ThreadUtils::getNbThreads(nbThreads)),
+  sum(0),
+  sumOfSquares(0){
+
+  }
+
+  /**Destroys the overlap difference*/
+  ~OverlapDifference(){
+
+  }
+
+  /**
+  * Differences two surfaces, as the mean depth of the second line minus the mean depth of the first one
+  *
+  * @param line1 the grid of the first line
+  * @param line2 the grid of the second line, with the same resolution as the first one
+  */
+  void compute(const DtmGrid & line1,const DtmGrid & line2){
+    if(line1.getResolution() != line2.getResolution()){
+      throw new Exception("Grids with different resolutions cannot be differenced");
+    }
+
+    differences.clear();
+    sum = 0;
+    sumOfSquares = 0;
+
+    //Iterate over the smaller grid and look up the larger one, which is only read
+    bool swapped = line2.getNbCells() < line1.getNbCells();
+    const DtmGrid & iterated = swapped ? line2 : line1;
+    const DtmGrid & searched = swapped ? line1 : line2;
+
+    std::vector<const std::pair<const uint64_t,DtmCell> *> cells;
+    cells.reserve(iterated.getNbCells());
+
+    for(auto i=iterated.getCells().begin();i!=iterated.getCells().end();i++){
+      cells.push_back(&(*i));
+    }
+
+    unsigned int threads = (cells.size() < 16384) ? 1 : nbThreads;
+
+    std::vector<std::vector<double> > found(threads);
+
+    ThreadUtils::runChunks(threads,cells.size(),[&](unsigned int thread,size_t begin,size_t end){
+      for(size_t i=begin;i<end;i++){
+        if(cells[i]->second.getCount() < minCount) continue;
+
+        auto other = searched.getCells().find(cells[i]->first);
+
+        if(other == searched.getCells().end() || other->second.getCount() < minCount) continue;
+
+        double difference = other->second.getMean() - cells[i]->second.getMean();
+        found[thread].push_back(swapped ? -difference : difference);
+      }
+    });
+
+    for(auto i=found.begin();i!=found.end();i++){
+      differences.insert(differences.end(),i->begin(),i->end());
+    }
+
+    std::sort(differences.begin(),differences.end());
+
+    for(auto i=differences.begin();i!=differences.end();i++){
+      sum += *i;
+      sumOfSquares += *i * *i;
+    }
+  }
+
+  /**Returns the number of cells compared*/
+  uint64_t getNbCells() const { return differences.size(); }
+
+  /**Returns the mean of the differences*/
+  double getMean() const { return differences.empty() ? 0 : sum / differences.size(); }
+
+  /**Returns the standard deviation of the differences*/
+  double getStandardDeviation() const {
+    if(differences.empty()) return 0;
+
+    double mean = getMean();
+    return std::sqrt(std::max(sumOfSquares / differences.size() - mean * mean,0.0));
+  }
+
+  /**Returns the smallest difference*/
+  double getMinimum() const { return differences.empty() ? 0 : differences.front(); }
+
+  /**Returns the largest difference*/
+  double getMaximum() const { return differences.empty() ? 0 : differences.back(); }
+
+  /**
+  * Returns a percentile of the differences, interpolated between the closest ranks
+  *
+  * @param percent the percentile, from 0 to 100
+  */
+  double getPercentile(double percent) const {
+    if(differences.empty()) return 0;
+
+    double rank = std::min(std::max(percent,0.0),100.0) / 100 * (differences.size() - 1);
+    size_t below = (size_t)std::floor(rank);
+    size_t above = std::min(below + 1,differences.size() - 1);
+
+    return differences[below] + (rank - below) * (differences[above] - differences[below]);
+  }
+
+  /**Returns the differences, sorted*/
+  const std::vector<double> & getDifferences() const { return differences; }
+
+  /**
+  * Writes the statistics of the differences
+  *
+  * @param out the stream to write to
+  */
+  void write(std::ostream & out) const {
+    out << "Cells compared: " << getNbCells() << "\n"
+        << "Mean difference: " << getMean() << "\n"
+        << "Standard deviation: " << getStandardDeviation() << "\n"
+        << "Minimum: " << getMinimum() << "\n"
+        << "5th percentile: " << getPercentile(5) << "\n"
+        << "25th percentile: " << getPercentile(25) << "\n"
+        << "Median: " << getPercentile(50) << "\n"
+        << "75th percentile: " << getPercentile(75) << "\n"
+        << "95th percentile: " << getPercentile(95) << "\n"
+        << "Maximum: " << getMaximum() << std::endl;
+  }
+
+private:
+
+  /**Number of soundings a cell needs in each line to be compared*/
+  uint64_t minCount;
+
+  /**Number of threads*/
+  unsigned int nbThreads;
+
+  /**Differences of the cells compared, sorted*/
+  std::vector<double> differences;
+
+  /**Sum of the differences*/
+  double sum;
+
+  /**Sum of the squared differences*/
+  double sumOfSquares;
+};
+
+#endif
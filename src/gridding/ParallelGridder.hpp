@@ -0,0 +1,276 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef PARALLELGRIDDER_HPP
+#define PARALLELGRIDDER_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <Eigen/Dense>
+#include "DtmGrid.hpp"
+#include "TiledDtm.hpp"
+#include "../Position.hpp"
+#include "../math/CoordinateTransform.hpp"
+
+/*!
+* \brief Parallel gridder class
+*
+* Grids a stream of points with worker threads. The points are added in batches to a bounded queue, so the
+* producer never holds more than a few batches in memory. Each worker accumulates its batches in its own
+* DtmGrid shard without any locking, and the shards are merged into the output grid once the stream ends.
+* When gridding into a TiledDtm, a shard that grows too large is spilled into the tiles and emptied, so that
+* the memory used does not depend on the extent of the survey.
+*/
+class ParallelGridder{
+public:
+
+  /**
+  * Creates a parallel gridder and starts its workers
+  *
+  * @param resolution the size of a cell of the grid shards
+  * @param nbThreads number of worker threads, 0 to use all the hardware threads
+  * @param geographic true if the points are ECEF coordinates to grid in longitude and latitude (decimal degrees)
+  * against their ellipsoidal height, false to grid them as they are
+  */
+  ParallelGridder(double resolution,unsigned int nbThreads = 0,bool geographic = false) : geographic(geographic), finished(false), tiles(NULL), maxShardCells(0), error(NULL){
+    start(resolution,nbThreads);
+  }
+
+  /**
+  * Creates a parallel gridder spilling into a tiled DTM and starts its workers
+  *
+  * @param tiles the tiled DTM receiving the cells
+  * @param nbThreads number of worker threads, 0 to use all the hardware threads
+  * @param geographic true if the points are ECEF coordinates to grid in longitude and latitude (decimal degrees)
+  * against their ellipsoidal height, false to grid them as they are
+  * @param maxShardCells number of cells above which a worker spills its shard into the tiles
+  */
+  ParallelGridder(TiledDtm & tiles,unsigned int nbThreads = 0,bool geographic = false,size_t maxShardCells = 1000000) :
+  geographic(geographic), finished(false), tiles(&tiles), maxShardCells(maxShardCells), error(NULL){
+    start(tiles.getResolution(0),nbThreads);
+  }
+
+  /**Stops the workers and destroys the parallel gridder*/
+  ~ParallelGridder(){
+    stop();
+
+    for(auto i=shards.begin();i!=shards.end();i++){
+      delete *i;
+    }
+
+    if(error) delete error;
+  }
+
+  /**
+  * Adds a point to the stream
+  *
+  * @param x x position of the point
+  * @param y y position of the point
+  * @param z z position of the point
+  */
+  void add(double x,double y,double z){
+    batch.push_back(Eigen::Vector3d(x,y,z));
+
+    if(batch.size() >= BATCH_SIZE){
+      enqueue();
+    }
+  }
+
+  /**
+  * Ends the stream, waits for the workers and merges their shards into a grid
+  *
+  * @param grid the grid receiving the cells, of the same resolution as the gridder
+  */
+  void finish(DtmGrid & grid){
+    stop();
+    throwError();
+
+    for(auto i=shards.begin();i!=shards.end();i++){
+      grid.merge(**i);
+    }
+  }
+
+  /**
+  * Ends the stream, waits for the workers and spills their shards into the tiled DTM given at creation
+  */
+  void finish(){
+    stop();
+    throwError();
+
+    for(auto i=shards.begin();i!=shards.end();i++){
+      tiles->merge(**i);
+      (*i)->clear();
+    }
+  }
+
+private:
+
+  /**Number of points in a batch*/
+  static const size_t BATCH_SIZE = 4096;
+
+  /**Number of batches per worker allowed in the queue before the producer waits*/
+  static const size_t QUEUED_BATCHES_PER_WORKER = 4;
+
+  /**
+  * Creates the shards and starts the workers
+  *
+  * @param resolution the size of a cell of the grid shards
+  * @param nbThreads number of worker threads, 0 to use all the hardware threads
+  */
+  void start(double resolution,unsigned int nbThreads){
+    unsigned int threads = (nbThreads > 0) ? nbThreads : std::thread::hardware_concurrency();
+    threads = std::max(1u,threads);
+
+    batch.reserve(BATCH_SIZE);
+
+    for(unsigned int i=0;i<threads;i++){
+      shards.push_back(new DtmGrid(resolution));
+    }
+
+    for(unsigned int i=0;i<threads;i++){
+      workers.push_back(std::thread(&ParallelGridder::work,this,shards[i]));
+    }
+  }
+
+  /**Hands the current batch to the workers*/
+  void enqueue(){
+    if(batch.empty()) return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    notFull.wait(lock,[this]{ return queue.size() < QUEUED_BATCHES_PER_WORKER * workers.size(); });
+
+    queue.push_back(std::vector<Eigen::Vector3d>());
+    queue.back().swap(batch);
+
+    lock.unlock();
+    notEmpty.notify_one();
+
+    batch.reserve(BATCH_SIZE);
+  }
+
+  /**Hands the last batch to the workers and waits for them to end*/
+  void stop(){
+    if(finished) return;
+
+    enqueue();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished = true;
+    }
+
+    notEmpty.notify_all();
+
+    for(auto i=workers.begin();i!=workers.end();i++){
+      i->join();
+    }
+  }
+
+  /**Throws the first exception raised by a worker, if any*/
+  void throwError(){
+    if(error){
+      Exception * e = error;
+      error = NULL;
+      throw e;
+    }
+  }
+
+  /**
+  * Grids the batches taken from the queue until the stream ends
+  *
+  * @param shard the grid of this worker
+  */
+  void work(DtmGrid * shard){
+    std::vector<Eigen::Vector3d> points;
+    Position geographicPosition(0,0,0,0);
+
+    while(true){
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        notEmpty.wait(lock,[this]{ return !queue.empty() || finished; });
+
+        if(queue.empty()) return;
+
+        points.swap(queue.front());
+        queue.pop_front();
+      }
+
+      notFull.notify_one();
+
+      //An exception cannot leave a worker: the first one is kept for finish() and the stream is drained
+      try{
+        for(auto i=points.begin();i!=points.end();i++){
+          if(geographic){
+            CoordinateTransform::convertECEFToLongitudeLatitudeElevation(*i,geographicPosition);
+            shard->add(geographicPosition.getLongitude(),geographicPosition.getLatitude(),geographicPosition.getEllipsoidalHeight());
+          }
+          else{
+            shard->add((*i)(0),(*i)(1),(*i)(2));
+          }
+        }
+
+        if(tiles && shard->getNbCells() > maxShardCells){
+          std::lock_guard<std::mutex> lock(tilesMutex);
+          tiles->merge(*shard);
+          shard->clear();
+        }
+      }
+      catch(Exception * e){
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if(error) delete e;
+        else error = e;
+      }
+
+      points.clear();
+    }
+  }
+
+  /**True if the points are converted from ECEF to geographic coordinates*/
+  bool geographic;
+
+  /**True once the stream has ended*/
+  bool finished;
+
+  /**Batch being filled by the producer*/
+  std::vector<Eigen::Vector3d> batch;
+
+  /**Batches waiting for a worker*/
+  std::deque<std::vector<Eigen::Vector3d> > queue;
+
+  /**Guards the queue and the end of stream*/
+  std::mutex mutex;
+
+  /**Signals the workers that a batch is queued*/
+  std::condition_variable notEmpty;
+
+  /**Signals the producer that the queue has room*/
+  std::condition_variable notFull;
+
+  /**Tiled DTM receiving the spilled shards, or NULL*/
+  TiledDtm * tiles;
+
+  /**Number of cells above which a shard is spilled*/
+  size_t maxShardCells;
+
+  /**First exception raised by a worker, NULL if none*/
+  Exception * error;
+
+  /**Guards the tiled DTM*/
+  std::mutex tilesMutex;
+
+  /**Worker threads*/
+  std::vector<std::thread> workers;
+
+  /**Grid of each worker*/
+  std::vector<DtmGrid*> shards;
+};
+
+#endif
@@ -0,0 +1,468 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef TILEDDTM_HPP
+#define TILEDDTM_HPP
+
+#include <vector>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include "DtmGrid.hpp"
+#include "../utils/Exception.hpp"
+
+/*!
+* \brief DTM tile key class
+*
+* Identifies a tile by its level in the pyramid (0 being the finest) and its column and row at that level
+*/
+class DtmTileKey{
+public:
+
+  /**
+  * Creates a tile key
+  *
+  * @param level level of the tile, 0 being the finest
+  * @param column column of the tile
+  * @param row row of the tile
+  */
+  DtmTileKey(unsigned int level,int32_t column,int32_t row) : level(level), column(column), row(row){
+
+  }
+
+  /**Orders the tiles by level, then row by row*/
+  bool operator<(const DtmTileKey & other) const {
+    if(level != other.level) return level < other.level;
+    if(row != other.row) return row < other.row;
+    return column < other.column;
+  }
+
+  /**Level of the tile*/
+  unsigned int level;
+
+  /**Column of the tile*/
+  int32_t column;
+
+  /**Row of the tile*/
+  int32_t row;
+};
+
+/*!
+* \brief DTM tile class
+*
+* Dense square block of cells of one level of a TiledDtm
+*/
+class DtmTile{
+public:
+
+  /**
+  * Creates an empty tile
+  *
+  * @param tileSize number of cells on a side of the tile
+  */
+  DtmTile(unsigned int tileSize) : tileSize(tileSize), cells(tileSize * tileSize){
+
+  }
+
+  /**
+  * Returns a cell of the tile
+  *
+  * @param column column of the cell in the tile
+  * @param row row of the cell in the tile
+  */
+  DtmCell & getCell(unsigned int column,unsigned int row){ return cells[row * tileSize + column]; }
+
+  /**Returns the number of cells on a side of the tile*/
+  unsigned int getTileSize() const { return tileSize; }
+
+  /**
+  * Writes the cells to a file
+  *
+  * @param filename the file to write
+  */
+  void write(const std::string & filename) const {
+    std::ofstream out(filename.c_str(),std::ios::binary | std::ios::trunc);
+
+    if(!out){
+      throw new Exception("Cannot write DTM tile");
+    }
+
+    out.write((const char*)&cells[0],cells.size() * sizeof(DtmCell));
+  }
+
+  /**
+  * Reads the cells from a file written by write()
+  *
+  * @param filename the file to read
+  */
+  void read(const std::string & filename){
+    std::ifstream in(filename.c_str(),std::ios::binary);
+
+    if(!in || !in.read((char*)&cells[0],cells.size() * sizeof(DtmCell))){
+      throw new Exception("Cannot read DTM tile");
+    }
+  }
+
+private:
+
+  /**Number of cells on a side of the tile*/
+  unsigned int tileSize;
+
+  /**Cells, row by row*/
+  std::vector<DtmCell> cells;
+};
+
+/*!
+* \brief Tiled DTM class
+*
+* Quadtree pyramid of DtmTile. Level 0 holds the cells at the grid resolution, and each level above it halves
+* the resolution, a cell merging the statistics of the four cells below it. Tiles are allocated the first time a
+* point falls in them. At most a fixed number of tiles stay in memory: the least recently used tile is written to
+* the tile directory when another one is needed, and read back when it is used again. The modified tiles still in
+* memory are written by flush(), or when the DTM is destroyed.
+*/
+class TiledDtm{
+public:
+
+  /**
+  * Creates a tiled DTM
+  *
+  * @param resolution the size of a cell at level 0
+  * @param directory existing directory where the tiles are written
+  * @param tileSize number of cells on a side of a tile, rounded down to an even number
+  * @param maxTilesInMemory largest number of tiles kept in memory
+  */
+  TiledDtm(double resolution,const std::string & directory,unsigned int tileSize = 256,unsigned int maxTilesInMemory = 64) :
+  resolution(resolution),
+  directory(directory),
+  tileSize(std::max(tileSize & ~1u,2u)),
+  maxTilesInMemory(std::max(maxTilesInMemory,2u)),
+  nbLevels(1){
+
+  }
+
+  /**Destroys the tiled DTM, writing the modified tiles in memory if flush() was not called*/
+  ~TiledDtm(){
+    try{
+      flush();
+    }
+    catch(Exception * e){
+      delete e;
+    }
+
+    for(auto i=residentTiles.begin();i!=residentTiles.end();i++){
+      delete i->second.tile;
+    }
+  }
+
+  /**
+  * Adds a point to the level 0 cell it falls in
+  *
+  * @param x x position of the point
+  * @param y y position of the point
+  * @param z depth of the point
+  */
+  void add(double x,double y,double z){
+    int32_t column = DtmGrid::cellIndex(x,resolution);
+    int32_t row    = DtmGrid::cellIndex(y,resolution);
+
+    cellToUpdate(0,column,row).add(z);
+  }
+
+  /**
+  * Adds the cells of a grid of the same resolution to level 0
+  *
+  * @param grid the grid
+  */
+  void merge(const DtmGrid & grid){
+    //Visit the cells tile by tile so that each tile is fetched once
+    std::vector<uint64_t> keys;
+    keys.reserve(grid.getNbCells());
+
+    for(auto i=grid.getCells().begin();i!=grid.getCells().end();i++){
+      keys.push_back(i->first);
+    }
+
+    std::sort(keys.begin(),keys.end(),TileOrder(tileSize));
+
+    for(auto i=keys.begin();i!=keys.end();i++){
+      cellToUpdate(0,DtmGrid::keyColumn(*i),DtmGrid::keyRow(*i)).merge(grid.getCells().find(*i)->second);
+    }
+  }
+
+  /**
+  * Builds the levels above level 0 from the level below them. Call it once, after all the points were added.
+  *
+  * @param levels the number of levels of the pyramid, including level 0
+  */
+  void buildPyramid(unsigned int levels){
+    unsigned int half = tileSize / 2;
+
+    for(unsigned int level=1;level<levels;level++){
+      std::vector<DtmTileKey> fineTiles = getTiles(level - 1);
+
+      for(auto i=fineTiles.begin();i!=fineTiles.end();i++){
+        DtmTileKey coarseKey(level,floorDivide(i->column,2),floorDivide(i->row,2));
+
+        //Fetch the fine tile last so that it is the most recently used, and cannot be evicted before the coarse one
+        DtmTile & coarse = getTile(coarseKey);
+        DtmTile & fine   = getTile(*i);
+
+        unsigned int columnOffset = (i->column - coarseKey.column * 2) * half;
+        unsigned int rowOffset    = (i->row - coarseKey.row * 2) * half;
+
+        for(unsigned int row=0;row<tileSize;row++){
+          for(unsigned int column=0;column<tileSize;column++){
+            DtmCell & cell = fine.getCell(column,row);
+
+            if(cell.getCount() > 0){
+              coarse.getCell(columnOffset + column / 2,rowOffset + row / 2).merge(cell);
+            }
+          }
+        }
+
+        residentTiles[coarseKey].dirty = true;
+      }
+    }
+
+    nbLevels = std::max(nbLevels,levels);
+  }
+
+  /**Writes the modified tiles in memory to the tile directory*/
+  void flush(){
+    for(auto i=residentTiles.begin();i!=residentTiles.end();i++){
+      if(i->second.dirty){
+        i->second.tile->write(getTileFilename(i->first));
+        i->second.dirty = false;
+      }
+    }
+  }
+
+  /**
+  * Returns the statistics of the cell at a position, empty if no point fell in it. Throws if the position is beyond
+  * the cell indices of the level.
+  *
+  * @param level the level of the cell
+  * @param x x position
+  * @param y y position
+  */
+  DtmCell getCell(unsigned int level,double x,double y){
+    double levelResolution = getResolution(level);
+    DtmTileKey key(level,0,0);
+    unsigned int column,row;
+
+    locate(level,DtmGrid::cellIndex(x,levelResolution),DtmGrid::cellIndex(y,levelResolution),key,column,row);
+
+    if(existingTiles.count(key) == 0) return DtmCell();
+
+    return getTile(key).getCell(column,row);
+  }
+
+  /**
+  * Returns a tile, reading it back from the tile directory if needed. The reference stays valid until
+  * another tile is fetched.
+  *
+  * @param key the key of the tile
+  */
+  DtmTile & getTile(const DtmTileKey & key){
+    auto resident = residentTiles.find(key);
+
+    if(resident != residentTiles.end()){
+      recentlyUsed.splice(recentlyUsed.begin(),recentlyUsed,resident->second.use);
+      return *resident->second.tile;
+    }
+
+    if(residentTiles.size() >= maxTilesInMemory){
+      evict();
+    }
+
+    ResidentTile entry;
+    entry.tile = new DtmTile(tileSize);
+    entry.dirty = false;
+
+    if(existingTiles.count(key) > 0){
+      entry.tile->read(getTileFilename(key));
+    }
+    else{
+      existingTiles.insert(key);
+      entry.dirty = true;
+    }
+
+    recentlyUsed.push_front(key);
+    entry.use = recentlyUsed.begin();
+
+    residentTiles[key] = entry;
+
+    return *entry.tile;
+  }
+
+  /**
+  * Returns the keys of the tiles of a level holding at least one point, row by row
+  *
+  * @param level the level
+  */
+  std::vector<DtmTileKey> getTiles(unsigned int level) const {
+    std::vector<DtmTileKey> tiles;
+
+    for(auto i=existingTiles.lower_bound(DtmTileKey(level,std::numeric_limits<int32_t>::min(),std::numeric_limits<int32_t>::min()));i!=existingTiles.end() && i->level == level;i++){
+      tiles.push_back(*i);
+    }
+
+    return tiles;
+  }
+
+  /**
+  * Returns the size of a cell at a level
+  *
+  * @param level the level
+  */
+  double getResolution(unsigned int level) const { return std::ldexp(resolution,level); }
+
+  /**Returns the number of cells on a side of a tile*/
+  unsigned int getTileSize() const { return tileSize; }
+
+  /**Returns the number of levels built*/
+  unsigned int getNbLevels() const { return nbLevels; }
+
+  /**Returns the number of tiles in memory*/
+  unsigned int getNbTilesInMemory() const { return residentTiles.size(); }
+
+  /**
+  * Returns the file of a tile in the tile directory
+  *
+  * @param key the key of the tile
+  */
+  std::string getTileFilename(const DtmTileKey & key) const {
+    std::stringstream ss;
+    ss << directory << "/" << key.level << "_" << key.column << "_" << key.row << ".tile";
+    return ss.str();
+  }
+
+private:
+
+  /**Tile in memory*/
+  struct ResidentTile{
+    /**The cells of the tile*/
+    DtmTile * tile;
+
+    /**Position of the tile in the recently used list*/
+    std::list<DtmTileKey>::iterator use;
+
+    /**True if the tile changed since it was last written*/
+    bool dirty;
+  };
+
+  /**Orders cell keys by level 0 tile*/
+  class TileOrder{
+  public:
+    TileOrder(unsigned int tileSize) : tileSize(tileSize){}
+
+    bool operator()(uint64_t k1,uint64_t k2) const {
+      DtmTileKey t1(0,floorDivide(DtmGrid::keyColumn(k1),tileSize),floorDivide(DtmGrid::keyRow(k1),tileSize));
+      DtmTileKey t2(0,floorDivide(DtmGrid::keyColumn(k2),tileSize),floorDivide(DtmGrid::keyRow(k2),tileSize));
+      return t1 < t2;
+    }
+
+  private:
+    int32_t tileSize;
+  };
+
+  /**
+  * Returns a / b rounded down
+  *
+  * @param a the dividend
+  * @param b the positive divisor
+  */
+  static int32_t floorDivide(int32_t a,int32_t b){
+    //In 64 bits, as the opposite of the lowest index does not fit 32 bits
+    int64_t wide = a;
+    return (int32_t)((wide >= 0) ? wide / b : -((-wide + b - 1) / b));
+  }
+
+  /**
+  * Finds the tile holding a cell, and the position of the cell in that tile
+  *
+  * @param level level of the cell
+  * @param column column of the cell at that level
+  * @param row row of the cell at that level
+  * @param key the key of the tile
+  * @param tileColumn the column of the cell in the tile
+  * @param tileRow the row of the cell in the tile
+  */
+  void locate(unsigned int level,int32_t column,int32_t row,DtmTileKey & key,unsigned int & tileColumn,unsigned int & tileRow) const {
+    key.level  = level;
+    key.column = floorDivide(column,tileSize);
+    key.row    = floorDivide(row,tileSize);
+
+    tileColumn = column - key.column * (int32_t)tileSize;
+    tileRow    = row - key.row * (int32_t)tileSize;
+  }
+
+  /**
+  * Returns a cell to be modified, allocating its tile if needed
+  *
+  * @param level level of the cell
+  * @param column column of the cell at that level
+  * @param row row of the cell at that level
+  */
+  DtmCell & cellToUpdate(unsigned int level,int32_t column,int32_t row){
+    DtmTileKey key(level,0,0);
+    unsigned int tileColumn,tileRow;
+
+    locate(level,column,row,key,tileColumn,tileRow);
+
+    DtmTile & tile = getTile(key);
+    residentTiles[key].dirty = true;
+
+    return tile.getCell(tileColumn,tileRow);
+  }
+
+  /**Writes the least recently used tile to the tile directory and frees it*/
+  void evict(){
+    DtmTileKey key = recentlyUsed.back();
+    ResidentTile & entry = residentTiles[key];
+
+    if(entry.dirty){
+      entry.tile->write(getTileFilename(key));
+    }
+
+    delete entry.tile;
+
+    recentlyUsed.pop_back();
+    residentTiles.erase(key);
+  }
+
+  /**Size of a cell at level 0*/
+  double resolution;
+
+  /**Directory where the tiles are written*/
+  std::string directory;
+
+  /**Number of cells on a side of a tile*/
+  unsigned int tileSize;
+
+  /**Largest number of tiles kept in memory*/
+  unsigned int maxTilesInMemory;
+
+  /**Number of levels built*/
+  unsigned int nbLevels;
+
+  /**Tiles in memory*/
+  std::map<DtmTileKey,ResidentTile> residentTiles;
+
+  /**Tiles in memory, most recently used first*/
+  std::list<DtmTileKey> recentlyUsed;
+
+  /**Tiles holding at least one point, in memory or not*/
+  std::set<DtmTileKey> existingTiles;
+};
+
+#endif
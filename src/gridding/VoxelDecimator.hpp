@@ -0,0 +1,136 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef VOXELDECIMATOR_HPP
+#define VOXELDECIMATOR_HPP
+
+#include <unordered_set>
+#include <cmath>
+#include <cstdint>
+#include "../utils/Exception.hpp"
+
+/*!
+* \brief Voxel key
+*
+* Integer coordinates of a voxel
+*/
+struct VoxelKey{
+  /**x index*/
+  int64_t x;
+
+  /**y index*/
+  int64_t y;
+
+  /**z index*/
+  int64_t z;
+
+  /**
+  * Returns true if both keys are the same voxel
+  *
+  * @param other the other key
+  */
+  bool operator==(const VoxelKey & other) const {
+    return x == other.x && y == other.y && z == other.z;
+  }
+};
+
+/*!
+* \brief Voxel key hash
+*
+* Hash function of a voxel key
+*/
+struct VoxelKeyHash{
+  /**
+  * Returns the hash of a voxel key
+  *
+  * @param key the voxel key
+  */
+  size_t operator()(const VoxelKey & key) const {
+    uint64_t h = (uint64_t)key.x * 0x9E3779B97F4A7C15ULL;
+    h ^= (uint64_t)key.y * 0xC2B2AE3D27D4EB4FULL + (h << 6) + (h >> 2);
+    h ^= (uint64_t)key.z * 0x165667B19E3779F9ULL + (h << 6) + (h >> 2);
+    return (size_t)h;
+  }
+};
+
+/*!
+* \brief Voxel decimator class
+*
+* Thins a stream of points by keeping the first point that falls in each voxel of a regular 3D grid. Points are
+* accepted or rejected as they arrive, so the decimated points can be stored directly, and only the keys of the
+* occupied voxels are remembered. For a seafloor surface, that is proportional to the area surveyed instead of to
+* the number of soundings.
+*/
+class VoxelDecimator{
+public:
+
+  /**
+  * Creates a voxel decimator
+  *
+  * @param cellSize the horizontal size of a voxel
+  * @param verticalCellSize the vertical size of a voxel, 0 to use the horizontal size
+  */
+  VoxelDecimator(double cellSize,double verticalCellSize = 0) :
+  cellSize(cellSize),
+  verticalCellSize((verticalCellSize > 0) ? verticalCellSize : cellSize),
+  nbPoints(0){
+    if(!(cellSize > 0)){
+      throw new Exception("The cell size of a voxel decimator must be positive");
+    }
+  }
+
+  /**Destroys the voxel decimator*/
+  ~VoxelDecimator(){
+
+  }
+
+  /**
+  * Returns true if the point is the first one of its voxel and must be kept
+  *
+  * @param x x position
+  * @param y y position
+  * @param z z position
+  */
+  bool add(double x,double y,double z){
+    nbPoints++;
+
+    VoxelKey key;
+    key.x = (int64_t)std::floor(x / cellSize);
+    key.y = (int64_t)std::floor(y / cellSize);
+    key.z = (int64_t)std::floor(z / verticalCellSize);
+
+    return voxels.insert(key).second;
+  }
+
+  /**Forgets the occupied voxels, to decimate another set of points*/
+  void clear(){
+    voxels.clear();
+    nbPoints = 0;
+  }
+
+  /**Returns the number of points given to add()*/
+  uint64_t getNbPoints() const { return nbPoints; }
+
+  /**Returns the number of points kept*/
+  uint64_t getNbKept() const { return voxels.size(); }
+
+  /**Returns the horizontal size of a voxel*/
+  double getCellSize() const { return cellSize; }
+
+private:
+
+  /**Horizontal size of a voxel*/
+  double cellSize;
+
+  /**Vertical size of a voxel*/
+  double verticalCellSize;
+
+  /**Number of points given to add()*/
+  uint64_t nbPoints;
+
+  /**Occupied voxels*/
+  std::unordered_set<VoxelKey,VoxelKeyHash> voxels;
+};
+
+#endif
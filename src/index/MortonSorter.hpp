@@ -0,0 +1,370 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef MORTONSORTER_HPP
+#define MORTONSORTER_HPP
+
+#include <vector>
+#include <queue>
+#include <cstdio>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include "../utils/Exception.hpp"
+#include "../utils/ThreadUtils.hpp"
+
+/*!
+* \brief Morton record
+*
+* A point with its position on the Morton curve
+*/
+struct MortonRecord{
+  /**Morton code of the point*/
+  uint64_t code;
+
+  /**x position*/
+  double x;
+
+  /**y position*/
+  double y;
+
+  /**z position*/
+  double z;
+
+  /**quality of the point*/
+  uint32_t quality;
+
+  /**intensity of the point*/
+  int32_t intensity;
+};
+
+/*!
+* \brief Morton sorter class
+*
+* Reorders points along a Z-order (Morton) curve in the horizontal plane, so that points close to each other
+* come out close to each other. x and y are quantized at a fixed resolution around the first point, and their
+* bits are interleaved into a 64 bit code. Points are sorted in memory with a parallel radix sort. When more points
+* are added than fit in memory, each full buffer is sorted and spilled to a temporary file, and the runs are
+* merged at the end.
+*
+* x and y must be horizontal coordinates, such as the north and east of a local geographic frame: the X and Y of
+* ECEF points are not a horizontal plane, their north-south extent being mostly along Z.
+*/
+class MortonSorter{
+public:
+
+  /**
+  * Creates a Morton sorter
+  *
+  * @param resolution size of the quantization step of x and y, 2^32 steps must cover the survey
+  * @param maxPointsInMemory number of points sorted in memory before spilling to a temporary file
+  * @param nbThreads number of threads used to sort, 0 to use all the hardware threads
+  */
+  MortonSorter(double resolution = 0.01,size_t maxPointsInMemory = 16000000,unsigned int nbThreads = 0) :
+  resolution(resolution),
+  maxPointsInMemory(std::max(maxPointsInMemory,(size_t)1)),
+  nbThreads(ThreadUtils::getNbThreads(nbThreads)),
+  hasOrigin(false),
+  originX(0),
+  originY(0){
+
+  }
+
+  /**Destroys the Morton sorter and its temporary files*/
+  virtual ~MortonSorter(){
+    for(auto i=runs.begin();i!=runs.end();i++){
+      fclose(*i);
+    }
+  }
+
+  /**
+  * Adds a point
+  *
+  * @param x x position
+  * @param y y position
+  * @param z z position
+  * @param quality quality of the point
+  * @param intensity intensity of the point
+  */
+  void add(double x,double y,double z,uint32_t quality,int32_t intensity){
+    if(!hasOrigin){
+      //Center the quantized range on the first point
+      originX = x - resolution * 2147483648.0;
+      originY = y - resolution * 2147483648.0;
+      hasOrigin = true;
+    }
+
+    MortonRecord record;
+    record.code = encode(quantize(x,originX),quantize(y,originY));
+    record.x = x;
+    record.y = y;
+    record.z = z;
+    record.quality = quality;
+    record.intensity = intensity;
+
+    records.push_back(record);
+
+    if(records.size() >= maxPointsInMemory){
+      spill();
+    }
+  }
+
+  /**Sorts the points and calls processSortedPoint() for each of them in Morton order*/
+  void finish(){
+    if(runs.empty()){
+      sort(records);
+
+      for(auto i=records.begin();i!=records.end();i++){
+        processSortedPoint(i->x,i->y,i->z,i->quality,i->intensity);
+      }
+    }
+    else{
+      spill();
+      merge();
+    }
+
+    records.clear();
+    records.shrink_to_fit();
+  }
+
+  /**Returns the number of temporary files used*/
+  unsigned int getNbRuns() const { return runs.size(); }
+
+  /**
+  * Interleaves the bits of two 32 bit integers, x in the even bits and y in the odd bits
+  *
+  * @param x the first integer
+  * @param y the second integer
+  */
+  static uint64_t encode(uint32_t x,uint32_t y){
+    return spread(x) | (spread(y) << 1);
+  }
+
+  /**
+  * Sorts records by Morton code with a parallel least significant digit radix sort
+  *
+  * @param toSort the records to sort
+  * @param nbThreads number of threads
+  */
+  static void radixSort(std::vector<MortonRecord> & toSort,unsigned int nbThreads){
+    size_t n = toSort.size();
+
+    if(n < 2) return;
+
+    //Small inputs are not worth the threads
+    unsigned int threads = (n < 65536) ? 1 : nbThreads;
+
+    std::vector<MortonRecord> buffer(n);
+    std::vector<size_t> histograms(threads * RADIX);
+
+    for(unsigned int shift=0;shift<64;shift+=RADIX_BITS){
+      std::fill(histograms.begin(),histograms.end(),0);
+
+      ThreadUtils::runChunks(threads,n,[&](unsigned int thread,size_t begin,size_t end){
+        size_t * histogram = &histograms[thread * RADIX];
+
+        for(size_t i=begin;i<end;i++){
+          histogram[(toSort[i].code >> shift) & (RADIX - 1)]++;
+        }
+      });
+
+      //Digits shared by every record, such as the high bits of a small survey, need no pass
+      bool trivial = false;
+
+      for(unsigned int digit=0;digit<RADIX && !trivial;digit++){
+        size_t total = 0;
+
+        for(unsigned int thread=0;thread<threads;thread++){
+          total += histograms[thread * RADIX + digit];
+        }
+
+        trivial = (total == n);
+      }
+
+      if(trivial) continue;
+
+      //Each thread scatters its chunk after the chunks of the previous threads, which keeps the sort stable
+      size_t offset = 0;
+
+      for(unsigned int digit=0;digit<RADIX;digit++){
+        for(unsigned int thread=0;thread<threads;thread++){
+          size_t count = histograms[thread * RADIX + digit];
+          histograms[thread * RADIX + digit] = offset;
+          offset += count;
+        }
+      }
+
+      ThreadUtils::runChunks(threads,n,[&](unsigned int thread,size_t begin,size_t end){
+        size_t * cursor = &histograms[thread * RADIX];
+
+        for(size_t i=begin;i<end;i++){
+          buffer[cursor[(toSort[i].code >> shift) & (RADIX - 1)]++] = toSort[i];
+        }
+      });
+
+      toSort.swap(buffer);
+    }
+  }
+
+protected:
+
+  /**
+  * Called for every point, in Morton order, by finish()
+  *
+  * @param x x position
+  * @param y y position
+  * @param z z position
+  * @param quality quality of the point
+  * @param intensity intensity of the point
+  */
+  virtual void processSortedPoint(double x,double y,double z,uint32_t quality,int32_t intensity){
+    std::cout << x << " " << y << " " << z << " " << quality << " " << intensity << std::endl;
+  }
+
+private:
+
+  /**Number of bits of a radix sort digit*/
+  static const unsigned int RADIX_BITS = 8;
+
+  /**Number of values of a radix sort digit*/
+  static const unsigned int RADIX = 1 << RADIX_BITS;
+
+  /**Number of records read at once from a temporary file while merging*/
+  static const size_t MERGE_BUFFER = 4096;
+
+  /**
+  * Spreads the bits of a 32 bit integer to the even bits of a 64 bit integer
+  *
+  * @param value the integer
+  */
+  static uint64_t spread(uint32_t value){
+    uint64_t x = value;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x << 8))  & 0x00FF00FF00FF00FFULL;
+    x = (x | (x << 4))  & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x << 2))  & 0x3333333333333333ULL;
+    x = (x | (x << 1))  & 0x5555555555555555ULL;
+    return x;
+  }
+
+  /**
+  * Returns the quantized step of a coordinate, clamped to 32 bits
+  *
+  * @param value the coordinate
+  * @param origin the coordinate of step 0
+  */
+  uint32_t quantize(double value,double origin) const {
+    double step = std::floor((value - origin) / resolution);
+    return (uint32_t)std::min(std::max(step,0.0),4294967295.0);
+  }
+
+  /**
+  * Sorts records in memory
+  *
+  * @param toSort the records
+  */
+  void sort(std::vector<MortonRecord> & toSort){
+    radixSort(toSort,nbThreads);
+  }
+
+  /**Sorts the points in memory and writes them to a new temporary file*/
+  void spill(){
+    if(records.empty()) return;
+
+    sort(records);
+
+    FILE * run = tmpfile();
+
+    if(!run){
+      throw new Exception("Cannot create temporary file for Morton sort");
+    }
+
+    if(fwrite(&records[0],sizeof(MortonRecord),records.size(),run) != records.size()){
+      fclose(run);
+      throw new Exception("Cannot write temporary file for Morton sort");
+    }
+
+    rewind(run);
+    runs.push_back(run);
+    records.clear();
+  }
+
+  /**Merges the temporary files, calling processSortedPoint() for each point*/
+  void merge(){
+    std::vector<std::vector<MortonRecord> > buffers(runs.size());
+    std::vector<size_t> positions(runs.size(),0);
+
+    //Smallest code first
+    std::priority_queue<std::pair<uint64_t,unsigned int>,std::vector<std::pair<uint64_t,unsigned int> >,std::greater<std::pair<uint64_t,unsigned int> > > heads;
+
+    for(unsigned int i=0;i<runs.size();i++){
+      if(refill(i,buffers[i])){
+        heads.push(std::make_pair(buffers[i][0].code,i));
+      }
+    }
+
+    while(!heads.empty()){
+      unsigned int run = heads.top().second;
+      heads.pop();
+
+      MortonRecord & record = buffers[run][positions[run]++];
+      processSortedPoint(record.x,record.y,record.z,record.quality,record.intensity);
+
+      if(positions[run] == buffers[run].size()){
+        positions[run] = 0;
+
+        if(!refill(run,buffers[run])) continue;
+      }
+
+      heads.push(std::make_pair(buffers[run][positions[run]].code,run));
+    }
+
+    for(auto i=runs.begin();i!=runs.end();i++){
+      fclose(*i);
+    }
+
+    runs.clear();
+  }
+
+  /**
+  * Reads the next records of a temporary file
+  *
+  * @param run index of the temporary file
+  * @param buffer receives the records
+  * @return false if the file has no more records
+  */
+  bool refill(unsigned int run,std::vector<MortonRecord> & buffer){
+    buffer.resize((size_t)MERGE_BUFFER);
+    buffer.resize(fread(&buffer[0],sizeof(MortonRecord),MERGE_BUFFER,runs[run]));
+    return !buffer.empty();
+  }
+
+  /**Size of the quantization step*/
+  double resolution;
+
+  /**Number of points sorted in memory before spilling*/
+  size_t maxPointsInMemory;
+
+  /**Number of threads used to sort*/
+  unsigned int nbThreads;
+
+  /**True once the quantization origin is set*/
+  bool hasOrigin;
+
+  /**x of quantization step 0*/
+  double originX;
+
+  /**y of quantization step 0*/
+  double originY;
+
+  /**Points not yet spilled*/
+  std::vector<MortonRecord> records;
+
+  /**Temporary files of sorted points*/
+  std::vector<FILE*> runs;
+};
+
+#endif
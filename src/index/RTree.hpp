@@ -0,0 +1,253 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef RTREE_HPP
+#define RTREE_HPP
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+/*!
+* \brief Bounding box class
+*
+* Axis aligned rectangle in the horizontal plane
+*/
+class BoundingBox{
+public:
+
+  /**Creates an empty bounding box*/
+  BoundingBox() :
+  minX(std::numeric_limits<double>::max()),
+  minY(std::numeric_limits<double>::max()),
+  maxX(-std::numeric_limits<double>::max()),
+  maxY(-std::numeric_limits<double>::max()){
+
+  }
+
+  /**
+  * Creates a bounding box
+  *
+  * @param minX smallest x
+  * @param minY smallest y
+  * @param maxX largest x
+  * @param maxY largest y
+  */
+  BoundingBox(double minX,double minY,double maxX,double maxY) : minX(minX), minY(minY), maxX(maxX), maxY(maxY){
+
+  }
+
+  /**
+  * Grows the box to contain a position
+  *
+  * @param x x position
+  * @param y y position
+  */
+  void expand(double x,double y){
+    minX = std::min(minX,x);
+    minY = std::min(minY,y);
+    maxX = std::max(maxX,x);
+    maxY = std::max(maxY,y);
+  }
+
+  /**
+  * Grows the box to contain another box
+  *
+  * @param other the other box
+  */
+  void expand(const BoundingBox & other){
+    minX = std::min(minX,other.minX);
+    minY = std::min(minY,other.minY);
+    maxX = std::max(maxX,other.maxX);
+    maxY = std::max(maxY,other.maxY);
+  }
+
+  /**
+  * Returns true if the boxes share at least a point
+  *
+  * @param other the other box
+  */
+  bool intersects(const BoundingBox & other) const {
+    return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+  }
+
+  /**Returns true if the box contains nothing*/
+  bool isEmpty() const { return minX > maxX || minY > maxY; }
+
+  /**Smallest x*/
+  double minX;
+
+  /**Smallest y*/
+  double minY;
+
+  /**Largest x*/
+  double maxX;
+
+  /**Largest y*/
+  double maxY;
+};
+
+/*!
+* \brief R-tree class
+*
+* Static R-tree over bounding boxes, bulk loaded with Sort-Tile-Recursive packing: the boxes are sorted by x into
+* vertical slices, each slice is sorted by y and cut into full nodes, and the nodes are packed the same way level
+* after level. Finding the boxes that intersect a query box visits only the branches whose box intersects it.
+*/
+class RTree{
+public:
+
+  /**
+  * Builds an R-tree
+  *
+  * @param boxes the boxes to index, identified by their position in this vector
+  * @param nodeCapacity maximum number of children of a node
+  */
+  RTree(const std::vector<BoundingBox> & boxes,unsigned int nodeCapacity = 16) : nodeCapacity(std::max(nodeCapacity,2u)), root(0){
+    if(boxes.empty()) return;
+
+    //Leaves hold the boxes, the following levels hold the nodes of the level below
+    std::vector<uint32_t> level;
+
+    for(uint32_t i=0;i<boxes.size();i++){
+      RTreeNode entry;
+      entry.box = boxes[i];
+      entry.first = i;
+      entry.count = 0;
+      nodes.push_back(entry);
+      level.push_back(i);
+    }
+
+    while(level.size() > 1){
+      level = pack(level);
+    }
+
+    root = level[0];
+  }
+
+  /**Destroys the R-tree*/
+  ~RTree(){
+
+  }
+
+  /**
+  * Finds the boxes that intersect a query box
+  *
+  * @param query the query box
+  * @param results receives the positions of the intersecting boxes
+  */
+  void query(const BoundingBox & query,std::vector<uint32_t> & results) const {
+    results.clear();
+
+    if(nodes.empty()) return;
+
+    std::vector<uint32_t> stack(1,root);
+
+    while(!stack.empty()){
+      const RTreeNode & node = nodes[stack.back()];
+      stack.pop_back();
+
+      if(!node.box.intersects(query)) continue;
+
+      if(node.count == 0){
+        results.push_back(node.first);
+      }
+      else{
+        for(uint32_t i=0;i<node.count;i++){
+          stack.push_back(children[node.first + i]);
+        }
+      }
+    }
+  }
+
+  /**Returns the number of nodes, boxes included*/
+  size_t getNbNodes() const { return nodes.size(); }
+
+private:
+
+  /**
+  * A node of the tree. A box given to the tree is a node without children, whose first member is its position.
+  */
+  struct RTreeNode{
+    /**Box containing the children*/
+    BoundingBox box;
+
+    /**Position of the first child in children, or position of the box for a leaf entry*/
+    uint32_t first;
+
+    /**Number of children, 0 for a leaf entry*/
+    uint32_t count;
+  };
+
+  /**
+  * Groups the nodes of a level into parent nodes, and returns the parents
+  *
+  * @param level the nodes of the level
+  */
+  std::vector<uint32_t> pack(std::vector<uint32_t> & level){
+    size_t nbParents = (level.size() + nodeCapacity - 1) / nodeCapacity;
+    size_t nbSlices = (size_t)std::ceil(std::sqrt((double)nbParents));
+    size_t sliceSize = nbSlices * nodeCapacity;
+
+    std::sort(level.begin(),level.end(),[&](uint32_t a,uint32_t b){
+      return centerX(a) < centerX(b);
+    });
+
+    std::vector<uint32_t> parents;
+
+    for(size_t slice=0;slice<level.size();slice+=sliceSize){
+      std::vector<uint32_t>::iterator end = level.begin() + std::min(slice + sliceSize,level.size());
+
+      std::sort(level.begin() + slice,end,[&](uint32_t a,uint32_t b){
+        return centerY(a) < centerY(b);
+      });
+
+      for(std::vector<uint32_t>::iterator i=level.begin() + slice;i<end;i+=std::min((ptrdiff_t)nodeCapacity,end - i)){
+        RTreeNode parent;
+        parent.first = children.size();
+        parent.count = std::min((ptrdiff_t)nodeCapacity,end - i);
+
+        for(uint32_t j=0;j<parent.count;j++){
+          children.push_back(i[j]);
+          parent.box.expand(nodes[i[j]].box);
+        }
+
+        parents.push_back(nodes.size());
+        nodes.push_back(parent);
+      }
+    }
+
+    return parents;
+  }
+
+  /**
+  * Returns the x of the center of a node
+  *
+  * @param node the node
+  */
+  double centerX(uint32_t node) const { return (nodes[node].box.minX + nodes[node].box.maxX) / 2; }
+
+  /**
+  * Returns the y of the center of a node
+  *
+  * @param node the node
+  */
+  double centerY(uint32_t node) const { return (nodes[node].box.minY + nodes[node].box.maxY) / 2; }
+
+  /**Maximum number of children of a node*/
+  unsigned int nodeCapacity;
+
+  /**Position of the root node*/
+  uint32_t root;
+
+  /**Boxes, then nodes level after level*/
+  std::vector<RTreeNode> nodes;
+
+  /**Children of the nodes, node after node*/
+  std::vector<uint32_t> children;
+};
+
+#endif
@@ -0,0 +1,447 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef SOUNDINGINDEX_HPP
+#define SOUNDINGINDEX_HPP
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <cstring>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "../utils/Exception.hpp"
+
+/*!
+* \brief Indexed sounding
+*
+* A georeferenced sounding as stored in a sounding index file
+*/
+struct IndexedSounding{
+  /**x position*/
+  double x;
+
+  /**y position*/
+  double y;
+
+  /**z position*/
+  double z;
+
+  /**quality of the sounding*/
+  uint32_t quality;
+
+  /**intensity of the sounding*/
+  int32_t intensity;
+};
+
+/**
+* Returns a coordinate of a sounding
+*
+* @param sounding the sounding
+* @param axis 0 for x, 1 for y, 2 for z
+*/
+inline double getSoundingCoordinate(const IndexedSounding & sounding,int axis){
+  return (axis == 0) ? sounding.x : ((axis == 1) ? sounding.y : sounding.z);
+}
+
+/*!
+* \brief Sounding index node
+*
+* A node of the kd-tree of a sounding index file: the bounding box of its soundings and their range in the file
+*/
+struct SoundingIndexNode{
+  /**Smallest x, y and z of the soundings of the node*/
+  double minimum[3];
+
+  /**Largest x, y and z of the soundings of the node*/
+  double maximum[3];
+
+  /**Index of the first sounding of the node*/
+  uint64_t begin;
+
+  /**Index after the last sounding of the node*/
+  uint64_t end;
+};
+
+/*!
+* \brief Sounding index header
+*
+* Start of a sounding index file, followed by the nodes then by the soundings
+*/
+struct SoundingIndexHeader{
+  /**File signature*/
+  char magic[8];
+
+  /**Number of soundings*/
+  uint64_t nbSoundings;
+
+  /**Number of nodes*/
+  uint64_t nbNodes;
+
+  /**Depth of the leaves, the root being at depth 0*/
+  uint32_t depth;
+
+  /**Largest number of soundings in a leaf*/
+  uint32_t leafSize;
+};
+
+/**Signature of sounding index files*/
+static const char SOUNDING_INDEX_MAGIC[8] = {'M','B','E','S','I','D','X','1'};
+
+/*!
+* \brief Sounding index builder class
+*
+* Builds a balanced kd-tree over soundings and writes it to a file. The tree is complete and stored as an implicit
+* heap (children of node k are 2k+1 and 2k+2), so the range of soundings of each node only depends on the number of
+* soundings. Subtrees can therefore be built by different threads without any coordination. The soundings of a leaf
+* are contiguous in the file.
+*/
+class SoundingIndexBuilder{
+public:
+
+  /**
+  * Creates a sounding index builder
+  *
+  * @param leafSize largest number of soundings in a leaf
+  * @param nbThreads number of threads used to build the tree, 0 to use all the hardware threads
+  */
+  SoundingIndexBuilder(unsigned int leafSize = 256,unsigned int nbThreads = 0) : leafSize(std::max(leafSize,1u)), nbThreads(nbThreads), depth(0){
+
+  }
+
+  /**Destroys the sounding index builder*/
+  ~SoundingIndexBuilder(){
+
+  }
+
+  /**
+  * Adds a sounding to the index
+  *
+  * @param x x position
+  * @param y y position
+  * @param z z position
+  * @param quality quality of the sounding
+  * @param intensity intensity of the sounding
+  */
+  void add(double x,double y,double z,uint32_t quality,int32_t intensity){
+    IndexedSounding sounding;
+    sounding.x = x;
+    sounding.y = y;
+    sounding.z = z;
+    sounding.quality = quality;
+    sounding.intensity = intensity;
+
+    soundings.push_back(sounding);
+  }
+
+  /**Returns the number of soundings added*/
+  uint64_t getNbSoundings() const { return soundings.size(); }
+
+  /**
+  * Builds the tree and writes the index file
+  *
+  * @param filename the index file
+  */
+  void write(const std::string & filename){
+    depth = 0;
+
+    while(((uint64_t)leafSize << depth) < soundings.size()){
+      depth++;
+    }
+
+    nodes.assign(((uint64_t)2 << depth) - 1,SoundingIndexNode());
+
+    unsigned int threads = (nbThreads > 0) ? nbThreads : std::thread::hardware_concurrency();
+    unsigned int parallelDepth = 0;
+
+    while((1u << parallelDepth) < threads) parallelDepth++;
+
+    build(0,0,soundings.size(),0,parallelDepth);
+
+    SoundingIndexHeader header;
+    memcpy(header.magic,SOUNDING_INDEX_MAGIC,sizeof(header.magic));
+    header.nbSoundings = soundings.size();
+    header.nbNodes = nodes.size();
+    header.depth = depth;
+    header.leafSize = leafSize;
+
+    std::ofstream out(filename.c_str(),std::ios::binary | std::ios::trunc);
+
+    if(!out){
+      throw new Exception("Cannot write sounding index");
+    }
+
+    out.write((const char*)&header,sizeof(header));
+    out.write((const char*)&nodes[0],nodes.size() * sizeof(SoundingIndexNode));
+
+    if(!soundings.empty()){
+      out.write((const char*)&soundings[0],soundings.size() * sizeof(IndexedSounding));
+    }
+
+    if(!out){
+      throw new Exception("Cannot write sounding index");
+    }
+  }
+
+private:
+
+  /**
+  * Computes the bounding box of a node, splits its soundings at the median of its longest axis, and builds its children
+  *
+  * @param node index of the node
+  * @param begin index of the first sounding of the node
+  * @param end index after the last sounding of the node
+  * @param level depth of the node
+  * @param parallelDepth depth down to which the left child is built by another thread
+  */
+  void build(uint64_t node,uint64_t begin,uint64_t end,unsigned int level,unsigned int parallelDepth){
+    SoundingIndexNode & box = nodes[node];
+
+    box.begin = begin;
+    box.end = end;
+
+    for(int axis=0;axis<3;axis++){
+      box.minimum[axis] = std::numeric_limits<double>::max();
+      box.maximum[axis] = -std::numeric_limits<double>::max();
+    }
+
+    for(uint64_t i=begin;i<end;i++){
+      for(int axis=0;axis<3;axis++){
+        double coordinate = getSoundingCoordinate(soundings[i],axis);
+
+        box.minimum[axis] = std::min(box.minimum[axis],coordinate);
+        box.maximum[axis] = std::max(box.maximum[axis],coordinate);
+      }
+    }
+
+    if(level == depth) return;
+
+    int axis = 0;
+
+    for(int i=1;i<3;i++){
+      if(box.maximum[i] - box.minimum[i] > box.maximum[axis] - box.minimum[axis]) axis = i;
+    }
+
+    uint64_t middle = begin + (end - begin) / 2;
+
+    std::nth_element(soundings.begin() + begin,soundings.begin() + middle,soundings.begin() + end,AxisOrder(axis));
+
+    if(level < parallelDepth){
+      std::thread left(&SoundingIndexBuilder::build,this,2 * node + 1,begin,middle,level + 1,parallelDepth);
+      build(2 * node + 2,middle,end,level + 1,parallelDepth);
+      left.join();
+    }
+    else{
+      build(2 * node + 1,begin,middle,level + 1,parallelDepth);
+      build(2 * node + 2,middle,end,level + 1,parallelDepth);
+    }
+  }
+
+  /**Orders soundings along an axis*/
+  class AxisOrder{
+  public:
+    AxisOrder(int axis) : axis(axis){}
+
+    bool operator()(const IndexedSounding & s1,const IndexedSounding & s2) const {
+      return getSoundingCoordinate(s1,axis) < getSoundingCoordinate(s2,axis);
+    }
+
+  private:
+    int axis;
+  };
+
+  /**Largest number of soundings in a leaf*/
+  unsigned int leafSize;
+
+  /**Number of threads used to build the tree*/
+  unsigned int nbThreads;
+
+  /**Depth of the leaves*/
+  unsigned int depth;
+
+  /**The soundings, in leaf order once built*/
+  std::vector<IndexedSounding> soundings;
+
+  /**The nodes, as an implicit heap*/
+  std::vector<SoundingIndexNode> nodes;
+};
+
+/*!
+* \brief Sounding index class
+*
+* Reads a file written by SoundingIndexBuilder. The file is memory-mapped, so a query only reads the pages of
+* the nodes it visits and of the leaves intersecting the query box.
+*/
+class SoundingIndex{
+public:
+
+  /**
+  * Opens a sounding index file
+  *
+  * @param filename the index file
+  */
+  SoundingIndex(const std::string & filename) : data(NULL), size(0){
+#ifdef _WIN32
+    std::ifstream in(filename.c_str(),std::ios::binary);
+
+    if(!in){
+      throw new Exception("Cannot open sounding index");
+    }
+
+    buffer.assign(std::istreambuf_iterator<char>(in),std::istreambuf_iterator<char>());
+    data = buffer.empty() ? NULL : &buffer[0];
+    size = buffer.size();
+#else
+    int fd = open(filename.c_str(),O_RDONLY);
+
+    if(fd < 0){
+      throw new Exception("Cannot open sounding index");
+    }
+
+    struct stat status;
+
+    if(fstat(fd,&status) != 0 || status.st_size < (off_t)sizeof(SoundingIndexHeader)){
+      close(fd);
+      throw new Exception("Invalid sounding index");
+    }
+
+    size = status.st_size;
+
+    void * mapping = mmap(NULL,size,PROT_READ,MAP_SHARED,fd,0);
+    close(fd);
+
+    if(mapping == MAP_FAILED){
+      throw new Exception("Cannot map sounding index");
+    }
+
+    data = (const char*)mapping;
+#endif
+
+    header = (const SoundingIndexHeader*)data;
+
+    if(size < sizeof(SoundingIndexHeader) || memcmp(header->magic,SOUNDING_INDEX_MAGIC,sizeof(header->magic)) != 0 ||
+       size != sizeof(SoundingIndexHeader) + header->nbNodes * sizeof(SoundingIndexNode) + header->nbSoundings * sizeof(IndexedSounding)){
+      unmap();
+      throw new Exception("Invalid sounding index");
+    }
+
+    nodes = (const SoundingIndexNode*)(data + sizeof(SoundingIndexHeader));
+    soundings = (const IndexedSounding*)(data + sizeof(SoundingIndexHeader) + header->nbNodes * sizeof(SoundingIndexNode));
+  }
+
+  /**Closes the sounding index*/
+  ~SoundingIndex(){
+    unmap();
+  }
+
+  /**Returns the number of soundings in the index*/
+  uint64_t getNbSoundings() const { return header->nbSoundings; }
+
+  /**
+  * Finds the soundings inside a box, bounds included
+  *
+  * @param minimum smallest x, y and z of the box
+  * @param maximum largest x, y and z of the box
+  * @param result the soundings found are appended to it
+  */
+  void query(const double minimum[3],const double maximum[3],std::vector<IndexedSounding> & result) const {
+    if(header->nbSoundings == 0) return;
+
+    std::vector<uint64_t> stack;
+    stack.push_back(0);
+
+    while(!stack.empty()){
+      uint64_t node = stack.back();
+      stack.pop_back();
+
+      const SoundingIndexNode & box = nodes[node];
+
+      if(box.begin == box.end || !intersects(box,minimum,maximum)) continue;
+
+      //Whole nodes inside the box are copied without testing their soundings
+      if(contains(minimum,maximum,box)){
+        result.insert(result.end(),soundings + box.begin,soundings + box.end);
+        continue;
+      }
+
+      if(2 * node + 1 < header->nbNodes){
+        stack.push_back(2 * node + 2);
+        stack.push_back(2 * node + 1);
+        continue;
+      }
+
+      for(uint64_t i=box.begin;i<box.end;i++){
+        const IndexedSounding & sounding = soundings[i];
+
+        if(sounding.x >= minimum[0] && sounding.x <= maximum[0] &&
+           sounding.y >= minimum[1] && sounding.y <= maximum[1] &&
+           sounding.z >= minimum[2] && sounding.z <= maximum[2]){
+          result.push_back(sounding);
+        }
+      }
+    }
+  }
+
+private:
+
+  /**Returns true if a node's box intersects the query box*/
+  static bool intersects(const SoundingIndexNode & box,const double minimum[3],const double maximum[3]){
+    for(int axis=0;axis<3;axis++){
+      if(box.maximum[axis] < minimum[axis] || box.minimum[axis] > maximum[axis]) return false;
+    }
+
+    return true;
+  }
+
+  /**Returns true if the query box contains a node's box*/
+  static bool contains(const double minimum[3],const double maximum[3],const SoundingIndexNode & box){
+    for(int axis=0;axis<3;axis++){
+      if(box.minimum[axis] < minimum[axis] || box.maximum[axis] > maximum[axis]) return false;
+    }
+
+    return true;
+  }
+
+  /**Releases the file*/
+  void unmap(){
+#ifndef _WIN32
+    if(data) munmap((void*)data,size);
+#endif
+    data = NULL;
+  }
+
+  /**The file contents*/
+  const char * data;
+
+  /**Size of the file*/
+  size_t size;
+
+#ifdef _WIN32
+  /**The file contents, read in memory where mapping is not available*/
+  std::vector<char> buffer;
+#endif
+
+  /**The header of the file*/
+  const SoundingIndexHeader * header;
+
+  /**The nodes of the file*/
+  const SoundingIndexNode * nodes;
+
+  /**The soundings of the file*/
+  const IndexedSounding * soundings;
+};
+
+#endif
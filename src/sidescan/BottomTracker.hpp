@@ -0,0 +1,239 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef BOTTOMTRACKER_HPP
+#define BOTTOMTRACKER_HPP
+
+#include <vector>
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include "SidescanPing.hpp"
+#include "../utils/Exception.hpp"
+
+/*!
+* \brief Bottom tracker class
+*
+* Finds the first bottom return of sidescan channels, which gives the altitude of the sensor. The samples of a
+* channel are smoothed with a moving average, and the first return is where the smoothed samples first rise above
+* a level set between the darkest and the brightest smoothed samples searched. The returns of the last pings of each
+* channel are kept in a ring buffer: a return too far from their median is searched again near the median, and
+* replaced by the median if nothing is found there, so a fish or a bright water column does not make the altitude
+* jump.
+*
+* Each pass over a channel is a simple loop, and the buffers are reused from ping to ping, so tracking runs inline
+* while decoding.
+*/
+class BottomTracker{
+public:
+
+  /**
+  * Creates a bottom tracker
+  *
+  * @param threshold position of the detection level between the darkest and the brightest smoothed samples, from 0 to 1
+  * @param smoothingWidth number of samples averaged
+  * @param historySize number of pings of each channel kept to check the along track consistency, 0 to disable it
+  * @param maxJump largest difference between a return and the median of the previous returns, in meters
+  * @param blanking distance from the sensor in which no return is searched, in meters
+  */
+  BottomTracker(double threshold = 0.5,unsigned int smoothingWidth = 9,unsigned int historySize = 15,double maxJump = 2.0,double blanking = 0) :
+  threshold(threshold),
+  smoothingWidth(std::max(smoothingWidth,1u)),
+  historySize(historySize),
+  maxJump(maxJump),
+  blanking(blanking){
+    if(!(threshold > 0 && threshold < 1)){
+      throw new Exception("The bottom tracking threshold must be between 0 and 1");
+    }
+  }
+
+  /**Destroys the bottom tracker*/
+  ~BottomTracker(){
+
+  }
+
+  /**
+  * Returns the distance to the first bottom return of a ping, or -1 if none is found
+  *
+  * @param ping the ping, in slant range
+  */
+  double track(SidescanPing & ping){
+    ping.getSamples(widened);
+
+    return track(ping.getChannelNumber(),widened.data(),widened.size(),ping.getDistancePerSample());
+  }
+
+  /**
+  * Returns the distance to the first bottom return of a channel, or -1 if none is found
+  *
+  * @param channel the channel number, each channel having its own history
+  * @param samples the slant range samples
+  * @param nbSamples the number of samples
+  * @param distancePerSample the distance between samples
+  */
+  double track(int channel,const double * samples,unsigned int nbSamples,double distancePerSample){
+    if(nbSamples == 0 || !(distancePerSample > 0)) return -1;
+
+    smooth(samples,nbSamples);
+
+    unsigned int first = std::min((unsigned int)std::ceil(blanking / distancePerSample),nbSamples);
+
+    if(first >= nbSamples) return -1;
+
+    long detected = findRise(first,nbSamples);
+
+    History & history = histories[channel];
+
+    if(historySize > 0 && history.returns.size() == historySize){
+      double median = history.getMedian();
+      long expected = (long)std::floor(median / distancePerSample + 0.5);
+      long window = (long)std::ceil(maxJump / distancePerSample);
+
+      if(detected < 0 || std::labs(detected - expected) > window){
+        //Search again near the previous returns, with a level set by the samples there
+        long begin = std::max<long>(first,expected - window);
+        long end = std::min<long>(nbSamples,expected + window + 1);
+
+        detected = (begin < end) ? findRise(begin,end) : -1;
+
+        if(detected < 0){
+          return median;
+        }
+      }
+    }
+
+    if(detected < 0) return -1;
+
+    double altitude = detected * distancePerSample;
+
+    if(historySize > 0){
+      history.add(altitude,historySize);
+    }
+
+    return altitude;
+  }
+
+  /**Forgets the returns of the previous pings*/
+  void clear(){
+    histories.clear();
+  }
+
+private:
+
+  /**
+  * Returns of the last pings of a channel, in a ring buffer
+  */
+  struct History{
+    /**Returns, the oldest one being at next once the buffer is full*/
+    std::vector<double> returns;
+
+    /**Position of the next return to replace*/
+    unsigned int next = 0;
+
+    /**
+    * Adds a return, replacing the oldest one when the buffer is full
+    *
+    * @param altitude the return
+    * @param size the size of the buffer
+    */
+    void add(double altitude,unsigned int size){
+      if(returns.size() < size){
+        returns.push_back(altitude);
+      }
+      else{
+        returns[next] = altitude;
+        next = (next + 1) % size;
+      }
+    }
+
+    /**Returns the median of the returns*/
+    double getMedian() const {
+      std::vector<double> sorted(returns);
+      std::nth_element(sorted.begin(),sorted.begin() + sorted.size() / 2,sorted.end());
+      return sorted[sorted.size() / 2];
+    }
+  };
+
+  /**
+  * Smooths samples with a centered moving average, into smoothed
+  *
+  * @param samples the samples
+  * @param nbSamples the number of samples
+  */
+  void smooth(const double * samples,unsigned int nbSamples){
+    //Prefix sums, the average of a window being the difference of two sums
+    sums.resize(nbSamples + 1);
+    sums[0] = 0;
+
+    for(unsigned int i=0;i<nbSamples;i++){
+      sums[i + 1] = sums[i] + samples[i];
+    }
+
+    smoothed.resize(nbSamples);
+
+    unsigned int half = smoothingWidth / 2;
+
+    for(unsigned int i=0;i<nbSamples;i++){
+      unsigned int begin = (i > half) ? i - half : 0;
+      unsigned int end = std::min(i + half + 1,nbSamples);
+      smoothed[i] = (sums[end] - sums[begin]) / (end - begin);
+    }
+  }
+
+  /**
+  * Returns the first smoothed sample of a range at or above the detection level of the range, or -1
+  *
+  * @param begin the first sample of the range
+  * @param end the sample after the range
+  */
+  long findRise(long begin,long end) const {
+    //Detection level between the darkest and the brightest samples of the range
+    double darkest = smoothed[begin];
+    double brightest = smoothed[begin];
+
+    for(long i=begin + 1;i<end;i++){
+      darkest = std::min(darkest,smoothed[i]);
+      brightest = std::max(brightest,smoothed[i]);
+    }
+
+    if(!(brightest > darkest)) return -1;
+
+    double level = darkest + threshold * (brightest - darkest);
+
+    for(long i=begin;i<end;i++){
+      if(smoothed[i] >= level) return i;
+    }
+
+    return -1;
+  }
+
+  /**Position of the detection level between the darkest and the brightest smoothed samples*/
+  double threshold;
+
+  /**Number of samples averaged*/
+  unsigned int smoothingWidth;
+
+  /**Number of pings of each channel kept*/
+  unsigned int historySize;
+
+  /**Largest difference between a return and the median of the previous returns*/
+  double maxJump;
+
+  /**Distance from the sensor in which no return is searched*/
+  double blanking;
+
+  /**Previous returns of each channel*/
+  std::map<int,History> histories;
+
+  /**Samples of the current ping widened to double*/
+  std::vector<double> widened;
+
+  /**Prefix sums of the current samples*/
+  std::vector<double> sums;
+
+  /**Smoothed samples of the current ping*/
+  std::vector<double> smoothed;
+};
+
+#endif
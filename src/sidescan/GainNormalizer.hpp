@@ -0,0 +1,277 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef GAINNORMALIZER_HPP
+#define GAINNORMALIZER_HPP
+
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "SidescanPing.hpp"
+#include "../utils/Exception.hpp"
+
+/*!
+* \brief Gain normalizer class
+*
+* Removes the across track gain of sidescan channels: time varying gain, beam pattern and the loss of backscatter
+* with the grazing angle. The ground range samples of a channel are put in bins of incidence angle, computed from the
+* altitude of the sensor, or in bins of range when the altitude is unknown. The gain curve of a channel is the mean
+* of each bin over a sliding window of its last pings, and every sample is multiplied by the mean of the window
+* divided by the curve at its bin, which flattens the channel across track while keeping its level.
+*
+* The window is causal, so a ping is normalized as soon as it is decoded. Each channel keeps the bin sums of the pings
+* of its window in a ring buffer, so memory depends on the window and the number of bins, not on the length of the
+* line. The bin of every sample depends only on the geometry of the channel and is computed once while the geometry
+* does not change, and the gains are spread to the samples before they are applied, so applying them is a loop of
+* multiplications that the compiler vectorizes.
+*/
+class GainNormalizer{
+public:
+
+  /**
+  * Creates a gain normalizer
+  *
+  * @param windowSize number of pings of each channel in the gain curve
+  * @param nbBins number of bins of the gain curve
+  */
+  GainNormalizer(unsigned int windowSize = 100,unsigned int nbBins = 90) :
+  windowSize(windowSize),
+  nbBins(nbBins),
+  nbSamples(0),
+  distancePerSample(0),
+  altitude(0){
+    if(windowSize == 0 || nbBins == 0){
+      throw new Exception("Gain normalization needs a window and bins");
+    }
+  }
+
+  /**Destroys the gain normalizer*/
+  ~GainNormalizer(){
+
+  }
+
+  /**
+  * Normalizes a ping in place. Pings without samples or without a distance per sample are left as they are.
+  *
+  * Integer samples are stored as floats once normalized: samples brighter than the mean of their bin, such as
+  * targets, would otherwise saturate at the largest value of their type.
+  *
+  * @param ping the ping, in ground range
+  * @param altitude the altitude of the sensor above the seafloor, 0 if unknown
+  */
+  void normalize(SidescanPing & ping,double altitude){
+    if(ping.getNbSamples() == 0 || !(ping.getDistancePerSample() > 0)) return;
+
+    ping.getSamples(widened);
+
+    normalize(ping.getChannelNumber(),widened.data(),widened.size(),ping.getDistancePerSample(),altitude);
+
+    if(ping.getSampleType() == SIDESCAN_SAMPLE_DOUBLE){
+      ping.setSamples(widened);
+      return;
+    }
+
+    narrowed.resize(widened.size());
+
+    for(unsigned int i=0;i<widened.size();i++){
+      narrowed[i] = (float)widened[i];
+    }
+
+    ping.setSamples(narrowed.data(),narrowed.size());
+  }
+
+  /**
+  * Adds the samples of a channel to its gain curve, then normalizes them in place
+  *
+  * @param channel the channel number, each channel having its own gain curve
+  * @param samples the ground range samples
+  * @param nbSamples the number of samples
+  * @param distancePerSample the ground distance between samples
+  * @param altitude the altitude of the sensor above the seafloor, 0 if unknown
+  */
+  void normalize(int channel,double * samples,unsigned int nbSamples,double distancePerSample,double altitude){
+    if(nbSamples == 0 || !(distancePerSample > 0)) return;
+
+    setGeometry(nbSamples,distancePerSample,altitude);
+
+    Window & window = windows[channel];
+
+    if(window.sums.empty()){
+      window.sums.assign(nbBins,0);
+      window.counts.assign(nbBins,0);
+    }
+
+    //Bin sums of this ping, replacing those of the oldest ping once the window is full
+    BinSums * current;
+
+    if(window.pings.size() < windowSize){
+      window.pings.push_back(BinSums());
+      current = &window.pings.back();
+    }
+    else{
+      current = &window.pings[window.next];
+
+      for(unsigned int b=0;b<nbBins;b++){
+        window.sums[b] -= current->sums[b];
+        window.counts[b] -= current->counts[b];
+      }
+
+      window.next = (window.next + 1) % windowSize;
+    }
+
+    current->sums.assign(nbBins,0);
+    current->counts.assign(nbBins,0);
+
+    const uint32_t * bin = bins.data();
+
+    for(unsigned int i=0;i<nbSamples;i++){
+      current->sums[bin[i]] += samples[i];
+      current->counts[bin[i]]++;
+    }
+
+    double totalSum = 0;
+    uint64_t totalCount = 0;
+
+    for(unsigned int b=0;b<nbBins;b++){
+      window.sums[b] += current->sums[b];
+      window.counts[b] += current->counts[b];
+
+      totalSum += window.sums[b];
+      totalCount += window.counts[b];
+    }
+
+    //Gain of every bin, bins without samples or without backscatter being left as they are
+    double level = (totalCount > 0) ? totalSum / totalCount : 0;
+
+    for(unsigned int b=0;b<nbBins;b++){
+      double mean = (window.counts[b] > 0) ? window.sums[b] / window.counts[b] : 0;
+      gains[b] = (mean > 0 && level > 0) ? level / mean : 1;
+    }
+
+    //Spread the gains to the samples, then apply them
+    double * sampleGain = sampleGains.data();
+
+    for(unsigned int i=0;i<nbSamples;i++){
+      sampleGain[i] = gains[bin[i]];
+    }
+
+    for(unsigned int i=0;i<nbSamples;i++){
+      samples[i] *= sampleGain[i];
+    }
+  }
+
+  /**
+  * Returns the bin of a sample for the current geometry
+  *
+  * @param sample the sample number
+  */
+  unsigned int getBin(unsigned int sample) const { return bins[sample]; }
+
+  /**Forgets the gain curves of every channel*/
+  void clear(){
+    windows.clear();
+  }
+
+private:
+
+  /**
+  * Sums of the samples of one ping in every bin
+  */
+  struct BinSums{
+    /**Sum of the samples of every bin*/
+    std::vector<double> sums;
+
+    /**Number of samples of every bin*/
+    std::vector<uint32_t> counts;
+  };
+
+  /**
+  * Gain curve of a channel over its last pings
+  */
+  struct Window{
+    /**Bin sums of the last pings, the oldest one being at next once the window is full*/
+    std::vector<BinSums> pings;
+
+    /**Position of the next bin sums to replace*/
+    unsigned int next = 0;
+
+    /**Sum of the samples of every bin over the window*/
+    std::vector<double> sums;
+
+    /**Number of samples of every bin over the window*/
+    std::vector<uint64_t> counts;
+  };
+
+  /**
+  * Sets the geometry of the channels to normalize, computing the bin of every sample if it changed
+  *
+  * @param nbSamples the number of samples
+  * @param distancePerSample the ground distance between samples
+  * @param altitude the altitude of the sensor, 0 if unknown
+  */
+  void setGeometry(unsigned int nbSamples,double distancePerSample,double altitude){
+    altitude = (altitude > 0) ? altitude : 0;
+
+    if(nbSamples == this->nbSamples && distancePerSample == this->distancePerSample && altitude == this->altitude) return;
+
+    this->nbSamples = nbSamples;
+    this->distancePerSample = distancePerSample;
+    this->altitude = altitude;
+
+    bins.resize(nbSamples);
+    sampleGains.resize(nbSamples);
+    gains.resize(nbBins);
+
+    for(unsigned int i=0;i<nbSamples;i++){
+      double position;
+
+      if(altitude > 0){
+        //Incidence angle, from 0 at nadir to 90 degrees at the horizon
+        position = std::atan2(i * distancePerSample,altitude) / (M_PI / 2);
+      }
+      else{
+        position = (double)i / nbSamples;
+      }
+
+      bins[i] = std::min((unsigned int)(position * nbBins),nbBins - 1);
+    }
+  }
+
+  /**Number of pings of each channel in the gain curve*/
+  unsigned int windowSize;
+
+  /**Number of bins of the gain curve*/
+  unsigned int nbBins;
+
+  /**Number of samples of the current geometry*/
+  unsigned int nbSamples;
+
+  /**Distance between samples of the current geometry*/
+  double distancePerSample;
+
+  /**Altitude of the current geometry*/
+  double altitude;
+
+  /**Bin of every sample of the current geometry*/
+  std::vector<uint32_t> bins;
+
+  /**Gain of every bin of the current ping*/
+  std::vector<double> gains;
+
+  /**Gain of every sample of the current ping*/
+  std::vector<double> sampleGains;
+
+  /**Gain curve of each channel*/
+  std::map<int,Window> windows;
+
+  /**Samples of the current ping widened to double*/
+  std::vector<double> widened;
+
+  /**Normalized samples of the current ping, as floats*/
+  std::vector<float> narrowed;
+};
+
+#endif
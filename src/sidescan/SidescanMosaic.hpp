@@ -0,0 +1,688 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef SIDESCANMOSAIC_HPP
+#define SIDESCANMOSAIC_HPP
+
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <iostream>
+#include "SidescanPing.hpp"
+#include "SidescanSwath.hpp"
+#include "../gridding/DtmGrid.hpp"
+#include "../utils/ThreadUtils.hpp"
+#include "../utils/Exception.hpp"
+
+/*Rules deciding the value of a mosaic cell covered by several samples*/
+#define MOSAIC_BLEND_MEAN           0   //mean of all the samples
+#define MOSAIC_BLEND_MAXIMUM        1   //brightest sample
+#define MOSAIC_BLEND_LATEST_LINE    2   //mean of the samples of the latest line
+#define MOSAIC_BLEND_NEAREST_NADIR  3   //sample closest to its track beyond the nadir gap, away from the far range
+
+/*Side of a sidescan channel*/
+#define MOSAIC_PORT       -1
+#define MOSAIC_STARBOARD   1
+
+/*!
+* \brief Mosaic cell
+*
+* Samples blended in a cell of a sidescan mosaic
+*/
+struct MosaicCell{
+  /**Sum of the samples kept*/
+  double sum;
+
+  /**Number of samples kept*/
+  uint32_t count;
+
+  /**Priority of the samples kept, with the blend rules that keep the samples of highest priority*/
+  float priority;
+};
+
+/*!
+* \brief Sidescan mosaic class
+*
+* Projects ground range sidescan samples on a tiled raster. Every ping is placed with the position and heading
+* interpolated at its timestamp, and each sample goes across track, to port or starboard, at its ground range.
+*
+* Pings are copied as they are added and rendered in batches: the threads each render a share of the batch in
+* their own tiles, without locking, and the tiles of the threads are merged into the mosaic tile by tile, in
+* parallel. Pings wait in chronological order and are rendered once the navigation goes past the oldest of them,
+* and the navigation older than the oldest ping waiting is dropped, so memory does not depend on the length of the
+* lines, only on the area mosaicked.
+*
+* The samples within the nadir gap, closer to the track than its ground range, are not mosaicked: they hold the
+* water column rather than the seafloor.
+*
+* Positions are in a projected frame in meters, such as the local NED frame (x north, y east), and headings are in
+* degrees clockwise from the x axis.
+*/
+class SidescanMosaic{
+public:
+
+  /**
+  * Creates a sidescan mosaic
+  *
+  * @param cellSize the size of a cell
+  * @param blendRule one of the MOSAIC_BLEND_ rules
+  * @param tileSize the number of cells on a side of a tile
+  * @param nbThreads number of threads, 0 to use all the hardware threads
+  * @param batchSize number of pings rendered together
+  */
+  SidescanMosaic(double cellSize,int blendRule = MOSAIC_BLEND_MEAN,unsigned int tileSize = 256,unsigned int nbThreads = 0,unsigned int batchSize = 256) :
+  cellSize(cellSize),
+  blendRule(blendRule),
+  tileSize(std::max(tileSize,1u)),
+  nbThreads(ThreadUtils::getNbThreads(nbThreads)),
+  batchSize(std::max(batchSize,1u)),
+  nadirGap(0),
+  line(0),
+  lastTimestamp(0),
+  nbRenderedPings(0){
+    if(!(cellSize > 0)){
+      throw new Exception("The cell size of a mosaic must be positive");
+    }
+
+    if(blendRule < MOSAIC_BLEND_MEAN || blendRule > MOSAIC_BLEND_NEAREST_NADIR){
+      throw new Exception("Unknown mosaic blend rule");
+    }
+  }
+
+  /**Destroys the sidescan mosaic*/
+  ~SidescanMosaic(){
+
+  }
+
+  /**
+  * Starts a new line: the pings of the previous line are rendered and its navigation is forgotten. With
+  * MOSAIC_BLEND_LATEST_LINE, the samples of a line cover those of the previous lines.
+  */
+  void startLine(){
+    render(true);
+
+    positions.clear();
+    headings.clear();
+    lastTimestamp = 0;
+
+    line++;
+  }
+
+  /**
+  * Sets the ground range of the nadir gap: the samples closer to the track are not mosaicked
+  *
+  * @param range the ground range, 0 to mosaic every sample
+  */
+  void setNadirGap(double range){
+    nadirGap = std::max(range,0.0);
+  }
+
+  /**Returns the ground range of the nadir gap*/
+  double getNadirGap() const { return nadirGap; }
+
+  /**
+  * Adds a position of the sensor, in chronological order
+  *
+  * @param microEpoch the timestamp
+  * @param x x position
+  * @param y y position
+  */
+  void addPosition(uint64_t microEpoch,double x,double y){
+    if(!positions.empty() && positions.back().timestamp >= microEpoch) return;
+
+    MosaicNavigation position = {microEpoch,x,y};
+    positions.push_back(position);
+  }
+
+  /**
+  * Adds a heading of the sensor, in chronological order. Without headings, the course made good is used.
+  *
+  * @param microEpoch the timestamp
+  * @param heading the heading, in degrees
+  */
+  void addHeading(uint64_t microEpoch,double heading){
+    if(!headings.empty() && headings.back().timestamp >= microEpoch) return;
+
+    MosaicNavigation entry = {microEpoch,heading,0};
+    headings.push_back(entry);
+  }
+
+  /**
+  * Adds a ground range ping, which is copied
+  *
+  * @param ping the ping, whose distance per sample is the ground distance between samples
+  * @param side MOSAIC_PORT or MOSAIC_STARBOARD
+  */
+  void addPing(SidescanPing & ping,int side){
+    if(ping.getNbSamples() == 0 || !(ping.getDistancePerSample() > 0)) return;
+
+    MosaicPing pending;
+    pending.timestamp = ping.getTimestamp();
+    pending.side = (side < 0) ? MOSAIC_PORT : MOSAIC_STARBOARD;
+    pending.distancePerSample = ping.getDistancePerSample();
+    pending.line = line;
+
+    lastTimestamp = std::max(lastTimestamp,pending.timestamp);
+
+    std::vector<double> widened;
+    ping.getSamples(widened);
+    pending.samples.assign(widened.begin(),widened.end());
+
+    //Pings come in chronological order, give or take the channels of a swath
+    auto position = pendingPings.end();
+
+    while(position != pendingPings.begin() && (position - 1)->timestamp > pending.timestamp) position--;
+
+    pendingPings.insert(position,std::move(pending));
+
+    //Pings waiting for navigation are not scanned again until it reaches them
+    if(pendingPings.size() >= batchSize && !positions.empty() && pendingPings.front().timestamp <= getNavigationEnd()){
+      render(false);
+    }
+  }
+
+  /**
+  * Adds the port and starboard channels of a swath, which are copied
+  *
+  * @param swath the swath, in ground range
+  */
+  void addSwath(SidescanSwath & swath){
+    if(swath.getPort()) addPing(*swath.getPort(),MOSAIC_PORT);
+    if(swath.getStarboard()) addPing(*swath.getStarboard(),MOSAIC_STARBOARD);
+  }
+
+  /**Renders the pings still waiting. Pings outside of the navigation are dropped.*/
+  void finish(){
+    render(true);
+  }
+
+  /**
+  * Returns true and the value of the cell containing a position if it is covered. Throws if the position is beyond
+  * the cell indices of the mosaic.
+  *
+  * @param x x position
+  * @param y y position
+  * @param value receives the value
+  */
+  bool getValue(double x,double y,double & value) const {
+    int32_t column = DtmGrid::cellIndex(x,cellSize);
+    int32_t row = DtmGrid::cellIndex(y,cellSize);
+
+    std::unordered_map<uint64_t,MosaicTile>::const_iterator tile = tiles.find(DtmGrid::cellKey(floorDivide(column),floorDivide(row)));
+
+    if(tile == tiles.end()) return false;
+
+    const MosaicCell & cell = tile->second.cells[cellIndex(column,row)];
+
+    if(cell.count == 0) return false;
+
+    value = cell.sum / cell.count;
+    return true;
+  }
+
+  /**Returns the number of tiles*/
+  size_t getNbTiles() const { return tiles.size(); }
+
+  /**Returns the number of pings rendered*/
+  uint64_t getNbRenderedPings() const { return nbRenderedPings; }
+
+  /**Returns the number of pings waiting for navigation*/
+  size_t getNbPendingPings() const { return pendingPings.size(); }
+
+  /**Returns the size of a cell*/
+  double getCellSize() const { return cellSize; }
+
+  /**
+  * Writes one line per covered cell, "x y value", x and y being the center of the cell. Tiles are written row by row.
+  *
+  * @param out the stream to write to
+  */
+  void write(std::ostream & out) const {
+    std::vector<uint64_t> keys;
+
+    for(auto i=tiles.begin();i!=tiles.end();i++){
+      keys.push_back(i->first);
+    }
+
+    std::sort(keys.begin(),keys.end(),[](uint64_t k1,uint64_t k2){
+      return DtmGrid::keyRow(k1) < DtmGrid::keyRow(k2) || (DtmGrid::keyRow(k1) == DtmGrid::keyRow(k2) && DtmGrid::keyColumn(k1) < DtmGrid::keyColumn(k2));
+    });
+
+    for(auto key=keys.begin();key!=keys.end();key++){
+      const MosaicTile & tile = tiles.find(*key)->second;
+      int64_t firstColumn = (int64_t)DtmGrid::keyColumn(*key) * tileSize;
+      int64_t firstRow = (int64_t)DtmGrid::keyRow(*key) * tileSize;
+
+      for(unsigned int row=0;row<tileSize;row++){
+        for(unsigned int column=0;column<tileSize;column++){
+          const MosaicCell & cell = tile.cells[row * tileSize + column];
+
+          if(cell.count == 0) continue;
+
+          out << (firstColumn + column + 0.5) * cellSize << " " << (firstRow + row + 0.5) * cellSize << " " << cell.sum / cell.count << "\n";
+        }
+      }
+    }
+  }
+
+private:
+
+  /**
+  * A navigation sample: a position, or a heading in x
+  */
+  struct MosaicNavigation{
+    /**Timestamp*/
+    uint64_t timestamp;
+
+    /**x position, or heading*/
+    double x;
+
+    /**y position*/
+    double y;
+  };
+
+  /**
+  * A ping waiting to be rendered
+  */
+  struct MosaicPing{
+    /**Timestamp*/
+    uint64_t timestamp;
+
+    /**MOSAIC_PORT or MOSAIC_STARBOARD*/
+    int side;
+
+    /**Ground distance between samples*/
+    double distancePerSample;
+
+    /**Line of the ping*/
+    uint32_t line;
+
+    /**Samples*/
+    std::vector<float> samples;
+  };
+
+  /**
+  * A square of tileSize x tileSize cells, row by row
+  */
+  struct MosaicTile{
+    /**Cells*/
+    std::vector<MosaicCell> cells;
+  };
+
+  /**
+  * Renders the pending pings that the navigation covers. Throws if a ping falls beyond the cell indices of the
+  * mosaic, once the other pings of the batch are rendered.
+  *
+  * @param all true to render or drop every pending ping
+  */
+  void render(bool all){
+    if(pendingPings.empty()) return;
+
+    //Pings the navigation goes past, at the front of the chronological queue
+    uint64_t end = getNavigationEnd();
+
+    std::vector<MosaicPing *> batch;
+    Exception * error = NULL;
+
+    if(!positions.empty()){
+      for(auto i=pendingPings.begin();i!=pendingPings.end() && i->timestamp <= end;i++){
+        batch.push_back(&(*i));
+      }
+    }
+
+    unsigned int threads = std::min<size_t>(nbThreads,batch.size());
+
+    if(threads > 0){
+      //Each thread renders its share of the pings in its own tiles
+      std::vector<std::unordered_map<uint64_t,MosaicTile> > threadTiles(threads);
+      std::vector<uint64_t> threadRendered(threads,0);
+      std::vector<Exception *> threadErrors(threads,NULL);
+
+      ThreadUtils::runChunks(threads,batch.size(),[&](unsigned int thread,size_t begin,size_t end){
+        for(size_t i=begin;i<end;i++){
+          try{
+            if(renderPing(*batch[i],threadTiles[thread])) threadRendered[thread]++;
+          }
+          catch(Exception * e){
+            //Exceptions cannot leave a thread, the first one is thrown after the batch
+            if(threadErrors[thread]) delete e;
+            else threadErrors[thread] = e;
+          }
+        }
+      });
+
+      for(unsigned int thread=0;thread<threads;thread++){
+        nbRenderedPings += threadRendered[thread];
+      }
+
+      merge(threadTiles);
+
+      for(unsigned int thread=0;thread<threads;thread++){
+        if(threadErrors[thread] && !error) error = threadErrors[thread];
+        else if(threadErrors[thread]) delete threadErrors[thread];
+      }
+    }
+
+    if(all){
+      pendingPings.clear();
+    }
+    else{
+      pendingPings.erase(pendingPings.begin(),pendingPings.begin() + batch.size());
+    }
+
+    dropNavigation();
+
+    if(error) throw error;
+  }
+
+  /**Returns the timestamp up to which positions, and headings if any, are known*/
+  uint64_t getNavigationEnd() const {
+    uint64_t end = positions.empty() ? 0 : positions.back().timestamp;
+
+    if(!headings.empty()) end = std::min(end,headings.back().timestamp);
+
+    return end;
+  }
+
+  /**Drops the navigation older than the pings still to come, keeping one sample before them*/
+  void dropNavigation(){
+    //Pings come in chronological order, after the last one added
+    uint64_t oldest = pendingPings.empty() ? lastTimestamp : std::min(lastTimestamp,pendingPings.front().timestamp);
+
+    while(positions.size() > 2 && positions[1].timestamp <= oldest) positions.pop_front();
+    while(headings.size() > 2 && headings[1].timestamp <= oldest) headings.pop_front();
+  }
+
+  /**
+  * Renders a ping in tiles. Returns false if the navigation does not cover it or is not finite. Throws if a sample
+  * falls beyond the cell indices of the mosaic.
+  *
+  * @param ping the ping
+  * @param target the tiles
+  */
+  bool renderPing(const MosaicPing & ping,std::unordered_map<uint64_t,MosaicTile> & target) const {
+    double x,y,heading;
+
+    if(!interpolate(positions,ping.timestamp,x,y)) return false;
+
+    if(headings.empty()){
+      if(!getCourse(ping.timestamp,heading)) return false;
+    }
+    else{
+      double unused;
+      if(!interpolate(headings,ping.timestamp,heading,unused,true)) return false;
+    }
+
+    if(!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(heading)) return false;
+
+    //Starboard is 90 degrees clockwise from the heading
+    double radians = heading * M_PI / 180;
+    double acrossX = -std::sin(radians) * ping.side;
+    double acrossY = std::cos(radians) * ping.side;
+
+    uint64_t lastKey = 0;
+    MosaicTile * tile = NULL;
+
+    //First sample beyond the nadir gap
+    unsigned int first = (unsigned int)std::min<double>(std::ceil(nadirGap / ping.distancePerSample),ping.samples.size());
+
+    for(unsigned int i=first;i<ping.samples.size();i++){
+      double distance = i * ping.distancePerSample;
+      int32_t column = DtmGrid::cellIndex(x + distance * acrossX,cellSize);
+      int32_t row = DtmGrid::cellIndex(y + distance * acrossY,cellSize);
+
+      uint64_t key = DtmGrid::cellKey(floorDivide(column),floorDivide(row));
+
+      if(tile == NULL || key != lastKey){
+        tile = &getTile(target,key);
+        lastKey = key;
+      }
+
+      float priority = 0;
+
+      if(blendRule == MOSAIC_BLEND_LATEST_LINE) priority = ping.line;
+      else if(blendRule == MOSAIC_BLEND_NEAREST_NADIR) priority = -distance;
+
+      blend(tile->cells[cellIndex(column,row)],ping.samples[i],1,priority);
+    }
+
+    return true;
+  }
+
+  /**
+  * Blends samples in a cell according to the blend rule
+  *
+  * @param cell the cell
+  * @param sum the sum of the samples
+  * @param count the number of samples
+  * @param priority the priority of the samples
+  */
+  void blend(MosaicCell & cell,double sum,uint32_t count,float priority) const {
+    if(count == 0) return;
+
+    if(cell.count == 0){
+      cell.sum = sum;
+      cell.count = count;
+      cell.priority = priority;
+      return;
+    }
+
+    switch(blendRule){
+      case MOSAIC_BLEND_MAXIMUM:
+        if(sum / count > cell.sum / cell.count){
+          cell.sum = sum;
+          cell.count = count;
+        }
+      break;
+
+      case MOSAIC_BLEND_LATEST_LINE:
+      case MOSAIC_BLEND_NEAREST_NADIR:
+        if(priority > cell.priority){
+          cell.sum = sum;
+          cell.count = count;
+          cell.priority = priority;
+        }
+        else if(priority == cell.priority){
+          cell.sum += sum;
+          cell.count += count;
+        }
+      break;
+
+      default:
+        cell.sum += sum;
+        cell.count += count;
+      break;
+    }
+  }
+
+  /**
+  * Merges the tiles rendered by the threads into the mosaic, in parallel over the tiles
+  *
+  * @param threadTiles the tiles of every thread
+  */
+  void merge(std::vector<std::unordered_map<uint64_t,MosaicTile> > & threadTiles){
+    std::vector<uint64_t> keys;
+
+    for(auto i=threadTiles.begin();i!=threadTiles.end();i++){
+      for(auto j=i->begin();j!=i->end();j++){
+        keys.push_back(j->first);
+      }
+    }
+
+    std::sort(keys.begin(),keys.end());
+    keys.erase(std::unique(keys.begin(),keys.end()),keys.end());
+
+    //Tiles are created before the threads only read the map
+    std::vector<MosaicTile *> targets(keys.size());
+
+    for(size_t i=0;i<keys.size();i++){
+      targets[i] = &getTile(tiles,keys[i]);
+    }
+
+    unsigned int threads = std::min<size_t>(nbThreads,keys.size());
+
+    ThreadUtils::runChunks(threads,keys.size(),[&](unsigned int thread,size_t begin,size_t end){
+      for(size_t i=begin;i<end;i++){
+        for(auto source=threadTiles.begin();source!=threadTiles.end();source++){
+          std::unordered_map<uint64_t,MosaicTile>::const_iterator tile = source->find(keys[i]);
+
+          if(tile == source->end()) continue;
+
+          for(size_t cell=0;cell<tile->second.cells.size();cell++){
+            const MosaicCell & from = tile->second.cells[cell];
+            blend(targets[i]->cells[cell],from.sum,from.count,from.priority);
+          }
+        }
+      }
+    });
+  }
+
+  /**
+  * Returns a tile of a map, created empty if needed
+  *
+  * @param target the map
+  * @param key the key of the tile
+  */
+  MosaicTile & getTile(std::unordered_map<uint64_t,MosaicTile> & target,uint64_t key) const {
+    MosaicTile & tile = target[key];
+
+    if(tile.cells.empty()){
+      MosaicCell empty = {0,0,0};
+      tile.cells.assign(tileSize * tileSize,empty);
+    }
+
+    return tile;
+  }
+
+  /**
+  * Interpolates navigation at a timestamp. Returns false if the navigation does not cover it.
+  *
+  * @param navigation the navigation
+  * @param timestamp the timestamp
+  * @param x receives the interpolated x
+  * @param y receives the interpolated y
+  * @param angle true if x is an angle in degrees
+  */
+  static bool interpolate(const std::deque<MosaicNavigation> & navigation,uint64_t timestamp,double & x,double & y,bool angle = false){
+    if(navigation.empty() || timestamp < navigation.front().timestamp || timestamp > navigation.back().timestamp) return false;
+
+    MosaicNavigation key = {timestamp,0,0};
+    std::deque<MosaicNavigation>::const_iterator after = std::lower_bound(navigation.begin(),navigation.end(),key,[](const MosaicNavigation & a,const MosaicNavigation & b){
+      return a.timestamp < b.timestamp;
+    });
+
+    if(after->timestamp == timestamp || after == navigation.begin()){
+      x = after->x;
+      y = after->y;
+      return true;
+    }
+
+    const MosaicNavigation & before = *(after - 1);
+    double ratio = (double)(timestamp - before.timestamp) / (double)(after->timestamp - before.timestamp);
+
+    double dx = after->x - before.x;
+
+    if(angle){
+      //Shortest way around the circle
+      dx = std::fmod(dx + 540.0,360.0) - 180.0;
+    }
+
+    x = before.x + ratio * dx;
+    y = before.y + ratio * (after->y - before.y);
+
+    return true;
+  }
+
+  /**
+  * Computes the course made good at a timestamp, from the positions around it. Returns false if there are none.
+  *
+  * @param timestamp the timestamp
+  * @param heading receives the course, in degrees
+  */
+  bool getCourse(uint64_t timestamp,double & heading) const {
+    if(positions.size() < 2) return false;
+
+    MosaicNavigation key = {timestamp,0,0};
+    std::deque<MosaicNavigation>::const_iterator after = std::upper_bound(positions.begin(),positions.end(),key,[](const MosaicNavigation & a,const MosaicNavigation & b){
+      return a.timestamp < b.timestamp;
+    });
+
+    if(after == positions.end()) after--;
+    if(after == positions.begin()) after++;
+
+    const MosaicNavigation & before = *(after - 1);
+
+    heading = std::atan2(after->y - before.y,after->x - before.x) * 180 / M_PI;
+
+    return true;
+  }
+
+  /**
+  * Returns the tile column or row of a cell column or row
+  *
+  * @param index the cell column or row
+  */
+  int32_t floorDivide(int32_t index) const {
+    //In 64 bits, as the opposite of the lowest index does not fit 32 bits
+    int64_t wide = index;
+    int64_t size = tileSize;
+    return (int32_t)((wide >= 0) ? wide / size : -((-wide + size - 1) / size));
+  }
+
+  /**
+  * Returns the position of a cell in its tile
+  *
+  * @param column the cell column
+  * @param row the cell row
+  */
+  size_t cellIndex(int32_t column,int32_t row) const {
+    int64_t size = tileSize;
+    return (size_t)(row - floorDivide(row) * size) * tileSize + (size_t)(column - floorDivide(column) * size);
+  }
+
+  /**Size of a cell*/
+  double cellSize;
+
+  /**Blend rule*/
+  int blendRule;
+
+  /**Number of cells on a side of a tile*/
+  unsigned int tileSize;
+
+  /**Number of threads*/
+  unsigned int nbThreads;
+
+  /**Number of pings rendered together*/
+  unsigned int batchSize;
+
+  /**Ground range of the nadir gap*/
+  double nadirGap;
+
+  /**Current line*/
+  uint32_t line;
+
+  /**Timestamp of the latest ping added*/
+  uint64_t lastTimestamp;
+
+  /**Number of pings rendered*/
+  uint64_t nbRenderedPings;
+
+  /**Positions still needed, in chronological order*/
+  std::deque<MosaicNavigation> positions;
+
+  /**Headings still needed, in chronological order, in x*/
+  std::deque<MosaicNavigation> headings;
+
+  /**Pings waiting to be rendered, in chronological order*/
+  std::deque<MosaicPing> pendingPings;
+
+  /**Tiles of the mosaic*/
+  std::unordered_map<uint64_t,MosaicTile> tiles;
+};
+
+#endif
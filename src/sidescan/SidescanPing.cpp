@@ -9,14 +9,178 @@
  */
 
 #include "SidescanPing.hpp"
+#include "SidescanPingPool.hpp"
 
-SidescanPing::SidescanPing() : position(NULL) {
+/**
+ * Converts a sample to an integer type, rounding and clamping it
+ *
+ * @param sample the sample
+ */
+template<typename T>
+static T toIntegerSample(double sample){
+    if(!(sample > 0)) return 0;
+    if(sample >= (double)std::numeric_limits<T>::max()) return std::numeric_limits<T>::max();
+    return (T)std::floor(sample + 0.5);
+}
+
+/**
+ * Widens samples stored in a type to double
+ *
+ * @param data the samples
+ * @param nbSamples the number of samples
+ * @param s receives the samples
+ */
+template<typename T>
+static void widenSamples(const uint8_t * data,unsigned int nbSamples,double * s){
+    const T * typed = (const T *)data;
+
+    for(unsigned int i=0;i<nbSamples;i++){
+        s[i] = typed[i];
+    }
+}
+
+SidescanPing::SidescanPing() :
+    sampleType(SIDESCAN_SAMPLE_DOUBLE),
+    distancePerSample(0),
+    channelNumber(0),
+    timestamp(0),
+    position(0,0,0,0),
+    hasPosition(false),
+    pool(NULL),
+    inUse(false),
+    previousUsed(NULL),
+    nextUsed(NULL) {
 }
 
-SidescanPing::SidescanPing(const SidescanPing& orig) {
+SidescanPing::SidescanPing(const SidescanPing& orig) :
+    samples(orig.samples),
+    sampleType(orig.sampleType),
+    distancePerSample(orig.distancePerSample),
+    channelNumber(orig.channelNumber),
+    timestamp(orig.timestamp),
+    position(orig.position),
+    hasPosition(orig.hasPosition),
+    pool(NULL),
+    inUse(false),
+    previousUsed(NULL),
+    nextUsed(NULL) {
 }
 
 SidescanPing::~SidescanPing() {
-    if(position) delete position;
+    if(pool){
+        pool->forget(this);
+    }
+}
+
+SidescanPing & SidescanPing::operator=(const SidescanPing & orig){
+    if(this != &orig){
+        samples = orig.samples;
+        sampleType = orig.sampleType;
+        distancePerSample = orig.distancePerSample;
+        channelNumber = orig.channelNumber;
+        timestamp = orig.timestamp;
+        position = orig.position;
+        hasPosition = orig.hasPosition;
+    }
+
+    return *this;
+}
+
+void SidescanPing::reset(){
+    samples.clear();
+    sampleType = SIDESCAN_SAMPLE_DOUBLE;
+    distancePerSample = 0;
+    channelNumber = 0;
+    timestamp = 0;
+    hasPosition = false;
 }
 
+void SidescanPing::release(){
+    if(pool){
+        pool->release(this);
+    }
+    else{
+        delete this;
+    }
+}
+
+void SidescanPing::setSamples(std::vector<double> & s){
+    unsigned int nbSamples = s.size();
+
+    samples.resize(nbSamples * getSampleSize(sampleType));
+
+    if(nbSamples == 0) return;
+
+    switch(sampleType){
+        case SIDESCAN_SAMPLE_UINT8:{
+            uint8_t * typed = (uint8_t *)&samples[0];
+            for(unsigned int i=0;i<nbSamples;i++) typed[i] = toIntegerSample<uint8_t>(s[i]);
+            break;
+        }
+        case SIDESCAN_SAMPLE_UINT16:{
+            uint16_t * typed = (uint16_t *)&samples[0];
+            for(unsigned int i=0;i<nbSamples;i++) typed[i] = toIntegerSample<uint16_t>(s[i]);
+            break;
+        }
+        case SIDESCAN_SAMPLE_UINT32:{
+            uint32_t * typed = (uint32_t *)&samples[0];
+            for(unsigned int i=0;i<nbSamples;i++) typed[i] = toIntegerSample<uint32_t>(s[i]);
+            break;
+        }
+        case SIDESCAN_SAMPLE_FLOAT:{
+            float * typed = (float *)&samples[0];
+            for(unsigned int i=0;i<nbSamples;i++) typed[i] = (float)s[i];
+            break;
+        }
+        default:
+            memcpy(&samples[0],&s[0],nbSamples * sizeof(double));
+            break;
+    }
+}
+
+void SidescanPing::getSamples(std::vector<double> & s) const{
+    unsigned int nbSamples = getNbSamples();
+
+    s.resize(nbSamples);
+
+    if(nbSamples == 0) return;
+
+    switch(sampleType){
+        case SIDESCAN_SAMPLE_UINT8:  widenSamples<uint8_t>(&samples[0],nbSamples,&s[0]);  break;
+        case SIDESCAN_SAMPLE_UINT16: widenSamples<uint16_t>(&samples[0],nbSamples,&s[0]); break;
+        case SIDESCAN_SAMPLE_UINT32: widenSamples<uint32_t>(&samples[0],nbSamples,&s[0]); break;
+        case SIDESCAN_SAMPLE_FLOAT:  widenSamples<float>(&samples[0],nbSamples,&s[0]);    break;
+        default:                     widenSamples<double>(&samples[0],nbSamples,&s[0]);   break;
+    }
+}
+
+double SidescanPing::getSample(unsigned int i) const{
+    switch(sampleType){
+        case SIDESCAN_SAMPLE_UINT8:  return ((const uint8_t *)&samples[0])[i];
+        case SIDESCAN_SAMPLE_UINT16: return ((const uint16_t *)&samples[0])[i];
+        case SIDESCAN_SAMPLE_UINT32: return ((const uint32_t *)&samples[0])[i];
+        case SIDESCAN_SAMPLE_FLOAT:  return ((const float *)&samples[0])[i];
+        default:                     return ((const double *)&samples[0])[i];
+    }
+}
+
+void SidescanPing::setSampleType(int type){
+    if(type == sampleType) return;
+
+    std::vector<double> widened;
+    getSamples(widened);
+
+    sampleType = (getSampleSize(type) > 0) ? type : SIDESCAN_SAMPLE_DOUBLE;
+    setSamples(widened);
+}
+
+unsigned int SidescanPing::getSampleSize(int type){
+    switch(type){
+        case SIDESCAN_SAMPLE_UINT8:  return 1;
+        case SIDESCAN_SAMPLE_UINT16: return 2;
+        case SIDESCAN_SAMPLE_UINT32: return 4;
+        case SIDESCAN_SAMPLE_FLOAT:  return 4;
+        case SIDESCAN_SAMPLE_DOUBLE: return 8;
+        default:                     return 0;
+    }
+}
@@ -14,42 +14,184 @@
 
 #include <vector>
 #include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <limits>
 #include "../Position.hpp"
 
+/*Types in which the samples of a sidescan ping can be stored*/
+#define SIDESCAN_SAMPLE_UINT8   1
+#define SIDESCAN_SAMPLE_UINT16  2
+#define SIDESCAN_SAMPLE_UINT32  3
+#define SIDESCAN_SAMPLE_FLOAT   4
+#define SIDESCAN_SAMPLE_DOUBLE  5
 
+class SidescanPingPool;
+
+/*!
+ * \brief Sidescan ping class
+ *
+ * Samples of a sidescan channel for one ping. The samples are kept in a single type, which parsers set to the type
+ * of the sonar: 8 and 16 bit samples then take 8 and 4 times less memory than doubles. They are widened to double
+ * on demand.
+ *
+ * A ping given to a DatagramEventHandler must be handed back with release() once the handler is done with it.
+ * Deleting it also works, at the cost of the recycling of its memory.
+ */
 class SidescanPing {
 public:
     SidescanPing();
     SidescanPing(const SidescanPing& orig);
     ~SidescanPing();
+
+    /**
+     * Copies the samples and the properties of a ping. The ping stays in its own pool, if any.
+     *
+     * @param orig the ping to copy
+     */
+    SidescanPing & operator=(const SidescanPing & orig);
     
     void setDistancePerSample(double d){distancePerSample = d;};
     double getDistancePerSample(){ return distancePerSample;};
     
     
-    std::vector<double> & getSamples(){ return samples;};
-    
-    void setSamples(std::vector<double> & s){
-        samples = s;
+    /**
+     * Stores samples, converted to the sample type of the ping. Integer types round and clamp the samples.
+     *
+     * @param s the samples
+     */
+    void setSamples(std::vector<double> & s);
+
+    /**
+     * Stores samples in their own type, which becomes the sample type of the ping
+     *
+     * @param s the samples
+     * @param nbSamples the number of samples
+     */
+    template<typename T>
+    void setSamples(const T * s,unsigned int nbSamples){
+        sampleType = getSampleTypeOf<T>();
+        samples.resize(nbSamples * sizeof(T));
+
+        if(nbSamples > 0) memcpy(&samples[0],s,nbSamples * sizeof(T));
     }
-    
+
+    /**
+     * Copies samples stored as bytes in a type, without any alignment, which becomes the sample type of the ping
+     *
+     * @param type one of the SIDESCAN_SAMPLE_ types
+     * @param data the samples
+     * @param nbSamples the number of samples
+     */
+    void copySamples(int type,const unsigned char * data,unsigned int nbSamples){
+        sampleType = (getSampleSize(type) > 0) ? type : SIDESCAN_SAMPLE_DOUBLE;
+        samples.resize(nbSamples * getSampleSize(sampleType));
+
+        if(nbSamples > 0) memcpy(&samples[0],data,samples.size());
+    }
+
+    /**
+     * Returns the samples widened to double
+     *
+     * @param s receives the samples
+     */
+    void getSamples(std::vector<double> & s) const;
+
+    /**
+     * Returns a sample widened to double
+     *
+     * @param i the index of the sample
+     */
+    double getSample(unsigned int i) const;
+
+    /**
+     * Returns the samples in their stored type, or NULL if they are stored in another type
+     */
+    template<typename T>
+    const T * getSamplesAs() const {
+        if(sampleType != getSampleTypeOf<T>() || samples.empty()) return NULL;
+        return (const T *)&samples[0];
+    }
+
+    /**Returns the number of samples*/
+    unsigned int getNbSamples() const { return samples.size() / getSampleSize(sampleType);};
+
+    /**Returns the type in which the samples are stored*/
+    int getSampleType() const { return sampleType;};
+
+    /**
+     * Sets the type in which the next samples given as doubles are stored. The samples already stored are converted.
+     *
+     * @param type one of the SIDESCAN_SAMPLE_ types
+     */
+    void setSampleType(int type);
+
+    /**Returns the memory used by the samples, in bytes*/
+    size_t getSamplesMemorySize() const { return samples.size();};
+
+    /**
+     * Returns the size of a sample of a type, in bytes
+     *
+     * @param type one of the SIDESCAN_SAMPLE_ types
+     */
+    static unsigned int getSampleSize(int type);
+
+    /**Returns the sample type of a C++ type*/
+    template<typename T>
+    static int getSampleTypeOf();
+
     int getChannelNumber(){ return channelNumber;};
     void setChannelNumber(int channel){ channelNumber = channel;};
     
     uint64_t getTimestamp() {return timestamp;};
     void setTimestamp(uint64_t newTimestamp){ timestamp=newTimestamp;};
     
-    Position * getPosition(){ return position;};
-    void       setPosition(Position * newPosition){position=newPosition;};
+    /**Returns the position of the ping, or NULL if it has none*/
+    Position * getPosition(){ return hasPosition ? &position : NULL;};
+
+    /**
+     * Sets the position of the ping, which is copied
+     *
+     * @param newPosition the position
+     */
+    void       setPosition(const Position & newPosition){position=newPosition; hasPosition=true;};
+
+    /**Removes the position of the ping*/
+    void       clearPosition(){ hasPosition=false;};
+
+    /**
+     * Clears the ping so that it can be filled again. The memory of the samples is kept.
+     */
+    void reset();
+
+    /**
+     * Hands the ping back once it is no longer used: it returns to the pool it came from, or is deleted if it was
+     * not taken from a pool. The ping must not be used afterwards.
+     */
+    void release();
     
     
 private:
-    std::vector<double> samples; //we will boil down all the types to double. This is not a pretty hack, but we need to support every sample type
+    std::vector<uint8_t> samples; //the samples, in the sample type, as bytes
+    int         sampleType;
     double      distancePerSample;
     int         channelNumber;
     uint64_t    timestamp;
-    Position *  position;
+    Position    position;
+    bool        hasPosition;
+    SidescanPingPool * pool; //the pool the ping comes from, NULL if none
+    bool        inUse; //true between the acquisition of the ping from its pool and its release
+    SidescanPing * previousUsed; //pings in use of the pool, chained
+    SidescanPing * nextUsed;
+
+    friend class SidescanPingPool;
 };
 
+template<> inline int SidescanPing::getSampleTypeOf<uint8_t>(){ return SIDESCAN_SAMPLE_UINT8;}
+template<> inline int SidescanPing::getSampleTypeOf<uint16_t>(){ return SIDESCAN_SAMPLE_UINT16;}
+template<> inline int SidescanPing::getSampleTypeOf<uint32_t>(){ return SIDESCAN_SAMPLE_UINT32;}
+template<> inline int SidescanPing::getSampleTypeOf<float>(){ return SIDESCAN_SAMPLE_FLOAT;}
+template<> inline int SidescanPing::getSampleTypeOf<double>(){ return SIDESCAN_SAMPLE_DOUBLE;}
+
 #endif /* SIDESCANPING_HPP */
 
@@ -0,0 +1,182 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef SIDESCANPINGPOOL_HPP
+#define SIDESCANPINGPOOL_HPP
+
+#include <vector>
+#include <mutex>
+#include "SidescanPing.hpp"
+
+/*!
+* \brief Sidescan ping pool class
+*
+* Recycles sidescan pings. A parser acquires a ping for every channel packet, and the handler releases it with
+* SidescanPing::release() once it is done with it. Released pings keep the memory of their samples, so decoding a
+* long file reuses the same few pings and buffers instead of allocating them packet after packet.
+* Pings can be released from any thread. Pings still in use when the pool is destroyed are deleted when released.
+*
+* The pings in use are chained through the pings themselves, so acquiring and releasing a ping take constant time
+* whatever the number of pings a handler keeps. A handler that deletes a ping instead of releasing it unchains it
+* from its pool.
+*/
+class SidescanPingPool{
+public:
+
+  /**
+  * Creates a sidescan ping pool
+  *
+  * @param maxFreePings the largest number of released pings kept for reuse, the others are deleted
+  */
+  SidescanPingPool(unsigned int maxFreePings = 256) : maxFreePings(maxFreePings), nbAllocated(0), nbUsed(0), firstUsed(NULL){
+
+  }
+
+  /**Destroys the pool and its free pings, and detaches the pings in use*/
+  ~SidescanPingPool(){
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for(auto i=freePings.begin();i!=freePings.end();i++){
+      (*i)->pool = NULL;
+      delete *i;
+    }
+
+    SidescanPing * ping = firstUsed;
+
+    while(ping){
+      SidescanPing * next = ping->nextUsed;
+
+      ping->pool = NULL;
+      ping->inUse = false;
+      ping->previousUsed = NULL;
+      ping->nextUsed = NULL;
+
+      ping = next;
+    }
+  }
+
+  /**Returns an empty ping, recycled if one is free*/
+  SidescanPing * acquire(){
+    std::lock_guard<std::mutex> lock(mutex);
+
+    SidescanPing * ping;
+
+    if(freePings.empty()){
+      ping = new SidescanPing();
+      ping->pool = this;
+      nbAllocated++;
+    }
+    else{
+      ping = freePings.back();
+      freePings.pop_back();
+    }
+
+    ping->inUse = true;
+    ping->previousUsed = NULL;
+    ping->nextUsed = firstUsed;
+
+    if(firstUsed) firstUsed->previousUsed = ping;
+
+    firstUsed = ping;
+    nbUsed++;
+
+    return ping;
+  }
+
+  /**
+  * Takes back a ping. Call SidescanPing::release() instead, which also handles pings that do not come from a pool.
+  *
+  * @param ping the ping
+  */
+  void release(SidescanPing * ping){
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if(ping->pool != this || !ping->inUse) return;
+
+    unchain(ping);
+
+    if(freePings.size() < maxFreePings){
+      ping->reset();
+      freePings.push_back(ping);
+    }
+    else{
+      nbAllocated--;
+      ping->pool = NULL;
+      delete ping;
+    }
+  }
+
+  /**Returns the number of pings owned by the pool, in use or free*/
+  unsigned int getNbAllocated(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return nbAllocated;
+  }
+
+  /**Returns the number of pings in use*/
+  unsigned int getNbUsed(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return nbUsed;
+  }
+
+  /**Returns the number of free pings*/
+  unsigned int getNbFree(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return freePings.size();
+  }
+
+private:
+
+  /**
+  * Forgets a ping in use that is being deleted without being released
+  *
+  * @param ping the ping
+  */
+  void forget(SidescanPing * ping){
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if(!ping->inUse) return;
+
+    unchain(ping);
+    nbAllocated--;
+  }
+
+  /**
+  * Removes a ping from the pings in use. The mutex must be held.
+  *
+  * @param ping the ping
+  */
+  void unchain(SidescanPing * ping){
+    if(ping->previousUsed) ping->previousUsed->nextUsed = ping->nextUsed;
+    else firstUsed = ping->nextUsed;
+
+    if(ping->nextUsed) ping->nextUsed->previousUsed = ping->previousUsed;
+
+    ping->previousUsed = NULL;
+    ping->nextUsed = NULL;
+    ping->inUse = false;
+    nbUsed--;
+  }
+
+  /**Largest number of free pings kept*/
+  unsigned int maxFreePings;
+
+  /**Number of pings owned by the pool*/
+  unsigned int nbAllocated;
+
+  /**Number of pings acquired and not yet released*/
+  unsigned int nbUsed;
+
+  /**Last ping acquired and not yet released, chained to the others*/
+  SidescanPing * firstUsed;
+
+  /**Pings released, ready to be reused*/
+  std::vector<SidescanPing *> freePings;
+
+  /**Protects the pings*/
+  std::mutex mutex;
+
+  friend class SidescanPing;
+};
+
+#endif
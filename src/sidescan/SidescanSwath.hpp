@@ -0,0 +1,130 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef SIDESCANSWATH_HPP
+#define SIDESCANSWATH_HPP
+
+#include <vector>
+#include <cstdint>
+#include "SidescanPing.hpp"
+#include "../Position.hpp"
+
+/*Side of the channels of a sidescan swath*/
+#define SIDESCAN_SIDE_OTHER       0
+#define SIDESCAN_SIDE_PORT        1
+#define SIDESCAN_SIDE_STARBOARD   2
+
+/*!
+* \brief Sidescan swath class
+*
+* The channels of one ping of a sidescan sonar, with their port and starboard channels paired. The channels share
+* the timestamp, the position and the altitude of the ping, so handlers use them without matching channels by time.
+*
+* The swath owns its pings: deleting it releases the pings it still holds. A handler that keeps a ping takes it
+* from the swath with takePings() and releases it itself.
+*/
+class SidescanSwath{
+public:
+
+  /**
+  * Creates an empty sidescan swath
+  *
+  * @param timestamp the timestamp of the ping
+  * @param altitude the altitude of the sensor above the seafloor, 0 if unknown
+  */
+  SidescanSwath(uint64_t timestamp = 0,double altitude = 0) :
+  timestamp(timestamp),
+  altitude(altitude),
+  port(NULL),
+  starboard(NULL),
+  position(0,0,0,0),
+  hasPosition(false){
+
+  }
+
+  /**Destroys the sidescan swath and releases its pings*/
+  ~SidescanSwath(){
+    for(auto i=pings.begin();i!=pings.end();i++){
+      (*i)->release();
+    }
+  }
+
+  /**
+  * Adds a channel. The first port and the first starboard channels become the paired channels.
+  *
+  * @param ping the channel, owned by the swath
+  * @param side SIDESCAN_SIDE_PORT, SIDESCAN_SIDE_STARBOARD or SIDESCAN_SIDE_OTHER
+  */
+  void addPing(SidescanPing * ping,int side){
+    pings.push_back(ping);
+
+    if(side == SIDESCAN_SIDE_PORT && port == NULL) port = ping;
+    else if(side == SIDESCAN_SIDE_STARBOARD && starboard == NULL) starboard = ping;
+  }
+
+  /**Returns the port channel, NULL if there is none*/
+  SidescanPing * getPort(){ return port; }
+
+  /**Returns the starboard channel, NULL if there is none*/
+  SidescanPing * getStarboard(){ return starboard; }
+
+  /**Returns every channel, in the order they were added*/
+  const std::vector<SidescanPing *> & getPings() const { return pings; }
+
+  /**
+  * Hands the channels over to the caller, who releases them, and empties the swath
+  *
+  * @param taken receives the channels after its own, in the order they were added
+  */
+  void takePings(std::vector<SidescanPing *> & taken){
+    taken.insert(taken.end(),pings.begin(),pings.end());
+    pings.clear();
+    port = NULL;
+    starboard = NULL;
+  }
+
+  /**Returns the timestamp of the ping*/
+  uint64_t getTimestamp() const { return timestamp; }
+
+  /**Returns the altitude of the sensor above the seafloor, 0 if unknown*/
+  double getAltitude() const { return altitude; }
+
+  /**
+  * Sets the position of the ping
+  *
+  * @param p the position
+  */
+  void setPosition(const Position & p){
+    position = p;
+    hasPosition = true;
+  }
+
+  /**Returns the position of the ping, NULL if it has none*/
+  Position * getPosition(){ return hasPosition ? &position : NULL; }
+
+private:
+
+  /**Timestamp of the ping*/
+  uint64_t timestamp;
+
+  /**Altitude of the sensor*/
+  double altitude;
+
+  /**Port channel*/
+  SidescanPing * port;
+
+  /**Starboard channel*/
+  SidescanPing * starboard;
+
+  /**Every channel*/
+  std::vector<SidescanPing *> pings;
+
+  /**Position of the ping*/
+  Position position;
+
+  /**True if the ping has a position*/
+  bool hasPosition;
+};
+
+#endif
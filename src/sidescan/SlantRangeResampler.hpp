@@ -0,0 +1,197 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef SLANTRANGERESAMPLER_HPP
+#define SLANTRANGERESAMPLER_HPP
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include "SidescanPing.hpp"
+#include "../utils/ThreadUtils.hpp"
+#include "../utils/Exception.hpp"
+
+/*!
+* \brief Slant range resampler class
+*
+* Converts sidescan samples from slant range to ground range over a flat seafloor, the sensor being at a known
+* altitude. Instead of moving every slant range sample to its ground range bin, each ground range bin fetches its
+* value: the bin at ground range g reads the slant range sqrt(g^2 + altitude^2), interpolated between the two
+* closest samples. Every bin is filled, and the water column is dropped.
+*
+* The position and weight of the samples read by every bin depend only on the geometry of the channel, so they are
+* computed once and reused while the geometry does not change. Resampling a channel is then a loop of loads and
+* multiplications without branches, which the compiler vectorizes.
+*/
+class SlantRangeResampler{
+public:
+
+  /**Creates a slant range resampler*/
+  SlantRangeResampler() : nbSlantSamples(0), slantRange(0), altitude(0){
+
+  }
+
+  /**Destroys the slant range resampler*/
+  ~SlantRangeResampler(){
+
+  }
+
+  /**
+  * Sets the geometry of the channels to resample. Sample i of a channel is at slant range i * slantRange / nbSamples,
+  * and the ground range bins have the same size.
+  *
+  * @param nbSamples the number of slant range samples
+  * @param slantRange the slant range of the channel
+  * @param altitude the altitude of the sensor above the seafloor, 0 if unknown
+  */
+  void setGeometry(unsigned int nbSamples,double slantRange,double altitude){
+    if(nbSamples == nbSlantSamples && slantRange == this->slantRange && altitude == this->altitude) return;
+
+    if(!(slantRange > 0) || nbSamples == 0){
+      throw new Exception("Slant range resampling needs samples and a positive slant range");
+    }
+
+    nbSlantSamples = nbSamples;
+    this->slantRange = slantRange;
+    this->altitude = (altitude > 0) ? altitude : 0;
+
+    indices.clear();
+    weights.clear();
+
+    double distancePerSample = slantRange / nbSamples;
+    double lastRange = (nbSamples - 1) * distancePerSample;
+
+    if(this->altitude > lastRange) return;
+
+    unsigned int nbGroundSamples = (unsigned int)std::floor(std::sqrt(lastRange * lastRange - this->altitude * this->altitude) / distancePerSample) + 1;
+    unsigned int lastIndex = (nbSamples >= 2) ? nbSamples - 2 : 0;
+
+    indices.resize(nbGroundSamples);
+    weights.resize(nbGroundSamples);
+
+    for(unsigned int j=0;j<nbGroundSamples;j++){
+      double groundRange = j * distancePerSample;
+      double position = std::sqrt(groundRange * groundRange + this->altitude * this->altitude) / distancePerSample;
+      unsigned int index = std::min((unsigned int)position,lastIndex);
+
+      indices[j] = index;
+      weights[j] = (nbSamples >= 2) ? std::min(position - index,1.0) : 0;
+    }
+  }
+
+  /**Returns the number of ground range samples, 0 if the seafloor is beyond the slant range*/
+  unsigned int getNbGroundSamples() const { return indices.size(); }
+
+  /**Returns the distance between ground range samples*/
+  double getDistancePerSample() const { return (nbSlantSamples > 0) ? slantRange / nbSlantSamples : 0; }
+
+  /**
+  * Resamples a channel with the current geometry
+  *
+  * @param slant the slant range samples, as many as set with setGeometry()
+  * @param ground receives the ground range samples, with room for getNbGroundSamples()
+  */
+  template<typename T>
+  void resample(const T * slant,double * ground) const {
+    unsigned int nbGroundSamples = indices.size();
+    const uint32_t * index = indices.data();
+    const double * weight = weights.data();
+
+    //With a single sample, the weights are 0 and the second read stays in the channel
+    unsigned int next = (nbSlantSamples >= 2) ? 1 : 0;
+
+    for(unsigned int j=0;j<nbGroundSamples;j++){
+      double first = slant[index[j]];
+      double second = slant[index[j] + next];
+      ground[j] = first + weight[j] * (second - first);
+    }
+  }
+
+  /**
+  * Resamples a channel
+  *
+  * @param slant the slant range samples
+  * @param slantRange the slant range of the channel
+  * @param altitude the altitude of the sensor above the seafloor
+  * @param ground receives the ground range samples
+  */
+  void resample(const std::vector<double> & slant,double slantRange,double altitude,std::vector<double> & ground){
+    setGeometry(slant.size(),slantRange,altitude);
+    ground.resize(getNbGroundSamples());
+
+    if(!ground.empty()) resample(slant.data(),ground.data());
+  }
+
+  /**
+  * Resamples a ping in place: its samples become ground range samples, in the same sample type.
+  * Pings without samples or without a distance per sample are left as they are.
+  *
+  * @param ping the ping, whose distance per sample gives its slant range
+  * @param altitude the altitude of the sensor above the seafloor
+  */
+  void resample(SidescanPing & ping,double altitude){
+    unsigned int nbSamples = ping.getNbSamples();
+
+    if(nbSamples == 0 || !(ping.getDistancePerSample() > 0)) return;
+
+    setGeometry(nbSamples,ping.getDistancePerSample() * nbSamples,altitude);
+
+    std::vector<double> ground(getNbGroundSamples());
+
+    if(!ground.empty()){
+      switch(ping.getSampleType()){
+        case SIDESCAN_SAMPLE_UINT8:  resample(ping.getSamplesAs<uint8_t>(),ground.data());  break;
+        case SIDESCAN_SAMPLE_UINT16: resample(ping.getSamplesAs<uint16_t>(),ground.data()); break;
+        case SIDESCAN_SAMPLE_UINT32: resample(ping.getSamplesAs<uint32_t>(),ground.data()); break;
+        case SIDESCAN_SAMPLE_FLOAT:  resample(ping.getSamplesAs<float>(),ground.data());    break;
+        default:                     resample(ping.getSamplesAs<double>(),ground.data());   break;
+      }
+    }
+
+    ping.setSamples(ground);
+  }
+
+  /**
+  * Resamples a batch of pings in place, in parallel. Consecutive pings with the same geometry share their
+  * interpolation table.
+  *
+  * @param pings the pings
+  * @param altitudes the altitude of the sensor for every ping
+  * @param nbThreads number of threads, 0 to use all the hardware threads
+  */
+  static void resample(std::vector<SidescanPing *> & pings,const std::vector<double> & altitudes,unsigned int nbThreads = 0){
+    if(altitudes.size() != pings.size()){
+      throw new Exception("Slant range resampling needs an altitude for every ping");
+    }
+
+    unsigned int threads = std::min<size_t>(ThreadUtils::getNbThreads(nbThreads),pings.size());
+
+    ThreadUtils::runChunks(threads,pings.size(),[&](unsigned int thread,size_t begin,size_t end){
+      SlantRangeResampler resampler;
+
+      for(size_t i=begin;i<end;i++){
+        resampler.resample(*pings[i],altitudes[i]);
+      }
+    });
+  }
+
+private:
+
+  /**Number of slant range samples of the current geometry*/
+  unsigned int nbSlantSamples;
+
+  /**Slant range of the current geometry*/
+  double slantRange;
+
+  /**Altitude of the current geometry*/
+  double altitude;
+
+  /**Position of the first slant range sample read by every ground range sample*/
+  std::vector<uint32_t> indices;
+
+  /**Weight of the second slant range sample read by every ground range sample*/
+  std::vector<double> weights;
+};
+
+#endif
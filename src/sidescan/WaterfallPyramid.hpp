@@ -0,0 +1,557 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef WATERFALLPYRAMID_HPP
+#define WATERFALLPYRAMID_HPP
+
+#include <vector>
+#include <map>
+#include <string>
+#include <fstream>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include "SidescanPing.hpp"
+#include "SidescanSwath.hpp"
+#include "../utils/Exception.hpp"
+
+/*Sides of a waterfall*/
+#define WATERFALL_PORT        0
+#define WATERFALL_STARBOARD   1
+
+/*Identifies a waterfall pyramid file*/
+#define WATERFALL_MAGIC       0x59504657  //"WFPY"
+#define WATERFALL_VERSION     1
+
+/*!
+* \brief Waterfall tile entry
+*
+* Position of a tile in a waterfall pyramid file
+*/
+struct WaterfallTileEntry{
+  /**WATERFALL_PORT or WATERFALL_STARBOARD*/
+  uint32_t side;
+
+  /**Level of the tile, 0 being the finest*/
+  uint32_t level;
+
+  /**Column of the tile, in samples divided by the tile size*/
+  uint32_t column;
+
+  /**Row of the tile, in pings divided by the tile size*/
+  uint32_t row;
+
+  /**Offset of the tile in the file*/
+  uint64_t offset;
+};
+
+/*!
+* \brief Waterfall pyramid class
+*
+* Writes the port and starboard waterfalls of a sidescan line, one row per ping and one column per sample, as a
+* pyramid of square tiles of floats. Level 0 holds the samples, and each level above it halves the number of rows
+* and columns, a pixel being the mean of the four pixels below it. Pixels without samples are NaN.
+*
+* The pyramid is built in one pass as pings are added: each level keeps only the strip of rows of its current row
+* of tiles, writes its tiles once the strip is full, and passes every pair of rows to the level above it. Memory
+* does not depend on the length of the line. The tiles of the last strip of a level only hold the rows it has, so
+* short lines and the coarse levels are not padded to full tiles. The file starts with a header, and ends with the
+* size of every level and an index of the tiles, so a viewer reads the index then seeks to the tiles it shows.
+*/
+class WaterfallPyramid{
+public:
+
+  /**
+  * Creates a waterfall pyramid and opens its file
+  *
+  * @param filename the file to write
+  * @param tileSize number of pixels on a side of a tile
+  * @param nbLevels number of levels, including level 0
+  */
+  WaterfallPyramid(const std::string & filename,unsigned int tileSize = 256,unsigned int nbLevels = 8) :
+  tileSize(std::max(tileSize,1u)),
+  nbLevels(std::max(nbLevels,1u)),
+  closed(false){
+    out.open(filename.c_str(),std::ios::binary | std::ios::trunc);
+
+    if(!out){
+      throw new Exception("Cannot write waterfall pyramid");
+    }
+
+    for(unsigned int side=0;side<2;side++){
+      levels[side].resize(this->nbLevels);
+    }
+
+    //The index offset is written on close
+    writeHeader(0);
+  }
+
+  /**Destroys the waterfall pyramid, closing its file if close() was not called*/
+  ~WaterfallPyramid(){
+    try{
+      close();
+    }
+    catch(Exception * e){
+      delete e;
+    }
+  }
+
+  /**
+  * Adds a ping as the next row of a side
+  *
+  * @param ping the ping
+  * @param side WATERFALL_PORT or WATERFALL_STARBOARD
+  */
+  void add(SidescanPing & ping,int side){
+    ping.getSamples(widened);
+
+    add(widened.data(),widened.size(),side);
+  }
+
+  /**
+  * Adds the port and starboard channels of a swath as the next row of each side. A missing channel adds an empty
+  * row, so the rows of both sides stay aligned.
+  *
+  * @param swath the swath
+  */
+  void add(SidescanSwath & swath){
+    if(swath.getPort()) add(*swath.getPort(),WATERFALL_PORT);
+    else add(NULL,0,WATERFALL_PORT);
+
+    if(swath.getStarboard()) add(*swath.getStarboard(),WATERFALL_STARBOARD);
+    else add(NULL,0,WATERFALL_STARBOARD);
+  }
+
+  /**
+  * Adds samples as the next row of a side
+  *
+  * @param samples the samples
+  * @param nbSamples the number of samples
+  * @param side WATERFALL_PORT or WATERFALL_STARBOARD
+  */
+  void add(const double * samples,unsigned int nbSamples,int side){
+    if(closed){
+      throw new Exception("Waterfall pyramid already closed");
+    }
+
+    std::vector<float> row(samples,samples + nbSamples);
+
+    addRow(checkSide(side),0,row);
+  }
+
+  /**Writes the partial tiles, the levels and the index, and closes the file*/
+  void close(){
+    if(closed) return;
+
+    for(unsigned int side=0;side<2;side++){
+      for(unsigned int level=0;level<nbLevels;level++){
+        Level & current = levels[side][level];
+
+        //An odd last row goes up alone
+        if(current.hasCarry && level + 1 < nbLevels){
+          std::vector<float> coarse;
+          downsample(current.carry,NULL,coarse);
+          current.hasCarry = false;
+          addRow(side,level + 1,coarse);
+        }
+
+        writeStrip(side,level);
+      }
+    }
+
+    uint64_t indexOffset = (uint64_t)out.tellp();
+
+    for(unsigned int side=0;side<2;side++){
+      for(unsigned int level=0;level<nbLevels;level++){
+        write<uint64_t>(levels[side][level].nbRows);
+        write<uint32_t>(levels[side][level].nbColumns);
+      }
+    }
+
+    write<uint64_t>(index.size());
+
+    for(auto i=index.begin();i!=index.end();i++){
+      write<uint32_t>(i->side);
+      write<uint32_t>(i->level);
+      write<uint32_t>(i->column);
+      write<uint32_t>(i->row);
+      write<uint64_t>(i->offset);
+    }
+
+    out.seekp(0);
+    writeHeader(indexOffset);
+    out.close();
+
+    closed = true;
+
+    if(out.fail()){
+      throw new Exception("Cannot write waterfall pyramid");
+    }
+  }
+
+  /**
+  * Returns the number of rows of a level of a side written so far
+  *
+  * @param side WATERFALL_PORT or WATERFALL_STARBOARD
+  * @param level the level
+  */
+  uint64_t getNbRows(int side,unsigned int level) const { return levels[checkSide(side)][level].nbRows; }
+
+  /**Returns the number of tiles written*/
+  size_t getNbTiles() const { return index.size(); }
+
+private:
+
+  /**
+  * A level of the waterfall of one side
+  */
+  struct Level{
+    /**Rows of the current row of tiles*/
+    std::vector<std::vector<float> > strip;
+
+    /**First row of a pair, waiting for the second one*/
+    std::vector<float> carry;
+
+    /**True if carry holds a row*/
+    bool hasCarry = false;
+
+    /**Number of rows added*/
+    uint64_t nbRows = 0;
+
+    /**Number of columns of the widest row*/
+    uint32_t nbColumns = 0;
+  };
+
+  /**
+  * Returns a side, checked
+  *
+  * @param side the side
+  */
+  static int checkSide(int side){
+    if(side != WATERFALL_PORT && side != WATERFALL_STARBOARD){
+      throw new Exception("Unknown waterfall side");
+    }
+
+    return side;
+  }
+
+  /**
+  * Adds a row to a level, and every pair of rows to the level above it
+  *
+  * @param side the side
+  * @param level the level
+  * @param row the row, which is emptied
+  */
+  void addRow(int side,unsigned int level,std::vector<float> & row){
+    Level & current = levels[side][level];
+
+    current.nbRows++;
+    current.nbColumns = std::max<uint32_t>(current.nbColumns,row.size());
+
+    if(level + 1 < nbLevels){
+      if(current.hasCarry){
+        std::vector<float> coarse;
+        downsample(current.carry,&row,coarse);
+        current.hasCarry = false;
+        addRow(side,level + 1,coarse);
+      }
+      else{
+        current.carry = row;
+        current.hasCarry = true;
+      }
+    }
+
+    current.strip.push_back(std::vector<float>());
+    current.strip.back().swap(row);
+
+    if(current.strip.size() == tileSize){
+      writeStrip(side,level);
+    }
+  }
+
+  /**
+  * Averages two rows into a row of half their width, ignoring the NaN pixels
+  *
+  * @param first the first row
+  * @param second the second row, NULL if there is none
+  * @param coarse receives the averaged row
+  */
+  static void downsample(const std::vector<float> & first,const std::vector<float> * second,std::vector<float> & coarse){
+    size_t width = std::max(first.size(),second ? second->size() : 0);
+
+    coarse.assign((width + 1) / 2,std::numeric_limits<float>::quiet_NaN());
+
+    for(size_t j=0;j<coarse.size();j++){
+      double sum = 0;
+      unsigned int count = 0;
+
+      for(size_t k=2 * j;k<2 * j + 2;k++){
+        if(k < first.size() && !std::isnan(first[k])){
+          sum += first[k];
+          count++;
+        }
+
+        if(second && k < second->size() && !std::isnan((*second)[k])){
+          sum += (*second)[k];
+          count++;
+        }
+      }
+
+      if(count > 0) coarse[j] = sum / count;
+    }
+  }
+
+  /**
+  * Writes the tiles of the strip of a level and empties it
+  *
+  * @param side the side
+  * @param level the level
+  */
+  void writeStrip(int side,unsigned int level){
+    Level & current = levels[side][level];
+
+    if(current.strip.empty()) return;
+
+    size_t width = 0;
+
+    for(auto i=current.strip.begin();i!=current.strip.end();i++){
+      width = std::max(width,i->size());
+    }
+
+    uint32_t row = (uint32_t)((current.nbRows - current.strip.size()) / tileSize);
+    uint32_t nbColumns = (uint32_t)((width + tileSize - 1) / tileSize);
+
+    //A partial strip is written with its rows only
+    std::vector<float> tile(current.strip.size() * tileSize);
+
+    for(uint32_t column=0;column<nbColumns;column++){
+      std::fill(tile.begin(),tile.end(),std::numeric_limits<float>::quiet_NaN());
+
+      size_t first = (size_t)column * tileSize;
+
+      for(size_t i=0;i<current.strip.size();i++){
+        const std::vector<float> & pixels = current.strip[i];
+
+        if(pixels.size() > first){
+          size_t count = std::min<size_t>(tileSize,pixels.size() - first);
+          memcpy(&tile[i * tileSize],&pixels[first],count * sizeof(float));
+        }
+      }
+
+      WaterfallTileEntry entry = {(uint32_t)side,level,column,row,(uint64_t)out.tellp()};
+      index.push_back(entry);
+
+      out.write((const char*)tile.data(),tile.size() * sizeof(float));
+    }
+
+    current.strip.clear();
+  }
+
+  /**
+  * Writes the header
+  *
+  * @param indexOffset offset of the index of the tiles
+  */
+  void writeHeader(uint64_t indexOffset){
+    write<uint32_t>(WATERFALL_MAGIC);
+    write<uint32_t>(WATERFALL_VERSION);
+    write<uint32_t>(tileSize);
+    write<uint32_t>(nbLevels);
+    write<uint64_t>(indexOffset);
+  }
+
+  /**
+  * Writes a value
+  *
+  * @param value the value
+  */
+  template<typename T>
+  void write(T value){
+    out.write((const char*)&value,sizeof(T));
+  }
+
+  /**Number of pixels on a side of a tile*/
+  unsigned int tileSize;
+
+  /**Number of levels*/
+  unsigned int nbLevels;
+
+  /**True once the file is closed*/
+  bool closed;
+
+  /**Levels of each side*/
+  std::vector<Level> levels[2];
+
+  /**Tiles written*/
+  std::vector<WaterfallTileEntry> index;
+
+  /**Samples of the current ping widened to double*/
+  std::vector<double> widened;
+
+  /**The file*/
+  std::ofstream out;
+};
+
+/*!
+* \brief Waterfall pyramid reader class
+*
+* Reads the index of a file written by WaterfallPyramid, then reads its tiles on demand
+*/
+class WaterfallPyramidReader{
+public:
+
+  /**
+  * Opens a waterfall pyramid and reads its index
+  *
+  * @param filename the file to read
+  */
+  WaterfallPyramidReader(const std::string & filename){
+    in.open(filename.c_str(),std::ios::binary);
+
+    uint32_t magic = 0,version = 0;
+    uint64_t indexOffset = 0;
+
+    if(!in || !read(magic) || magic != WATERFALL_MAGIC || !read(version) || version != WATERFALL_VERSION){
+      throw new Exception("Not a waterfall pyramid");
+    }
+
+    if(!read(tileSize) || !read(nbLevels) || !read(indexOffset) || indexOffset == 0){
+      throw new Exception("Incomplete waterfall pyramid");
+    }
+
+    in.seekg(indexOffset);
+
+    for(unsigned int side=0;side<2;side++){
+      nbRows[side].resize(nbLevels);
+      nbColumns[side].resize(nbLevels);
+
+      for(unsigned int level=0;level<nbLevels;level++){
+        if(!read(nbRows[side][level]) || !read(nbColumns[side][level])){
+          throw new Exception("Incomplete waterfall pyramid");
+        }
+      }
+    }
+
+    uint64_t nbTiles = 0;
+
+    if(!read(nbTiles)){
+      throw new Exception("Incomplete waterfall pyramid");
+    }
+
+    for(uint64_t i=0;i<nbTiles;i++){
+      WaterfallTileEntry entry;
+
+      if(!read(entry.side) || !read(entry.level) || !read(entry.column) || !read(entry.row) || !read(entry.offset)){
+        throw new Exception("Incomplete waterfall pyramid");
+      }
+
+      tiles[tileKey(entry.side,entry.level,entry.column,entry.row)] = entry.offset;
+    }
+  }
+
+  /**Closes the waterfall pyramid*/
+  ~WaterfallPyramidReader(){
+
+  }
+
+  /**Returns the number of pixels on a side of a tile*/
+  unsigned int getTileSize() const { return tileSize; }
+
+  /**Returns the number of levels*/
+  unsigned int getNbLevels() const { return nbLevels; }
+
+  /**
+  * Returns the number of rows of a level
+  *
+  * @param side WATERFALL_PORT or WATERFALL_STARBOARD
+  * @param level the level
+  */
+  uint64_t getNbRows(int side,unsigned int level) const { return nbRows[side][level]; }
+
+  /**
+  * Returns the number of columns of a level
+  *
+  * @param side WATERFALL_PORT or WATERFALL_STARBOARD
+  * @param level the level
+  */
+  uint32_t getNbColumns(int side,unsigned int level) const { return nbColumns[side][level]; }
+
+  /**
+  * Reads a tile, its pixels being row by row. The rows past the last row of the level are NaN. Returns false if the
+  * tile does not exist.
+  *
+  * @param side WATERFALL_PORT or WATERFALL_STARBOARD
+  * @param level the level
+  * @param column the column of the tile
+  * @param row the row of the tile
+  * @param pixels receives the tileSize x tileSize pixels
+  */
+  bool readTile(int side,unsigned int level,uint32_t column,uint32_t row,std::vector<float> & pixels){
+    std::map<std::pair<uint64_t,uint64_t>,uint64_t>::const_iterator tile = tiles.find(tileKey(side,level,column,row));
+
+    if(tile == tiles.end()) return false;
+
+    //The tiles of the last row of tiles only hold the rows of the level
+    uint64_t firstRow = (uint64_t)row * tileSize;
+    uint64_t rowsWritten = (nbRows[side][level] > firstRow) ? std::min<uint64_t>(tileSize,nbRows[side][level] - firstRow) : 0;
+
+    pixels.assign(tileSize * tileSize,std::numeric_limits<float>::quiet_NaN());
+
+    in.clear();
+    in.seekg(tile->second);
+
+    if(rowsWritten > 0 && !in.read((char*)pixels.data(),rowsWritten * tileSize * sizeof(float))){
+      throw new Exception("Cannot read waterfall tile");
+    }
+
+    return true;
+  }
+
+private:
+
+  /**
+  * Returns the key of a tile in the index
+  *
+  * @param side the side
+  * @param level the level
+  * @param column the column of the tile
+  * @param row the row of the tile
+  */
+  static std::pair<uint64_t,uint64_t> tileKey(uint32_t side,uint32_t level,uint32_t column,uint32_t row){
+    return std::make_pair(((uint64_t)side << 32) | level,((uint64_t)column << 32) | row);
+  }
+
+  /**
+  * Reads a value
+  *
+  * @param value receives the value
+  */
+  template<typename T>
+  bool read(T & value){
+    return (bool)in.read((char*)&value,sizeof(T));
+  }
+
+  /**Number of pixels on a side of a tile*/
+  uint32_t tileSize;
+
+  /**Number of levels*/
+  uint32_t nbLevels;
+
+  /**Number of rows of every level of each side*/
+  std::vector<uint64_t> nbRows[2];
+
+  /**Number of columns of every level of each side*/
+  std::vector<uint32_t> nbColumns[2];
+
+  /**Offset of every tile, by key*/
+  std::map<std::pair<uint64_t,uint64_t>,uint64_t> tiles;
+
+  /**The file*/
+  std::ifstream in;
+};
+
+#endif
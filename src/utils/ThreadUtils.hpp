@@ -0,0 +1,97 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef THREADUTILS_HPP
+#define THREADUTILS_HPP
+
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <algorithm>
+
+/*!
+* \brief Thread utilities class
+*
+* Splits a range of work between threads
+*/
+class ThreadUtils{
+public:
+
+  /**
+  * Returns the number of threads to use
+  *
+  * @param nbThreads the requested number of threads, 0 to use all the hardware threads
+  */
+  static unsigned int getNbThreads(unsigned int nbThreads){
+    return (nbThreads > 0) ? nbThreads : std::max(std::thread::hardware_concurrency(),1u);
+  }
+
+  /**
+  * Runs a function over the chunks of a range, one thread per chunk. Chunks are contiguous and in order.
+  *
+  * @param threads number of chunks
+  * @param n size of the range
+  * @param function called with the chunk number and the bounds of the chunk
+  */
+  template<typename Function>
+  static void runChunks(unsigned int threads,size_t n,Function function){
+    if(threads <= 1){
+      function(0,0,n);
+      return;
+    }
+
+    std::vector<std::thread> workers;
+
+    for(unsigned int i=0;i<threads;i++){
+      workers.push_back(std::thread(function,i,n * i / threads,n * (i + 1) / threads));
+    }
+
+    for(auto i=workers.begin();i!=workers.end();i++){
+      i->join();
+    }
+  }
+
+  /**
+  * Finds the indices of a range that satisfy a predicate, testing chunks of the range in parallel
+  *
+  * @param threads number of chunks
+  * @param n size of the range
+  * @param predicate called with an index, returns true to keep it
+  * @param indices receives the kept indices, in increasing order
+  */
+  template<typename Predicate>
+  static void selectIndices(unsigned int threads,size_t n,Predicate predicate,std::vector<uint64_t> & indices){
+    indices.clear();
+
+    if(threads <= 1){
+      for(size_t i=0;i<n;i++){
+        if(predicate(i)) indices.push_back(i);
+      }
+
+      return;
+    }
+
+    std::vector<std::vector<uint64_t> > found(threads);
+
+    runChunks(threads,n,[&](unsigned int thread,size_t begin,size_t end){
+      for(size_t i=begin;i<end;i++){
+        if(predicate(i)) found[thread].push_back(i);
+      }
+    });
+
+    size_t total = 0;
+
+    for(auto i=found.begin();i!=found.end();i++){
+      total += i->size();
+    }
+
+    indices.reserve(total);
+
+    for(auto i=found.begin();i!=found.end();i++){
+      indices.insert(indices.end(),i->begin(),i->end());
+    }
+  }
+};
+
+#endif
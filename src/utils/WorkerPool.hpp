@@ -0,0 +1,160 @@
+/*
+* Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+*/
+
+#ifndef WORKERPOOL_HPP
+#define WORKERPOOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+
+/*!
+* \brief Worker pool class
+*
+* Runs a function over the chunks of a range like ThreadUtils::runChunks, on threads that are started once and kept
+* waiting between calls, for work that is split again and again in small pieces, such as every ping of a file. The
+* calling thread runs the first chunk. Workers are started the first time they are needed.
+*/
+class WorkerPool{
+public:
+
+  /**Creates a worker pool, without any worker yet*/
+  WorkerPool() : generation(0), nbChunks(0), nbRange(0), nbRunning(0), stopping(false){
+
+  }
+
+  /**Stops and joins the workers*/
+  ~WorkerPool(){
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+
+    started.notify_all();
+
+    for(auto i=workers.begin();i!=workers.end();i++){
+      i->join();
+    }
+  }
+
+  /**
+  * Runs a function over the chunks of a range, one thread per chunk, and waits for every chunk. Chunks are
+  * contiguous and in order.
+  *
+  * @param threads number of chunks
+  * @param n size of the range
+  * @param function called with the chunk number and the bounds of the chunk
+  */
+  void runChunks(unsigned int threads,size_t n,std::function<void(unsigned int,size_t,size_t)> function){
+    if(threads <= 1){
+      function(0,0,n);
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+
+      while(workers.size() + 1 < threads){
+        workers.push_back(std::thread(&WorkerPool::work,this,workers.size() + 1));
+      }
+
+      job = function;
+      nbChunks = threads;
+      nbRange = n;
+      nbRunning = threads - 1;
+      generation++;
+    }
+
+    started.notify_all();
+
+    function(0,0,n / threads);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock,[this]{ return nbRunning == 0; });
+    job = nullptr;
+  }
+
+  /**Returns the number of workers started so far*/
+  size_t getNbWorkers(){
+    std::lock_guard<std::mutex> lock(mutex);
+    return workers.size();
+  }
+
+private:
+
+  /**
+  * Runs the chunk of a worker every time a job is started
+  *
+  * @param chunk the chunk number of the worker
+  */
+  void work(unsigned int chunk){
+    uint64_t done = 0;
+
+    while(true){
+      std::function<void(unsigned int,size_t,size_t)> function;
+      unsigned int threads;
+      size_t n;
+
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        started.wait(lock,[&]{ return stopping || generation != done; });
+
+        if(stopping) return;
+
+        done = generation;
+
+        //Workers beyond the chunks of this job sit it out
+        if(chunk >= nbChunks) continue;
+
+        function = job;
+        threads = nbChunks;
+        n = nbRange;
+      }
+
+      function(chunk,n * chunk / threads,n * (chunk + 1) / threads);
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        nbRunning--;
+      }
+
+      finished.notify_all();
+    }
+  }
+
+  /**Workers, running chunks 1 and above*/
+  std::vector<std::thread> workers;
+
+  /**Function of the current job*/
+  std::function<void(unsigned int,size_t,size_t)> job;
+
+  /**Number of the current job, incremented as each job starts*/
+  uint64_t generation;
+
+  /**Number of chunks of the current job*/
+  unsigned int nbChunks;
+
+  /**Size of the range of the current job*/
+  size_t nbRange;
+
+  /**Number of workers still running a chunk of the current job*/
+  unsigned int nbRunning;
+
+  /**True once the pool is being destroyed*/
+  bool stopping;
+
+  /**Protects the job*/
+  std::mutex mutex;
+
+  /**Signals the workers that a job started or that the pool stops*/
+  std::condition_variable started;
+
+  /**Signals the caller that a worker finished its chunk*/
+  std::condition_variable finished;
+};
+
+#endif
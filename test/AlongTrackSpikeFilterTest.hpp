@@ -0,0 +1,90 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   AlongTrackSpikeFilterTest.hpp
+ */
+
+#ifndef ALONGTRACKSPIKEFILTERTEST_HPP
+#define ALONGTRACKSPIKEFILTERTEST_HPP
+
+#include <vector>
+#include "catch.hpp"
+#include "../src/filter/AlongTrackSpikeFilter.hpp"
+
+/**Along-track spike filter that records its decisions*/
+class RecordingSpikeFilter : public AlongTrackSpikeFilter{
+public:
+    RecordingSpikeFilter(unsigned int pingWindow) : AlongTrackSpikeFilter(pingWindow,2,3.0,0.1), nbSpikes(0){}
+
+    std::vector<uint64_t> timestamps;
+    std::vector<double> spikeDepths;
+    unsigned int nbSpikes;
+
+protected:
+    void processSpikeDecision(uint64_t microEpoch,double x,double y,double z,uint32_t quality,int32_t intensity,bool isSpike){
+        timestamps.push_back(microEpoch);
+
+        if(isSpike){
+            nbSpikes++;
+            spikeDepths.push_back(z);
+        }
+    }
+};
+
+/**Adds a flat swath of 20 beams at 10m, with an optional spike*/
+void addFlatSwath(AlongTrackSpikeFilter & filter,uint64_t microEpoch,int spikeBeam = -1){
+    filter.startSwath(microEpoch);
+
+    for(int beam=0;beam<20;beam++){
+        double z = 10.0 + 0.01 * (beam % 3);
+
+        if(beam == spikeBeam) z = 25.0;
+
+        filter.addSounding(beam,microEpoch,z,0,0);
+    }
+
+    filter.endSwath();
+}
+
+TEST_CASE("Along-track spike filter rejects a spike and keeps the seafloor")
+{
+    RecordingSpikeFilter filter(2);
+
+    for(uint64_t ping=0;ping<10;ping++){
+        addFlatSwath(filter,ping,(ping == 5) ? 7 : -1);
+    }
+
+    filter.flush();
+
+    REQUIRE(filter.timestamps.size() == 200);
+    REQUIRE(filter.nbSpikes == 1);
+    REQUIRE(filter.spikeDepths[0] == 25.0);
+}
+
+TEST_CASE("Along-track spike filter emits decisions with a fixed latency")
+{
+    RecordingSpikeFilter filter(3);
+
+    REQUIRE(filter.getLatency() == 3);
+
+    for(uint64_t ping=0;ping<3;ping++){
+        addFlatSwath(filter,ping);
+        REQUIRE(filter.timestamps.size() == 0);
+    }
+
+    addFlatSwath(filter,3);
+    REQUIRE(filter.timestamps.size() == 20);
+    REQUIRE(filter.timestamps.back() == 0);
+
+    addFlatSwath(filter,4);
+    REQUIRE(filter.timestamps.size() == 40);
+    REQUIRE(filter.timestamps.back() == 1);
+
+    filter.flush();
+    REQUIRE(filter.timestamps.size() == 100);
+    REQUIRE(filter.timestamps.back() == 4);
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   BottomTrackerTest.hpp
+ */
+
+#ifndef BOTTOMTRACKERTEST_HPP
+#define BOTTOMTRACKERTEST_HPP
+
+#include <vector>
+#include <cstdlib>
+#include "catch.hpp"
+#include "../src/sidescan/BottomTracker.hpp"
+
+/**Builds a noisy channel, dark until the first bottom return*/
+void buildChannel(std::vector<double> & samples,unsigned int bottom,unsigned int fish){
+    samples.resize(2000);
+
+    for(unsigned int i=0;i<samples.size();i++){
+        samples[i] = (i < bottom) ? 5 + rand() % 10 : 100 + rand() % 40;
+    }
+
+    //A bright target in the water column
+    for(unsigned int i=fish;i<fish + 30 && fish > 0;i++){
+        samples[i] = 200;
+    }
+}
+
+TEST_CASE("Bottom tracker finds the first bottom return")
+{
+    srand(3);
+
+    BottomTracker tracker;
+    std::vector<double> samples;
+
+    buildChannel(samples,400,0);
+
+    //0.05 m per sample
+    REQUIRE(tracker.track(0,samples.data(),samples.size(),0.05) == Approx(20).margin(0.2));
+
+    //Uniform channel
+    std::vector<double> flat(1000,10);
+    REQUIRE(tracker.track(1,flat.data(),flat.size(),0.05) == -1);
+
+    //Blanking skips the bright samples near the sensor
+    BottomTracker blanked(0.5,9,0,2.0,5.0);
+    buildChannel(samples,400,20);
+    REQUIRE(blanked.track(0,samples.data(),samples.size(),0.05) == Approx(20).margin(0.2));
+}
+
+TEST_CASE("Bottom tracker keeps the returns consistent along track")
+{
+    srand(5);
+
+    BottomTracker tracker(0.5,9,5,2.0);
+    std::vector<double> samples;
+
+    //Altitude slowly rising from 20 m
+    for(unsigned int ping=0;ping<20;ping++){
+        buildChannel(samples,400 + ping,0);
+        tracker.track(0,samples.data(),samples.size(),0.05);
+    }
+
+    //A fish far above the bottom is ignored
+    buildChannel(samples,420,100);
+    REQUIRE(tracker.track(0,samples.data(),samples.size(),0.05) == Approx(21).margin(0.2));
+
+    //Channels are tracked separately
+    buildChannel(samples,100,0);
+    REQUIRE(tracker.track(1,samples.data(),samples.size(),0.05) == Approx(5).margin(0.2));
+
+    //A ping without a return close to the previous ones gets their median
+    std::vector<double> dark(2000,10);
+    dark[1990] = 500;
+    REQUIRE(tracker.track(0,dark.data(),dark.size(),0.05) == Approx(20.8).margin(0.3));
+
+    //Pings are tracked on their samples, in any sample type
+    buildChannel(samples,421,0);
+
+    SidescanPing ping;
+    ping.setSampleType(SIDESCAN_SAMPLE_UINT8);
+    ping.setSamples(samples);
+    ping.setDistancePerSample(0.05);
+
+    REQUIRE(tracker.track(ping) == Approx(21.05).margin(0.2));
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   ConvexHullTest.hpp
+ */
+
+#ifndef CONVEXHULLTEST_HPP
+#define CONVEXHULLTEST_HPP
+
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include "catch.hpp"
+#include "../src/geometry/ConvexHull.hpp"
+
+/**Point with the x and y members expected by ParallelConvexHull*/
+struct HullTestPoint{
+    float x;
+    float y;
+};
+
+/**Convex hull of a copy of the points, with the sequential monotone chain*/
+void sequentialHull(const std::vector<HullTestPoint> & points,std::vector<PointAndrews> & hull){
+    std::vector<PointAndrews> copy;
+
+    for(uint64_t i=0;i<points.size();i++){
+        PointAndrews point = {points[i].x,points[i].y,i};
+        copy.push_back(point);
+    }
+
+    AndrewsConvex_hull(hull,copy);
+}
+
+/**Returns true if both hulls have the same vertices in the same order*/
+bool sameHull(const std::vector<PointAndrews> & a,const std::vector<PointAndrews> & b){
+    if(a.size() != b.size()) return false;
+
+    for(unsigned int i=0;i<a.size();i++){
+        if(a[i].x != b[i].x || a[i].y != b[i].y) return false;
+    }
+
+    return true;
+}
+
+TEST_CASE("Parallel convex hull matches the sequential monotone chain")
+{
+    srand(7);
+
+    //Swath along a curve with ragged edges, large enough to be split between threads
+    std::vector<HullTestPoint> swath;
+
+    for(unsigned int i=0;i<300000;i++){
+        float along = (i / 100) * 0.5f + (rand() % 100) * 0.001f;
+        float across = (i % 100) * 2.0f - 100 + (rand() % 100) * 0.01f;
+        HullTestPoint point = {along + across * 0.1f,across + 0.0001f * along * along};
+        swath.push_back(point);
+    }
+
+    std::vector<PointAndrews> expected;
+    std::vector<PointAndrews> hull;
+
+    sequentialHull(swath,expected);
+    ParallelConvexHull::compute(swath,hull,4);
+
+    REQUIRE(hull.size() > 4);
+    REQUIRE(sameHull(hull,expected));
+
+    //Indices refer to the original points
+    bool indices = true;
+
+    for(auto i=hull.begin();i!=hull.end();i++){
+        if(swath[i->index].x != i->x || swath[i->index].y != i->y) indices = false;
+    }
+
+    REQUIRE(indices);
+}
+
+TEST_CASE("Parallel convex hull of small and degenerate sets")
+{
+    std::vector<PointAndrews> hull;
+
+    std::vector<HullTestPoint> none;
+    ParallelConvexHull::compute(none,hull);
+    REQUIRE(hull.empty());
+
+    //Square with points inside and on the edges
+    std::vector<HullTestPoint> square = {{0,0},{10,0},{10,10},{0,10},{5,5},{5,0},{2,3}};
+    std::vector<PointAndrews> expected;
+
+    ParallelConvexHull::compute(square,hull,1);
+    sequentialHull(square,expected);
+
+    REQUIRE(hull.size() == 4);
+    REQUIRE(sameHull(hull,expected));
+
+    //Collinear points
+    std::vector<HullTestPoint> line;
+
+    for(unsigned int i=0;i<100000;i++){
+        HullTestPoint point = {(float)(i % 1000),(float)(i % 1000) * 2};
+        line.push_back(point);
+    }
+
+    ParallelConvexHull::compute(line,hull,4);
+    sequentialHull(line,expected);
+
+    REQUIRE(sameHull(hull,expected));
+}
+
+#endif
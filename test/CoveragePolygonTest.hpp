@@ -0,0 +1,118 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   CoveragePolygonTest.hpp
+ */
+
+#ifndef COVERAGEPOLYGONTEST_HPP
+#define COVERAGEPOLYGONTEST_HPP
+
+#include <vector>
+#include <cmath>
+#include "catch.hpp"
+#include "../src/geometry/CoveragePolygon.hpp"
+#include "../src/georeferencing/CoverageGeoreferencer.hpp"
+#include "../src/svp/SvpNearestByTime.hpp"
+
+TEST_CASE("Coverage polygon of a straight line keeps its corners")
+{
+    CoveragePolygon coverage(0.5);
+
+    //Swath 100 m wide along x, with outer beams wandering by less than the tolerance
+    for(int ping=0;ping<=1000;ping++){
+        double wander = 0.2 * std::sin(ping * 0.7);
+        coverage.add(ping,50 + wander,ping,-50 - wander);
+    }
+
+    REQUIRE(coverage.getNbPings() == 1001);
+    REQUIRE(coverage.getNbVertices() == 4);
+    REQUIRE(coverage.getArea() == Approx(100000).epsilon(0.01));
+
+    std::vector<CoverageVertex> polygon;
+    coverage.getPolygon(polygon);
+
+    REQUIRE(polygon.size() == 4);
+    REQUIRE(polygon[0].x == 0);
+    REQUIRE(polygon[1].x == 1000);
+    REQUIRE(polygon[2].x == 1000);
+    REQUIRE(polygon[3].x == 0);
+}
+
+TEST_CASE("Coverage polygon stays within its vertex limit")
+{
+    CoveragePolygon unlimited(0.1);
+    CoveragePolygon limited(0.1,32);
+
+    size_t mostVertices = 0;
+
+    //Half circle of radius 1000 m, 20 m wide
+    for(int ping=0;ping<=10000;ping++){
+        double angle = M_PI * ping / 10000;
+        double inner = 990,outer = 1010;
+
+        unlimited.add(outer * std::cos(angle),outer * std::sin(angle),inner * std::cos(angle),inner * std::sin(angle));
+        limited.add(outer * std::cos(angle),outer * std::sin(angle),inner * std::cos(angle),inner * std::sin(angle));
+
+        mostVertices = std::max(mostVertices,limited.getNbVertices());
+    }
+
+    REQUIRE(mostVertices <= 32);
+
+    REQUIRE(unlimited.getNbVertices() > 32);
+    REQUIRE(limited.getTolerance() > 0.1);
+
+    double area = M_PI * (1010.0 * 1010 - 990.0 * 990) / 2;
+
+    REQUIRE(unlimited.getArea() == Approx(area).epsilon(0.01));
+    REQUIRE(limited.getArea() == Approx(area).epsilon(0.05));
+
+    REQUIRE_THROWS(CoveragePolygon(0));
+}
+
+TEST_CASE("Coverage georeferencer adds the outer beams of each swath")
+{
+    GeoreferencingLGF georef;
+    SvpNearestByTime svpStrategy;
+    Eigen::Vector3d leverArm = Eigen::Vector3d::Zero();
+    Eigen::Matrix3d boresight = Eigen::Matrix3d::Identity();
+
+    CoveragePolygon coverage(0.5);
+    CoverageGeoreferencer georeferencer(georef,svpStrategy,leverArm,boresight,coverage);
+
+    SoundVelocityProfile * svp = new SoundVelocityProfile();
+    svp->setTimestamp(1);
+    svp->add(0,1480);
+    svp->add(100,1480);
+    georeferencer.processSoundVelocityProfile(svp);
+
+    //Heading north at 48.5 N, one ping between every pair of positions
+    for(uint64_t second=0;second<10;second++){
+        georeferencer.processPosition(second * 1000000,-68.5,48.5 + second * 0.0001,0);
+        georeferencer.processAttitude(second * 1000000,0,0,0);
+
+        georeferencer.processSwathStart(1480);
+
+        for(int beam=0;beam<5;beam++){
+            georeferencer.processPing(second * 1000000 + 500000,beam,-60.0 + 30 * beam,0,0.02,0,0);
+        }
+    }
+
+    georeferencer.flush();
+
+    REQUIRE(coverage.getNbPings() == 9);
+    REQUIRE(coverage.getNbVertices() == 4);
+
+    std::vector<CoverageVertex> polygon;
+    coverage.getPolygon(polygon);
+
+    //Port is to the west, starboard to the east
+    REQUIRE(polygon[0].y < 0);
+    REQUIRE(polygon[1].y < 0);
+    REQUIRE(polygon[2].y > 0);
+    REQUIRE(polygon[3].y > 0);
+    REQUIRE(polygon[1].x > polygon[0].x);
+}
+
+#endif
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   DtmGridTest.hpp
+ */
+
+#ifndef DTMGRIDTEST_HPP
+#define DTMGRIDTEST_HPP
+
+#include "catch.hpp"
+#include "../src/gridding/DtmGrid.hpp"
+#include "../src/gridding/ParallelGridder.hpp"
+
+TEST_CASE("DTM cell statistics")
+{
+    DtmCell cell;
+    DtmCell other;
+
+    double depths[] = {10,12,11,13,14,9};
+
+    for(int i=0;i<3;i++) cell.add(depths[i]);
+    for(int i=3;i<6;i++) other.add(depths[i]);
+
+    cell.merge(other);
+
+    REQUIRE(cell.getCount() == 6);
+    REQUIRE(cell.getMean() == Approx(11.5));
+    REQUIRE(cell.getMinimum() == 9);
+    REQUIRE(cell.getMaximum() == 14);
+    REQUIRE(cell.getVariance() == Approx(17.5 / 6));
+}
+
+TEST_CASE("DTM grid cells cover negative coordinates")
+{
+    DtmGrid grid(0.5);
+
+    grid.add(-0.1,-0.1,5);
+    grid.add(0.1,0.1,6);
+    grid.add(0.4,0.2,8);
+
+    REQUIRE(grid.getNbCells() == 2);
+    REQUIRE(grid.getCell(-0.2,-0.3)->getCount() == 1);
+    REQUIRE(grid.getCell(0.3,0.3)->getMean() == Approx(7));
+    REQUIRE(grid.getCell(1.3,0.3) == NULL);
+}
+
+TEST_CASE("Parallel gridder matches a sequential grid")
+{
+    DtmGrid sequential(2.0);
+    DtmGrid parallel(2.0);
+
+    ParallelGridder gridder(2.0,4);
+
+    for(int i=0;i<50000;i++){
+        double x = (i * 37) % 101 - 50.0;
+        double y = (i * 53) % 97 - 48.0;
+        double z = 20 + (i % 13) * 0.1;
+
+        sequential.add(x,y,z);
+        gridder.add(x,y,z);
+    }
+
+    gridder.finish(parallel);
+
+    REQUIRE(parallel.getNbCells() == sequential.getNbCells());
+
+    for(auto i=sequential.getCells().begin();i!=sequential.getCells().end();i++){
+        const DtmCell & cell = parallel.getCells().find(i->first)->second;
+
+        REQUIRE(cell.getCount() == i->second.getCount());
+        REQUIRE(cell.getMean() == Approx(i->second.getMean()));
+        REQUIRE(cell.getVariance() == Approx(i->second.getVariance()));
+        REQUIRE(cell.getMinimum() == i->second.getMinimum());
+        REQUIRE(cell.getMaximum() == i->second.getMaximum());
+    }
+}
+
+TEST_CASE("DTM grid rejects positions beyond its cell indices")
+{
+    //ECEF coordinates at a millimetre resolution need more than 32 bits of cells
+    DtmGrid grid(0.001);
+
+    REQUIRE_THROWS(grid.add(4500000.0,0,20));
+    REQUIRE_THROWS(grid.getColumn(std::nan("")));
+    REQUIRE(grid.getNbCells() == 0);
+
+    grid.add(2000000.0,-2000000.0,20);
+    REQUIRE(grid.getNbCells() == 1);
+
+    //Errors of the workers are raised by finish()
+    DtmGrid parallel(0.001);
+    ParallelGridder gridder(0.001,2);
+
+    for(int i=0;i<10000;i++){
+        gridder.add(4500000.0 + i,0,20);
+    }
+
+    REQUIRE_THROWS(gridder.finish(parallel));
+}
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   GainNormalizerTest.hpp
+ */
+
+#ifndef GAINNORMALIZERTEST_HPP
+#define GAINNORMALIZERTEST_HPP
+
+#include <vector>
+#include <cmath>
+#include <random>
+#include "catch.hpp"
+#include "../src/sidescan/GainNormalizer.hpp"
+
+/**
+ * Builds a channel of a seafloor of constant backscatter, seen through a gain decreasing across track
+ *
+ * @param samples receives the samples
+ * @param level the backscatter of the seafloor
+ * @param generator the random generator of the speckle
+ */
+void buildGainChannel(std::vector<double> & samples,double level,std::mt19937 & generator){
+    std::uniform_real_distribution<double> speckle(0.8,1.2);
+
+    samples.resize(500);
+
+    for(unsigned int i=0;i<samples.size();i++){
+        samples[i] = level * (1 + 3 * std::exp(-(double)i / 50)) * speckle(generator);
+    }
+}
+
+/**
+ * Returns the mean of a range of samples
+ *
+ * @param samples the samples
+ * @param begin the first sample
+ * @param end the sample after the range
+ */
+double gainRangeMean(const std::vector<double> & samples,unsigned int begin,unsigned int end){
+    double sum = 0;
+
+    for(unsigned int i=begin;i<end;i++){
+        sum += samples[i];
+    }
+
+    return sum / (end - begin);
+}
+
+TEST_CASE("Gain normalizer flattens the channels across track")
+{
+    GainNormalizer normalizer(50,25);
+    std::mt19937 generator(7);
+    std::vector<double> samples;
+
+    for(unsigned int ping=0;ping<100;ping++){
+        buildGainChannel(samples,20,generator);
+        REQUIRE(gainRangeMean(samples,0,20) > 3 * gainRangeMean(samples,480,500));
+
+        normalizer.normalize(0,samples.data(),samples.size(),0.1,0);
+    }
+
+    //Near and far range now have the same level, the mean level of the window
+    double near = gainRangeMean(samples,0,20);
+    double far = gainRangeMean(samples,480,500);
+    double level = gainRangeMean(samples,0,500);
+
+    REQUIRE(near == Approx(far).epsilon(0.1));
+    REQUIRE(level == Approx(20 * (1 + 3 * 50.0 / 500 * (1 - std::exp(-10.0)))).epsilon(0.05));
+}
+
+TEST_CASE("Gain normalizer follows the level of its window")
+{
+    GainNormalizer normalizer(20,25);
+    std::mt19937 generator(11);
+    std::vector<double> samples;
+
+    for(unsigned int ping=0;ping<50;ping++){
+        buildGainChannel(samples,10,generator);
+        normalizer.normalize(0,samples.data(),samples.size(),0.1,0);
+    }
+
+    double before = gainRangeMean(samples,0,500);
+
+    //The pings of the first level leave the window
+    for(unsigned int ping=0;ping<50;ping++){
+        buildGainChannel(samples,40,generator);
+        normalizer.normalize(0,samples.data(),samples.size(),0.1,0);
+    }
+
+    REQUIRE(gainRangeMean(samples,0,500) == Approx(4 * before).epsilon(0.05));
+    REQUIRE(gainRangeMean(samples,0,20) == Approx(gainRangeMean(samples,480,500)).epsilon(0.1));
+
+    //Another channel has its own curve: its first ping is flattened by itself
+    buildGainChannel(samples,10,generator);
+    normalizer.normalize(1,samples.data(),samples.size(),0.1,0);
+
+    REQUIRE(gainRangeMean(samples,0,500) == Approx(before).epsilon(0.05));
+}
+
+TEST_CASE("Gain normalizer bins the samples by incidence angle")
+{
+    GainNormalizer normalizer(10,90);
+    std::vector<double> samples(400,100);
+
+    //20 m altitude, 0.1 m per sample: 45 degrees at sample 200
+    normalizer.normalize(0,samples.data(),samples.size(),0.1,20);
+
+    REQUIRE(normalizer.getBin(0) == 0);
+    REQUIRE(normalizer.getBin(199) == 44);
+    REQUIRE(normalizer.getBin(201) == 45);
+
+    //A flat channel is left as it is
+    REQUIRE(samples[0] == Approx(100));
+    REQUIRE(samples[399] == Approx(100));
+
+    //Without altitude, bins split the range evenly
+    normalizer.normalize(0,samples.data(),samples.size(),0.1,0);
+
+    REQUIRE(normalizer.getBin(0) == 0);
+    REQUIRE(normalizer.getBin(200) == 45);
+    REQUIRE(normalizer.getBin(399) == 89);
+}
+
+TEST_CASE("Gain normalizer stores integer pings as floats")
+{
+    GainNormalizer normalizer(10,10);
+
+    SidescanPing ping;
+    ping.setSampleType(SIDESCAN_SAMPLE_UINT16);
+    ping.setDistancePerSample(0.5);
+
+    std::vector<double> samples(100);
+
+    for(unsigned int i=0;i<samples.size();i++){
+        samples[i] = (i < 50) ? 300 : 100;
+    }
+
+    ping.setSamples(samples);
+    normalizer.normalize(ping,0);
+
+    REQUIRE(ping.getSampleType() == SIDESCAN_SAMPLE_FLOAT);
+    REQUIRE(ping.getNbSamples() == 100);
+    REQUIRE(ping.getSample(0) == 200);
+    REQUIRE(ping.getSample(99) == 200);
+
+    REQUIRE_THROWS(GainNormalizer(0));
+    REQUIRE_THROWS(GainNormalizer(10,0));
+}
+
+TEST_CASE("Gain normalizer keeps bright targets in dim bins")
+{
+    GainNormalizer normalizer(10,10);
+
+    SidescanPing ping;
+    ping.setSampleType(SIDESCAN_SAMPLE_UINT16);
+    ping.setDistancePerSample(0.1);
+
+    //Bright near range, dim far range with a target close to the largest 16 bit sample
+    std::vector<double> samples(10000);
+
+    for(unsigned int i=0;i<samples.size();i++){
+        samples[i] = (i < 5000) ? 300 : 100;
+    }
+
+    samples[8500] = 50000;
+
+    ping.setSamples(samples);
+    normalizer.normalize(ping,0);
+
+    //The dim bin is raised: the target goes past 65535 without saturating, and keeps its contrast
+    REQUIRE(ping.getSample(8500) > 65535);
+    REQUIRE(ping.getSample(8500) / ping.getSample(8501) == Approx(500));
+}
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   LiveDtmTest.hpp
+ */
+
+#ifndef LIVEDTMTEST_HPP
+#define LIVEDTMTEST_HPP
+
+#include <vector>
+#include "catch.hpp"
+#include "../src/gridding/LiveDtm.hpp"
+#include "../src/georeferencing/StreamingGeoreferencer.hpp"
+#include "../src/svp/SvpNearestByTime.hpp"
+
+TEST_CASE("Live DTM snapshots are not modified by later swaths")
+{
+    LiveDtm dtm(1.0,4);
+
+    dtm.add(0.5,0.5,10);
+    dtm.add(10.5,0.5,20);
+
+    REQUIRE(dtm.getDirtyTiles().size() == 2);
+    REQUIRE(dtm.getSnapshot()->getVersion() == 0);
+
+    dtm.publish();
+
+    std::shared_ptr<const LiveDtmSnapshot> first = dtm.getSnapshot();
+
+    REQUIRE(first->getVersion() == 1);
+    REQUIRE(dtm.getDirtyTiles().empty());
+
+    //Second swath only touches the first tile
+    dtm.add(0.5,0.5,12);
+    dtm.add(1.5,0.5,14);
+    dtm.publish();
+
+    std::shared_ptr<const LiveDtmSnapshot> second = dtm.getSnapshot();
+
+    REQUIRE(first->getCell(0.5,0.5).getCount() == 1);
+    REQUIRE(first->getCell(1.5,0.5).getCount() == 0);
+    REQUIRE(second->getCell(0.5,0.5).getMean() == Approx(11));
+    REQUIRE(second->getCell(1.5,0.5).getCount() == 1);
+
+    std::vector<DtmTileKey> modified = second->getTilesModifiedSince(first->getVersion());
+
+    REQUIRE(modified.size() == 1);
+    REQUIRE(modified[0].column == 0);
+
+    //The untouched tile is shared between the snapshots
+    REQUIRE(first->getTiles().find(DtmTileKey(0,2,0))->second.tile == second->getTiles().find(DtmTileKey(0,2,0))->second.tile);
+}
+
+/**Streaming georeferencer that counts the swaths and beams it georeferences*/
+class CountingStreamingGeoreferencer : public StreamingGeoreferencer{
+public:
+    CountingStreamingGeoreferencer(Georeferencing & geo,SvpSelectionStrategy & svpStrat,Eigen::Vector3d & leverArm,Eigen::Matrix3d & boresight)
+    : StreamingGeoreferencer(geo,svpStrat,leverArm,boresight), nbBeams(0){}
+
+    std::vector<uint64_t> swaths;
+    unsigned int nbBeams;
+
+    void processGeoreferencedSwathStart(uint64_t microEpoch){ swaths.push_back(microEpoch); }
+    void processGeoreferencedPing(Eigen::Vector3d & georeferencedPing,uint32_t quality,int32_t intensity){ nbBeams++; }
+};
+
+void addStreamingSwath(StreamingGeoreferencer & georeferencer,uint64_t microEpoch){
+    georeferencer.processSwathStart(1480);
+
+    for(int beam=0;beam<3;beam++){
+        georeferencer.processPing(microEpoch,beam,-30.0 + 30 * beam,0,0.02,0,0);
+    }
+}
+
+TEST_CASE("Streaming georeferencer waits for the navigation around each swath")
+{
+    GeoreferencingTRF georef;
+    SvpNearestByTime svpStrategy;
+    Eigen::Vector3d leverArm = Eigen::Vector3d::Zero();
+    Eigen::Matrix3d boresight = Eigen::Matrix3d::Identity();
+
+    CountingStreamingGeoreferencer georeferencer(georef,svpStrategy,leverArm,boresight);
+
+    SoundVelocityProfile * svp = new SoundVelocityProfile();
+    svp->setTimestamp(1);
+    svp->add(0,1480);
+    svp->add(100,1480);
+    georeferencer.processSoundVelocityProfile(svp);
+
+    georeferencer.processPosition(0,-68.5,48.5,0);
+    georeferencer.processAttitude(0,0,0,0);
+    addStreamingSwath(georeferencer,500000);
+
+    georeferencer.processPosition(1000000,-68.5,48.5001,0);
+    georeferencer.processAttitude(1000000,0,0,0);
+
+    //The swath is not closed yet
+    REQUIRE(georeferencer.swaths.size() == 0);
+
+    addStreamingSwath(georeferencer,1500000);
+
+    REQUIRE(georeferencer.swaths.size() == 1);
+    REQUIRE(georeferencer.swaths[0] == 500000);
+
+    addStreamingSwath(georeferencer,2500000);
+
+    REQUIRE(georeferencer.getNbPendingSwaths() == 1);
+
+    georeferencer.processPosition(2000000,-68.5,48.5002,0);
+    REQUIRE(georeferencer.swaths.size() == 1);
+
+    georeferencer.processAttitude(2000000,0,0,0);
+    REQUIRE(georeferencer.swaths.size() == 2);
+
+    georeferencer.flush();
+    REQUIRE(georeferencer.getNbPendingSwaths() == 1);
+    REQUIRE(georeferencer.nbBeams == 6);
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   MortonSorterTest.hpp
+ */
+
+#ifndef MORTONSORTERTEST_HPP
+#define MORTONSORTERTEST_HPP
+
+#include <vector>
+#include "catch.hpp"
+#include "../src/index/MortonSorter.hpp"
+
+/**Morton sorter that records its output*/
+class RecordingMortonSorter : public MortonSorter{
+public:
+    RecordingMortonSorter(size_t maxPointsInMemory) : MortonSorter(1.0,maxPointsInMemory,4){}
+
+    std::vector<uint32_t> order;
+
+protected:
+    void processSortedPoint(double x,double y,double z,uint32_t quality,int32_t intensity){
+        order.push_back(quality);
+    }
+};
+
+TEST_CASE("Morton codes interleave x and y")
+{
+    REQUIRE(MortonSorter::encode(0,0) == 0);
+    REQUIRE(MortonSorter::encode(1,0) == 1);
+    REQUIRE(MortonSorter::encode(0,1) == 2);
+    REQUIRE(MortonSorter::encode(3,3) == 15);
+    REQUIRE(MortonSorter::encode(0xFFFFFFFF,0) == 0x5555555555555555ULL);
+}
+
+TEST_CASE("Parallel radix sort orders records by Morton code")
+{
+    std::vector<MortonRecord> records(200000);
+
+    for(size_t i=0;i<records.size();i++){
+        records[i].code = ((uint64_t)(i * 2654435761u) << 20) ^ (i * 40503);
+        records[i].quality = i;
+    }
+
+    std::vector<MortonRecord> expected = records;
+    std::stable_sort(expected.begin(),expected.end(),[](const MortonRecord & r1,const MortonRecord & r2){ return r1.code < r2.code; });
+
+    MortonSorter::radixSort(records,4);
+
+    bool sameOrder = true;
+
+    for(size_t i=0;i<records.size();i++){
+        sameOrder = sameOrder && (records[i].quality == expected[i].quality);
+    }
+
+    REQUIRE(sameOrder);
+}
+
+TEST_CASE("Morton sorter gives the same order with and without spilling")
+{
+    RecordingMortonSorter inMemory(1000000);
+    RecordingMortonSorter spilled(1000);
+
+    //A 64x64 grid in row order, every cell once
+    for(uint32_t i=0;i<4096;i++){
+        double x = i % 64;
+        double y = i / 64;
+
+        inMemory.add(x,y,0,i,0);
+        spilled.add(x,y,0,i,0);
+    }
+
+    inMemory.finish();
+    spilled.finish();
+
+    REQUIRE(spilled.getNbRuns() == 0);
+    REQUIRE(inMemory.order.size() == 4096);
+    REQUIRE(spilled.order == inMemory.order);
+
+    //The first four points are the first 2x2 block
+    REQUIRE(inMemory.order[0] == 0);
+    REQUIRE(inMemory.order[1] == 1);
+    REQUIRE(inMemory.order[2] == 64);
+    REQUIRE(inMemory.order[3] == 65);
+}
+
+#endif
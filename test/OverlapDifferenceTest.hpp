@@ -0,0 +1,82 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   OverlapDifferenceTest.hpp
+ */
+
+#ifndef OVERLAPDIFFERENCETEST_HPP
+#define OVERLAPDIFFERENCETEST_HPP
+
+#include "catch.hpp"
+#include "../src/gridding/OverlapDifference.hpp"
+
+TEST_CASE("Overlap difference statistics")
+{
+    DtmGrid line1(1.0);
+    DtmGrid line2(1.0);
+
+    //Line 2 is 0.1 m deeper than line 1 over 100 cells, plus one cell 1 m off, and has cells line 1 does not cover
+    for(unsigned int x=0;x<101;x++){
+        line1.add(x + 0.5,0.5,10);
+        line1.add(x + 0.5,0.5,12);
+        line2.add(x + 0.5,0.5,(x == 100) ? 12 : 11.1);
+    }
+
+    for(unsigned int x=0;x<50;x++){
+        line2.add(x + 0.5,5.5,20);
+    }
+
+    OverlapDifference difference(1,2);
+    difference.compute(line1,line2);
+
+    REQUIRE(difference.getNbCells() == 101);
+    REQUIRE(difference.getMinimum() == Approx(0.1));
+    REQUIRE(difference.getMaximum() == Approx(1.0));
+    REQUIRE(difference.getPercentile(50) == Approx(0.1));
+    REQUIRE(difference.getPercentile(100) == Approx(1.0));
+    REQUIRE(difference.getMean() == Approx((100 * 0.1 + 1.0) / 101));
+    REQUIRE(difference.getStandardDeviation() > 0);
+
+    //Swapping the lines changes the sign
+    difference.compute(line2,line1);
+
+    REQUIRE(difference.getMinimum() == Approx(-1.0));
+    REQUIRE(difference.getPercentile(0) == Approx(-1.0));
+    REQUIRE(difference.getPercentile(50) == Approx(-0.1));
+
+    //Cells with too few soundings are not compared
+    OverlapDifference strict(2,2);
+    strict.compute(line1,line2);
+
+    REQUIRE(strict.getNbCells() == 0);
+    REQUIRE(strict.getMean() == 0);
+
+    DtmGrid coarse(2.0);
+    REQUIRE_THROWS(difference.compute(line1,coarse));
+}
+
+TEST_CASE("Overlap difference over many cells")
+{
+    DtmGrid line1(1.0);
+    DtmGrid line2(1.0);
+
+    for(unsigned int x=0;x<200;x++){
+        for(unsigned int y=0;y<200;y++){
+            line1.add(x + 0.5,y + 0.5,50);
+            line2.add(x + 0.5,y + 0.5,50 + ((x + y) % 2 == 0 ? 0.2 : -0.2));
+        }
+    }
+
+    OverlapDifference difference(1,4);
+    difference.compute(line1,line2);
+
+    REQUIRE(difference.getNbCells() == 40000);
+    REQUIRE(difference.getMean() == Approx(0).margin(1e-9));
+    REQUIRE(difference.getStandardDeviation() == Approx(0.2));
+    REQUIRE(difference.getPercentile(25) == Approx(-0.2));
+    REQUIRE(difference.getPercentile(75) == Approx(0.2));
+}
+
+#endif
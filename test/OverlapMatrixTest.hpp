@@ -0,0 +1,106 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   OverlapMatrixTest.hpp
+ */
+
+#ifndef OVERLAPMATRIXTEST_HPP
+#define OVERLAPMATRIXTEST_HPP
+
+#include <sstream>
+#include <cmath>
+#include "catch.hpp"
+#include "../src/geometry/OverlapMatrix.hpp"
+
+TEST_CASE("Overlap matrix of a survey")
+{
+    OverlapMatrix matrix(1.0,4);
+
+    //Three parallel lines along x, 10 m wide, the middle one overlapping both others by 2 m, and a cross line
+    double offsets[3] = {0,8,16};
+
+    for(unsigned int line=0;line<3;line++){
+        uint32_t index = matrix.addLine("line" + std::to_string(line));
+
+        for(unsigned int x=0;x<100;x++){
+            for(unsigned int y=0;y<10;y++){
+                matrix.addPoint(index,x + 0.5,offsets[line] + y + 0.5);
+            }
+        }
+    }
+
+    uint32_t cross = matrix.addLine("cross");
+
+    for(unsigned int x=50;x<55;x++){
+        for(unsigned int y=0;y<26;y++){
+            //Two points per cell
+            matrix.addPoint(cross,x + 0.25,y + 0.25);
+            matrix.addPoint(cross,x + 0.75,y + 0.75);
+        }
+    }
+
+    //A line far away overlaps nothing
+    uint32_t far = matrix.addLine("far");
+    matrix.addPoint(far,1000,1000);
+
+    matrix.compute();
+
+    REQUIRE(matrix.getNbLines() == 5);
+    REQUIRE(matrix.getNbCells(cross) == 130);
+
+    const std::vector<LineOverlap> & overlaps = matrix.getOverlaps();
+
+    REQUIRE(overlaps.size() == 5);
+
+    REQUIRE(overlaps[0].line1 == 0);
+    REQUIRE(overlaps[0].line2 == 1);
+    REQUIRE(overlaps[0].nbCells == 200);
+    REQUIRE(overlaps[0].nbPoints1 == 200);
+    REQUIRE(overlaps[0].nbPoints2 == 200);
+
+    REQUIRE(overlaps[1].line1 == 0);
+    REQUIRE(overlaps[1].line2 == 3);
+    REQUIRE(overlaps[1].nbCells == 50);
+    REQUIRE(overlaps[1].nbPoints2 == 100);
+
+    REQUIRE(overlaps[2].line1 == 1);
+    REQUIRE(overlaps[2].line2 == 2);
+    REQUIRE(overlaps[3].line1 == 1);
+    REQUIRE(overlaps[3].line2 == 3);
+
+    REQUIRE(overlaps[4].line1 == 2);
+    REQUIRE(overlaps[4].line2 == 3);
+    REQUIRE(overlaps[4].nbCells == 50);
+
+    std::stringstream out;
+    matrix.write(out);
+
+    std::string first;
+    std::getline(out,first);
+    REQUIRE(first == "line0 line1 200 200 200");
+
+    //Points added afterwards join the existing footprints
+    matrix.addPoint(far,0.5,0.5);
+    matrix.compute();
+
+    REQUIRE(matrix.getOverlaps().size() == 6);
+    REQUIRE(matrix.getNbCells(far) == 2);
+}
+
+TEST_CASE("Overlap matrix rejects points beyond its cell indices")
+{
+    OverlapMatrix matrix(1e-6,2);
+    uint32_t line = matrix.addLine("line");
+
+    REQUIRE_THROWS(matrix.addPoint(line,5000,0));
+    REQUIRE_THROWS(matrix.addPoint(line,std::nan(""),0));
+
+    matrix.addPoint(line,0.5e-6,0.5e-6);
+    matrix.compute();
+
+    REQUIRE(matrix.getNbCells(line) == 1);
+}
+
+#endif
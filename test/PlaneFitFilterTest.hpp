@@ -0,0 +1,82 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   PlaneFitFilterTest.hpp
+ */
+
+#ifndef PLANEFITFILTERTEST_HPP
+#define PLANEFITFILTERTEST_HPP
+
+#include <vector>
+#include "catch.hpp"
+#include "../src/filter/PlaneFitFilter.hpp"
+
+TEST_CASE("Plane fit filter rejects the points far from the local plane")
+{
+    std::vector<Eigen::Vector3d> cloud;
+
+    //Sloping seafloor, 50m x 50m
+    for(int i=0;i<50;i++){
+        for(int j=0;j<50;j++){
+            cloud.push_back(Eigen::Vector3d(i,j,20 + 0.1*i - 0.05*j));
+        }
+    }
+
+    cloud[1275](2) += 5;
+    cloud[10](2) -= 3;
+
+    PlaneFitFilter filter(0.5,8,4);
+    filter.build(cloud);
+
+    unsigned int nbRejected = 0;
+
+    for(unsigned int i=0;i<cloud.size();i++){
+        if(filter.filterPoint(0,cloud[i](0),cloud[i](1),cloud[i](2),0,0)){
+            nbRejected++;
+        }
+    }
+
+    REQUIRE(nbRejected == 2);
+    REQUIRE(filter.filterPoint(0,cloud[1275](0),cloud[1275](1),cloud[1275](2),0,0));
+    REQUIRE(filter.filterPoint(0,cloud[10](0),cloud[10](1),cloud[10](2),0,0));
+
+    //Points that were not in the cloud are left alone
+    REQUIRE_FALSE(filter.filterPoint(0,10.5,10.5,100,0,0));
+}
+
+TEST_CASE("Plane fit filter with a collinear cloud")
+{
+    std::vector<Eigen::Vector3d> cloud;
+
+    //A single 1 km profile has no area: its grid must stay within the number of points
+    for(int i=0;i<1000;i++){
+        cloud.push_back(Eigen::Vector3d(i,0,20 + 0.01*i));
+    }
+
+    PlaneFitFilter filter(0.5,8,4);
+    filter.build(cloud);
+
+    unsigned int nbRejected = 0;
+
+    for(unsigned int i=0;i<cloud.size();i++){
+        if(filter.filterPoint(0,cloud[i](0),cloud[i](1),cloud[i](2),0,0)){
+            nbRejected++;
+        }
+    }
+
+    REQUIRE(nbRejected == 0);
+}
+
+TEST_CASE("Plane fit filter with an empty cloud")
+{
+    std::vector<Eigen::Vector3d> cloud;
+
+    PlaneFitFilter filter(0.5);
+    filter.build(cloud);
+
+    REQUIRE_FALSE(filter.filterPoint(0,0,0,0,0,0));
+}
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   PolygonIndexTest.hpp
+ */
+
+#ifndef POLYGONINDEXTEST_HPP
+#define POLYGONINDEXTEST_HPP
+
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include "catch.hpp"
+#include "../src/geometry/PolygonIndex.hpp"
+
+/**Vertex or point with the x and y members expected by PolygonIndex*/
+struct PolygonTestPoint{
+    double x;
+    double y;
+};
+
+/**Crossing number test against every edge*/
+bool bruteForceContains(const std::vector<PolygonTestPoint> & polygon,double px,double py){
+    bool inside = false;
+
+    for(unsigned int i=0,j=polygon.size()-1;i<polygon.size();j=i++){
+        if((polygon[i].y > py) != (polygon[j].y > py) &&
+           px < (polygon[j].x - polygon[i].x) * (py - polygon[i].y) / (polygon[j].y - polygon[i].y) + polygon[i].x){
+            inside = !inside;
+        }
+    }
+
+    return inside;
+}
+
+TEST_CASE("Polygon index on a square")
+{
+    std::vector<PolygonTestPoint> square = {{0,0},{10,0},{10,10},{0,10}};
+    PolygonIndex index(square,1);
+
+    REQUIRE(index.getNbBands() == 4);
+    REQUIRE(index.contains(5,5));
+    REQUIRE(index.contains(0.1,9.9));
+    REQUIRE(!index.contains(-0.1,5));
+    REQUIRE(!index.contains(5,10.1));
+
+    //Polygons without area contain nothing
+    std::vector<PolygonTestPoint> line = {{0,0},{5,0},{10,0}};
+    PolygonIndex flat(line,1);
+
+    REQUIRE(flat.getNbBands() == 0);
+    REQUIRE(!flat.contains(5,0));
+
+    std::vector<PolygonTestPoint> two = {{0,0},{5,5}};
+    REQUIRE(!PolygonIndex(two,1).contains(2,2));
+}
+
+TEST_CASE("Polygon index matches the test against every edge")
+{
+    //Star shaped concave polygon
+    std::vector<PolygonTestPoint> star;
+
+    for(unsigned int i=0;i<500;i++){
+        double angle = 2 * M_PI * i / 500;
+        double radius = (i % 2 == 0) ? 100 : 40 + (i % 7) * 5;
+        PolygonTestPoint vertex = {radius * cos(angle),radius * sin(angle)};
+        star.push_back(vertex);
+    }
+
+    PolygonIndex index(star,4);
+
+    REQUIRE(index.getNbBands() == 500);
+
+    srand(1234);
+
+    std::vector<PolygonTestPoint> points;
+
+    for(unsigned int i=0;i<100000;i++){
+        PolygonTestPoint point = {(rand() % 22000) / 100.0 - 110,(rand() % 22000) / 100.0 - 110};
+        points.push_back(point);
+    }
+
+    std::vector<uint64_t> indices;
+    index.findPointsInside(points,indices);
+
+    std::vector<uint64_t> expected;
+
+    for(unsigned int i=0;i<points.size();i++){
+        if(bruteForceContains(star,points[i].x,points[i].y)) expected.push_back(i);
+    }
+
+    REQUIRE(expected.size() > 10000);
+    REQUIRE(indices == expected);
+}
+
+TEST_CASE("Polygon index spreads the long sides of a line over the bands")
+{
+    //Footprint of a line along x, 1000 m by 100 m, with ragged sides
+    std::vector<PolygonTestPoint> line;
+
+    for(unsigned int i=0;i<=1000;i++){
+        PolygonTestPoint vertex = {(double)i,(i % 3) * 0.5};
+        line.push_back(vertex);
+    }
+
+    for(int i=1000;i>=0;i--){
+        PolygonTestPoint vertex = {(double)i,100 - (i % 5) * 0.5};
+        line.push_back(vertex);
+    }
+
+    PolygonIndex index(line,1);
+
+    REQUIRE(index.getMaxEdgesPerBand() <= 6);
+    REQUIRE(index.contains(500.5,50));
+    REQUIRE(index.contains(0.5,50));
+    REQUIRE(!index.contains(500.5,101));
+    REQUIRE(!index.contains(1001,50));
+}
+
+#endif
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   QuinsyR2SonicDecoderTest.hpp
+ */
+
+#ifndef QUINSYR2SONICDECODERTEST_HPP
+#define QUINSYR2SONICDECODERTEST_HPP
+
+#include <vector>
+#include <cstring>
+#include <cmath>
+#include "catch.hpp"
+#include "../src/datagrams/xtf/QuinsyR2SonicDecoder.hpp"
+
+/**
+ * Appends a big-endian word to a packet
+ *
+ * @param packet the packet
+ * @param value the word
+ * @param nbBytes the size of the word
+ */
+void appendBigEndian(std::vector<unsigned char> & packet,uint32_t value,unsigned int nbBytes){
+    for(int i=nbBytes-1;i>=0;i--){
+        packet.push_back((value >> (8 * i)) & 0xFF);
+    }
+}
+
+/**
+ * Appends a big-endian float to a packet
+ *
+ * @param packet the packet
+ * @param value the float
+ */
+void appendBigEndianFloat(std::vector<unsigned char> & packet,float value){
+    uint32_t word;
+    memcpy(&word,&value,sizeof(float));
+    appendBigEndian(packet,word,4);
+}
+
+/**
+ * Appends a section of a beam array to a packet: name, size, scaling factor, then the array
+ *
+ * @param packet the packet
+ * @param name the section name
+ * @param scalingFactor the scaling factor of the array
+ * @param values the array
+ */
+void appendR2SonicArraySection(std::vector<unsigned char> & packet,uint16_t name,float scalingFactor,const std::vector<uint16_t> & values){
+    appendBigEndian(packet,name,2);
+    appendBigEndian(packet,8 + 2 * values.size(),2);
+    appendBigEndianFloat(packet,scalingFactor);
+
+    for(unsigned int i=0;i<values.size();i++){
+        appendBigEndian(packet,values[i],2);
+    }
+}
+
+TEST_CASE("QUINSy R2Sonic decoder swaps the beam arrays of a BTH0 packet")
+{
+    //Packet starts at an odd address, as it can in an XTF file
+    std::vector<unsigned char> packet(1,0);
+
+    appendBigEndian(packet,R2SONIC_PACKET_BTH0,4);
+    appendBigEndian(packet,0,4); //size, set below
+    appendBigEndian(packet,0,4);
+
+    //H0, 3 beams
+    std::vector<unsigned char> h0(sizeof(XtfHeaderQuinsyR2SonicBathy_H0),0);
+    h0[0] = 0x48; h0[1] = 0x30;
+    h0[3] = sizeof(XtfHeaderQuinsyR2SonicBathy_H0);
+    h0[offsetof(XtfHeaderQuinsyR2SonicBathy_H0,TimeSeconds) + 3] = 10;
+    h0[offsetof(XtfHeaderQuinsyR2SonicBathy_H0,TimeNanoseconds) + 2] = 0x03;
+    h0[offsetof(XtfHeaderQuinsyR2SonicBathy_H0,TimeNanoseconds) + 3] = 0xE8;
+    h0[offsetof(XtfHeaderQuinsyR2SonicBathy_H0,Points) + 1] = 3;
+    packet.insert(packet.end(),h0.begin(),h0.end());
+
+    //R0
+    std::vector<uint16_t> ranges = {1000,2000,65535};
+    appendR2SonicArraySection(packet,R2SONIC_SECTION_R0,0.001f,ranges);
+
+    //I1
+    std::vector<uint16_t> intensities = {1,2,0x0102};
+    appendR2SonicArraySection(packet,R2SONIC_SECTION_I1,0.5f,intensities);
+
+    //A2: first angle, scaling factor, 6 reserved floats, then the steps
+    appendBigEndian(packet,R2SONIC_SECTION_A2,2);
+    appendBigEndian(packet,sizeof(XtfHeaderQuinsyR2SonicBathy_A2) - 2 + 3 * 2,2);
+    appendBigEndianFloat(packet,-1.0f);
+    appendBigEndianFloat(packet,0.25f);
+
+    for(unsigned int i=0;i<6;i++){
+        appendBigEndianFloat(packet,0);
+    }
+
+    appendBigEndian(packet,0,2);
+    appendBigEndian(packet,2,2);
+    appendBigEndian(packet,4,2);
+
+    uint32_t size = packet.size() - 1;
+    packet[5] = (size >> 24) & 0xFF;
+    packet[6] = (size >> 16) & 0xFF;
+    packet[7] = (size >> 8) & 0xFF;
+    packet[8] = size & 0xFF;
+
+    QuinsyR2SonicDecoder decoder;
+    REQUIRE(decoder.decode(packet.data() + 1));
+
+    REQUIRE(decoder.getTimestamp() == 10000001);
+    REQUIRE(decoder.getNbBeams() == 3);
+
+    const double * twtt = decoder.getTwoWayTravelTimes();
+    REQUIRE(twtt[0] == Approx(1.0));
+    REQUIRE(twtt[1] == Approx(2.0));
+    REQUIRE(twtt[2] == Approx(65.535));
+
+    const double * intensity = decoder.getIntensities();
+    REQUIRE(intensity[0] == Approx(20 * std::log10(0.5 * 1000000 / 0.00002)));
+    REQUIRE(intensity[2] == Approx(20 * std::log10(129.0 * 1000000 / 0.00002)));
+
+    //The angle steps add up
+    const double * angles = decoder.getAcrossTrackAngles();
+    REQUIRE(angles[0] == Approx(-1.0 * R2D));
+    REQUIRE(angles[1] == Approx(-0.5 * R2D));
+    REQUIRE(angles[2] == Approx(0.5 * R2D));
+
+    REQUIRE(decoder.getQualities()[1] == 0);
+
+    //Another packet type is rejected
+    packet[1] = 'X';
+    REQUIRE_FALSE(decoder.decode(packet.data() + 1));
+}
+
+TEST_CASE("QUINSy R2Sonic decoder skips arrays larger than their section")
+{
+    std::vector<unsigned char> packet;
+
+    appendBigEndian(packet,R2SONIC_PACKET_BTH0,4);
+    appendBigEndian(packet,0,4);
+    appendBigEndian(packet,0,4);
+
+    std::vector<unsigned char> h0(sizeof(XtfHeaderQuinsyR2SonicBathy_H0),0);
+    h0[0] = 0x48; h0[1] = 0x30;
+    h0[3] = sizeof(XtfHeaderQuinsyR2SonicBathy_H0);
+    h0[offsetof(XtfHeaderQuinsyR2SonicBathy_H0,Points) + 1] = 4;
+    packet.insert(packet.end(),h0.begin(),h0.end());
+
+    //2 ranges for 4 beams
+    std::vector<uint16_t> ranges = {1000,2000};
+    appendR2SonicArraySection(packet,R2SONIC_SECTION_R0,0.001f,ranges);
+
+    packet[7] = packet.size();
+
+    QuinsyR2SonicDecoder decoder;
+    REQUIRE(decoder.decode(packet.data()));
+    REQUIRE(decoder.getNbBeams() == 4);
+    REQUIRE(decoder.getTwoWayTravelTimes()[0] == 0);
+    REQUIRE(decoder.getTwoWayTravelTimes()[3] == 0);
+}
+
+#endif
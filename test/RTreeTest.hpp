@@ -0,0 +1,71 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   RTreeTest.hpp
+ */
+
+#ifndef RTREETEST_HPP
+#define RTREETEST_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include "catch.hpp"
+#include "../src/index/RTree.hpp"
+
+TEST_CASE("R-tree finds the intersecting boxes")
+{
+    srand(42);
+
+    std::vector<BoundingBox> boxes;
+
+    for(unsigned int i=0;i<2000;i++){
+        double x = rand() % 10000;
+        double y = rand() % 10000;
+        boxes.push_back(BoundingBox(x,y,x + rand() % 500,y + rand() % 500));
+    }
+
+    RTree tree(boxes,8);
+
+    REQUIRE(tree.getNbNodes() > boxes.size());
+
+    bool same = true;
+    std::vector<uint32_t> found;
+
+    for(unsigned int i=0;i<100;i++){
+        double x = rand() % 10000;
+        double y = rand() % 10000;
+        BoundingBox query(x,y,x + 300,y + 300);
+
+        tree.query(query,found);
+        std::sort(found.begin(),found.end());
+
+        std::vector<uint32_t> expected;
+
+        for(uint32_t j=0;j<boxes.size();j++){
+            if(boxes[j].intersects(query)) expected.push_back(j);
+        }
+
+        if(found != expected) same = false;
+    }
+
+    REQUIRE(same);
+
+    //Touching boxes intersect, a single box is its own tree
+    std::vector<BoundingBox> one(1,BoundingBox(0,0,1,1));
+    RTree single(one);
+
+    single.query(BoundingBox(1,1,2,2),found);
+    REQUIRE(found.size() == 1);
+
+    single.query(BoundingBox(1.5,0,2,1),found);
+    REQUIRE(found.empty());
+
+    RTree empty((std::vector<BoundingBox>()));
+    empty.query(BoundingBox(0,0,1,1),found);
+    REQUIRE(found.empty());
+}
+
+#endif
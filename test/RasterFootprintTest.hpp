@@ -0,0 +1,239 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   RasterFootprintTest.hpp
+ */
+
+#ifndef RASTERFOOTPRINTTEST_HPP
+#define RASTERFOOTPRINTTEST_HPP
+
+#include <vector>
+#include "catch.hpp"
+#include "../src/geometry/RasterFootprint.hpp"
+
+/**Point with the x and y members expected by RasterFootprint*/
+struct FootprintTestPoint{
+    double x;
+    double y;
+};
+
+/**Signed area of a ring, positive when counter-clockwise*/
+double ringArea(const std::vector<RasterFootprintVertex> & ring){
+    double area = 0;
+
+    for(unsigned int i=0;i<ring.size();i++){
+        const RasterFootprintVertex & a = ring[i];
+        const RasterFootprintVertex & b = ring[(i + 1) % ring.size()];
+        area += a.x * b.y - b.x * a.y;
+    }
+
+    return area / 2;
+}
+
+/**Points at the center of the cells of a block, except the ones listed*/
+std::vector<FootprintTestPoint> blockPoints(int columns,int rows,double offsetX,double offsetY,int holeColumn = -1,int holeRow = -1){
+    std::vector<FootprintTestPoint> points;
+
+    for(int row=0;row<rows;row++){
+        for(int column=0;column<columns;column++){
+            if(column == holeColumn && row == holeRow) continue;
+
+            FootprintTestPoint point = {offsetX + column + 0.5,offsetY + row + 0.5};
+            points.push_back(point);
+        }
+    }
+
+    return points;
+}
+
+TEST_CASE("Raster footprint occupancy")
+{
+    RasterFootprint footprint(1.0,2);
+    footprint.rasterize(blockPoints(3,2,-1,10));
+
+    REQUIRE(footprint.getNbColumns() == 3);
+    REQUIRE(footprint.getNbRows() == 2);
+    REQUIRE(footprint.getNbOccupiedCells() == 6);
+    REQUIRE(footprint.getArea() == Approx(6.0));
+
+    REQUIRE(footprint.contains(-0.9,10.1));
+    REQUIRE(footprint.contains(1.9,11.9));
+    REQUIRE(!footprint.contains(2.1,11.9));
+    REQUIRE(!footprint.contains(0.5,9.9));
+}
+
+TEST_CASE("Raster footprint outline")
+{
+    RasterFootprint footprint(2.0,2);
+
+    //3x3 block of cells of 2x2: the outline cuts the four corners
+    std::vector<FootprintTestPoint> points = blockPoints(3,3,0,0);
+
+    for(auto i=points.begin();i!=points.end();i++){
+        i->x *= 2;
+        i->y *= 2;
+    }
+
+    footprint.rasterize(points);
+
+    std::vector<std::vector<RasterFootprintVertex> > rings;
+    footprint.computeOutline(rings);
+
+    REQUIRE(rings.size() == 1);
+    REQUIRE(rings[0].size() == 12);
+    REQUIRE(ringArea(rings[0]) == Approx(4 * 8.5));
+
+    //With a hole in the middle, the hole is a clockwise ring
+    RasterFootprint holed(1.0,2);
+    holed.rasterize(blockPoints(3,3,0,0,1,1));
+    holed.computeOutline(rings);
+
+    REQUIRE(rings.size() == 2);
+
+    double outer = std::max(ringArea(rings[0]),ringArea(rings[1]));
+    double hole  = std::min(ringArea(rings[0]),ringArea(rings[1]));
+
+    REQUIRE(outer == Approx(8.5));
+    REQUIRE(hole == Approx(-0.5));
+
+    //Diagonal neighbours are separate rings
+    std::vector<FootprintTestPoint> diagonal;
+    FootprintTestPoint a = {0.5,0.5};
+    FootprintTestPoint b = {1.5,1.5};
+    diagonal.push_back(a);
+    diagonal.push_back(b);
+
+    RasterFootprint corners(1.0,2);
+    corners.rasterize(diagonal);
+    corners.computeOutline(rings);
+
+    REQUIRE(rings.size() == 2);
+    REQUIRE(rings[0].size() == 4);
+    REQUIRE(rings[1].size() == 4);
+}
+
+TEST_CASE("Raster footprint intersection and points inside")
+{
+    RasterFootprint line1(1.0,4);
+    RasterFootprint line2(1.0,4);
+
+    line1.rasterize(blockPoints(10,4,0,0));
+    line2.rasterize(blockPoints(4,10,6,-3));
+
+    RasterFootprint overlap = RasterFootprint::intersect(line1,line2);
+
+    REQUIRE(overlap.getNbOccupiedCells() == 16);
+    REQUIRE(overlap.contains(6.5,0.5));
+    REQUIRE(!overlap.contains(5.5,0.5));
+
+    std::vector<FootprintTestPoint> points = blockPoints(10,4,0,0);
+    std::vector<uint64_t> indices;
+    overlap.findPointsInside(points,indices);
+
+    REQUIRE(indices.size() == 16);
+    REQUIRE(indices[0] == 6);
+    REQUIRE(indices[15] == 39);
+
+    //Large enough to split between threads, and keep the order of the points
+    std::vector<FootprintTestPoint> many;
+
+    for(unsigned int i=0;i<100000;i++){
+        FootprintTestPoint point = {(i % 10) + 0.5,((i / 10) % 4) + 0.5};
+        many.push_back(point);
+    }
+
+    overlap.findPointsInside(many,indices);
+
+    REQUIRE(indices.size() == 40000);
+
+    bool sorted = true;
+
+    for(unsigned int i=1;i<indices.size();i++){
+        if(indices[i] <= indices[i - 1]) sorted = false;
+    }
+
+    REQUIRE(sorted);
+
+    //Disjoint lines do not overlap
+    RasterFootprint far(1.0,4);
+    far.rasterize(blockPoints(2,2,100,100));
+
+    REQUIRE(RasterFootprint::intersect(line1,far).isEmpty());
+
+    RasterFootprint coarse(2.0,4);
+    REQUIRE_THROWS(RasterFootprint::intersect(line1,coarse));
+}
+
+TEST_CASE("Raster footprint of a long diagonal line")
+{
+    //A 1 km diagonal line at 5 cm cells: its bounding box holds 400 million cells
+    std::vector<FootprintTestPoint> points;
+
+    for(unsigned int i=0;i<200000;i++){
+        double along = i * 0.005;
+        FootprintTestPoint point = {along - 500,along - 500};
+        points.push_back(point);
+    }
+
+    RasterFootprint footprint(0.05,4);
+    footprint.rasterize(points);
+
+    REQUIRE(footprint.getNbColumns() == 20000);
+    REQUIRE(footprint.getNbRows() == 20000);
+
+    //Only the tiles along the diagonal are stored
+    REQUIRE(footprint.getNbOccupiedCells() == 20000);
+    REQUIRE(footprint.getNbTiles() < 1000);
+
+    REQUIRE(footprint.contains(0.01,0.01));
+    REQUIRE(!footprint.contains(100.01,0.01));
+
+    //Cells touching by their corners only are separate rings
+    std::vector<std::vector<RasterFootprintVertex> > rings;
+    footprint.computeOutline(rings);
+
+    REQUIRE(rings.size() == 20000);
+    REQUIRE(rings[0].size() == 4);
+
+    RasterFootprint overlap = RasterFootprint::intersect(footprint,footprint);
+    REQUIRE(overlap.getNbOccupiedCells() == 20000);
+}
+
+TEST_CASE("Raster footprint built point by point")
+{
+    std::vector<FootprintTestPoint> points = blockPoints(70,5,-40,-3,10,2);
+
+    RasterFootprint whole(1.0,1);
+    whole.rasterize(points);
+
+    RasterFootprint added(1.0,1);
+
+    for(unsigned int i=0;i<points.size();i++){
+        added.addPoint(points[i].x,points[i].y);
+    }
+
+    REQUIRE(added.getNbOccupiedCells() == whole.getNbOccupiedCells());
+    REQUIRE(added.getFirstColumn() == whole.getFirstColumn());
+    REQUIRE(added.getFirstRow() == whole.getFirstRow());
+    REQUIRE(added.getNbColumns() == whole.getNbColumns());
+    REQUIRE(added.getNbRows() == whole.getNbRows());
+    REQUIRE(RasterFootprint::intersect(added,whole).getNbOccupiedCells() == whole.getNbOccupiedCells());
+
+    //Every occupied cell is visited once
+    uint64_t visited = 0;
+    bool inside = true;
+
+    added.forEachCell([&](int64_t column,int64_t row){
+        visited++;
+        if(!added.contains(column + 0.5,row + 0.5)) inside = false;
+    });
+
+    REQUIRE(visited == added.getNbOccupiedCells());
+    REQUIRE(inside);
+
+    REQUIRE_THROWS(added.addPoint(1e12,0));
+}
+
+#endif
@@ -0,0 +1,306 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   SidescanMosaicTest.hpp
+ */
+
+#ifndef SIDESCANMOSAICTEST_HPP
+#define SIDESCANMOSAICTEST_HPP
+
+#include <vector>
+#include <sstream>
+#include "catch.hpp"
+#include "../src/sidescan/SidescanMosaic.hpp"
+
+/**
+ * Adds a straight northbound line to a mosaic: 100 m long at 1 m/s, one ping per side every 0.5 s, 80 samples
+ * 0.25 m apart on each side
+ *
+ * @param mosaic the mosaic
+ * @param east the east position of the line
+ * @param port the value of the port samples
+ * @param starboard the value of the starboard samples
+ * @param withHeadings true to add headings, false to use the course made good
+ */
+void addMosaicLine(SidescanMosaic & mosaic,double east,double port,double starboard,bool withHeadings){
+    mosaic.startLine();
+
+    for(unsigned int second=0;second<=100;second++){
+        mosaic.addPosition(second * 1000000ul,second,east);
+
+        if(withHeadings) mosaic.addHeading(second * 1000000ul,0);
+    }
+
+    for(unsigned int i=0;i<200;i++){
+        SidescanPing ping;
+        ping.setTimestamp(i * 500000ul);
+        ping.setDistancePerSample(0.25);
+
+        std::vector<double> portSamples(80,port);
+        ping.setSamples(portSamples);
+        mosaic.addPing(ping,MOSAIC_PORT);
+
+        std::vector<double> starboardSamples(80,starboard);
+        ping.setSamples(starboardSamples);
+        mosaic.addPing(ping,MOSAIC_STARBOARD);
+    }
+}
+
+TEST_CASE("Sidescan mosaic places port and starboard samples across track")
+{
+    SidescanMosaic mosaic(1.0,MOSAIC_BLEND_MEAN,16,2,64);
+
+    addMosaicLine(mosaic,0,10,20,false);
+    mosaic.finish();
+
+    REQUIRE(mosaic.getNbRenderedPings() == 400);
+    REQUIRE(mosaic.getNbPendingPings() == 0);
+
+    double value;
+
+    //Starboard is east of a northbound line, port is west
+    REQUIRE(mosaic.getValue(50.5,5.5,value));
+    REQUIRE(value == Approx(20));
+
+    REQUIRE(mosaic.getValue(50.5,-5.5,value));
+    REQUIRE(value == Approx(10));
+
+    //Beyond the range of the channels and behind the line
+    REQUIRE_FALSE(mosaic.getValue(50.5,25.5,value));
+    REQUIRE_FALSE(mosaic.getValue(-10.5,5.5,value));
+
+    //20 m on each side and 100 m along track, in tiles of 16 m
+    REQUIRE(mosaic.getNbTiles() == 7 * 4);
+}
+
+TEST_CASE("Sidescan mosaic blends overlapping lines with the selected rule")
+{
+    //Starboard of the first line and port of the second line overlap between 0 and 10 m east
+    double value;
+
+    SidescanMosaic mean(1.0,MOSAIC_BLEND_MEAN,16,2,64);
+    addMosaicLine(mean,0,0,10,true);
+    addMosaicLine(mean,10,30,0,true);
+    mean.finish();
+
+    REQUIRE(mean.getValue(50.5,5.5,value));
+    REQUIRE(value > 10);
+    REQUIRE(value < 30);
+
+    SidescanMosaic maximum(1.0,MOSAIC_BLEND_MAXIMUM,16,2,64);
+    addMosaicLine(maximum,0,0,10,true);
+    addMosaicLine(maximum,10,30,0,true);
+    maximum.finish();
+
+    REQUIRE(maximum.getValue(50.5,5.5,value));
+    REQUIRE(value == Approx(30));
+
+    //The second line covers the first line, whatever the order of the values
+    SidescanMosaic latest(1.0,MOSAIC_BLEND_LATEST_LINE,16,2,64);
+    addMosaicLine(latest,10,30,0,true);
+    addMosaicLine(latest,0,0,10,true);
+    latest.finish();
+
+    REQUIRE(latest.getValue(50.5,5.5,value));
+    REQUIRE(value == Approx(10));
+
+    //Each cell keeps the line it is closest to
+    SidescanMosaic nadir(1.0,MOSAIC_BLEND_NEAREST_NADIR,16,2,64);
+    addMosaicLine(nadir,0,0,10,true);
+    addMosaicLine(nadir,10,30,0,true);
+    nadir.finish();
+
+    REQUIRE(nadir.getValue(50.5,2.5,value));
+    REQUIRE(value == Approx(10));
+
+    REQUIRE(nadir.getValue(50.5,7.5,value));
+    REQUIRE(value == Approx(30));
+}
+
+TEST_CASE("Sidescan mosaic does not depend on the number of threads")
+{
+    std::string outputs[2];
+    unsigned int threads[2] = {1,4};
+
+    for(unsigned int t=0;t<2;t++){
+        SidescanMosaic mosaic(0.5,MOSAIC_BLEND_MEAN,32,threads[t],16);
+
+        //A turning track, samples of every ping being different
+        for(unsigned int second=0;second<=60;second++){
+            mosaic.addPosition(second * 1000000ul,second * 2.0,second * second * 0.05);
+        }
+
+        for(unsigned int i=0;i<120;i++){
+            SidescanPing ping;
+            ping.setTimestamp(i * 500000ul);
+            ping.setDistancePerSample(0.1);
+
+            std::vector<double> samples(150);
+
+            for(unsigned int j=0;j<samples.size();j++){
+                samples[j] = (i + j) % 7;
+            }
+
+            ping.setSamples(samples);
+            mosaic.addPing(ping,(i % 2 == 0) ? MOSAIC_PORT : MOSAIC_STARBOARD);
+        }
+
+        mosaic.finish();
+
+        std::stringstream out;
+        mosaic.write(out);
+        outputs[t] = out.str();
+    }
+
+    REQUIRE(!outputs[0].empty());
+    REQUIRE(outputs[0] == outputs[1]);
+}
+
+TEST_CASE("Sidescan mosaic waits for the navigation of its pings")
+{
+    SidescanMosaic mosaic(1.0,MOSAIC_BLEND_MEAN,16,2,1);
+
+    SidescanPing ping;
+    ping.setTimestamp(5000000);
+    ping.setDistancePerSample(0.5);
+
+    std::vector<double> samples(20,42);
+    ping.setSamples(samples);
+
+    //No navigation yet
+    mosaic.addPing(ping,MOSAIC_STARBOARD);
+    REQUIRE(mosaic.getNbPendingPings() == 1);
+
+    mosaic.addPosition(0,0,0);
+    mosaic.addPosition(10000000,10,0);
+
+    //Rendered with the next batch
+    ping.setTimestamp(6000000);
+    mosaic.addPing(ping,MOSAIC_STARBOARD);
+
+    REQUIRE(mosaic.getNbPendingPings() == 0);
+    REQUIRE(mosaic.getNbRenderedPings() == 2);
+
+    double value;
+    REQUIRE(mosaic.getValue(5.5,3.5,value));
+    REQUIRE(value == Approx(42));
+
+    //Pings past the navigation are dropped at the end
+    ping.setTimestamp(20000000);
+    mosaic.addPing(ping,MOSAIC_STARBOARD);
+    REQUIRE(mosaic.getNbPendingPings() == 1);
+
+    mosaic.finish();
+    REQUIRE(mosaic.getNbPendingPings() == 0);
+    REQUIRE(mosaic.getNbRenderedPings() == 2);
+}
+
+TEST_CASE("Sidescan mosaic leaves the nadir gap out")
+{
+    double value;
+
+    SidescanMosaic mosaic(1.0,MOSAIC_BLEND_MEAN,16,2,64);
+    mosaic.setNadirGap(2);
+    addMosaicLine(mosaic,0,10,20,true);
+    mosaic.finish();
+
+    REQUIRE_FALSE(mosaic.getValue(50.5,1.5,value));
+    REQUIRE_FALSE(mosaic.getValue(50.5,-0.5,value));
+    REQUIRE(mosaic.getValue(50.5,2.5,value));
+    REQUIRE(value == Approx(20));
+
+    //The cells next to the track of the second line keep the first line, beyond its nadir gap
+    SidescanMosaic nadir(1.0,MOSAIC_BLEND_NEAREST_NADIR,16,2,64);
+    nadir.setNadirGap(3);
+    addMosaicLine(nadir,0,0,10,true);
+    addMosaicLine(nadir,10,30,0,true);
+    nadir.finish();
+
+    REQUIRE(nadir.getValue(50.5,8.5,value));
+    REQUIRE(value == Approx(10));
+
+    REQUIRE(nadir.getValue(50.5,6.5,value));
+    REQUIRE(value == Approx(30));
+}
+
+TEST_CASE("Sidescan mosaic keeps pings ahead of the navigation in order")
+{
+    SidescanMosaic mosaic(1.0,MOSAIC_BLEND_MEAN,16,2,4);
+
+    mosaic.addPosition(0,0,0);
+    mosaic.addPosition(1000000,1,0);
+
+    SidescanPing ping;
+    ping.setDistancePerSample(0.5);
+
+    std::vector<double> samples(20,42);
+    ping.setSamples(samples);
+
+    //Pings ahead of the navigation wait, whatever the batch size, some of them out of order
+    for(unsigned int i=0;i<20;i++){
+        ping.setTimestamp(((i % 2 == 0) ? i + 3 : i + 1) * 1000000ul);
+        mosaic.addPing(ping,MOSAIC_STARBOARD);
+    }
+
+    REQUIRE(mosaic.getNbPendingPings() == 20);
+    REQUIRE(mosaic.getNbRenderedPings() == 0);
+
+    //The navigation reaches the first half of the pings
+    for(unsigned int second=2;second<=11;second++){
+        mosaic.addPosition(second * 1000000ul,second,0);
+    }
+
+    ping.setTimestamp(30000000);
+    mosaic.addPing(ping,MOSAIC_STARBOARD);
+
+    REQUIRE(mosaic.getNbRenderedPings() == 10);
+    REQUIRE(mosaic.getNbPendingPings() == 11);
+
+    mosaic.finish();
+    REQUIRE(mosaic.getNbRenderedPings() == 10);
+}
+
+TEST_CASE("Sidescan mosaic rejects positions beyond its cell indices")
+{
+    SidescanMosaic mosaic(1e-6,MOSAIC_BLEND_MEAN,16,2,1);
+    double value;
+
+    //Far from the origin at a micrometre resolution
+    mosaic.addPosition(0,0,0);
+    mosaic.addPosition(10000000,10000,0);
+
+    SidescanPing ping;
+    ping.setTimestamp(5000000);
+    ping.setDistancePerSample(0.5);
+
+    std::vector<double> samples(20,42);
+    ping.setSamples(samples);
+
+    REQUIRE_THROWS(mosaic.addPing(ping,MOSAIC_STARBOARD));
+    REQUIRE(mosaic.getNbPendingPings() == 0);
+
+    REQUIRE_THROWS(mosaic.getValue(5000,0,value));
+    REQUIRE_THROWS(mosaic.getValue(std::nan(""),0,value));
+
+    //The lowest cell index has a tile
+    REQUIRE_FALSE(mosaic.getValue(-2147483648e-6,0,value));
+
+    //Pings on positions that are not finite are dropped
+    SidescanMosaic lost(1.0,MOSAIC_BLEND_MEAN,16,2,1);
+    lost.addPosition(0,std::nan(""),0);
+    lost.addPosition(10000000,std::nan(""),0);
+    lost.addPing(ping,MOSAIC_STARBOARD);
+
+    REQUIRE(lost.getNbPendingPings() == 0);
+    REQUIRE(lost.getNbRenderedPings() == 0);
+}
+
+TEST_CASE("Sidescan mosaic rejects invalid parameters")
+{
+    REQUIRE_THROWS(SidescanMosaic(0));
+    REQUIRE_THROWS(SidescanMosaic(1.0,7));
+}
+
+#endif
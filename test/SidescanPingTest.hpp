@@ -0,0 +1,182 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   SidescanPingTest.hpp
+ */
+
+#ifndef SIDESCANPINGTEST_HPP
+#define SIDESCANPINGTEST_HPP
+
+#include <vector>
+#include "catch.hpp"
+#include "../src/sidescan/SidescanPing.hpp"
+#include "../src/sidescan/SidescanPingPool.hpp"
+#include "../src/sidescan/SidescanSwath.hpp"
+
+TEST_CASE("Sidescan ping stores samples in their native type")
+{
+    SidescanPing ping;
+
+    uint8_t bytes[] = {0,17,255};
+    ping.setSamples(bytes,3);
+
+    REQUIRE(ping.getSampleType() == SIDESCAN_SAMPLE_UINT8);
+    REQUIRE(ping.getNbSamples() == 3);
+    REQUIRE(ping.getSamplesMemorySize() == 3);
+    REQUIRE(ping.getSamplesAs<uint8_t>()[1] == 17);
+    REQUIRE(ping.getSamplesAs<uint16_t>() == NULL);
+    REQUIRE(ping.getSample(2) == 255);
+
+    std::vector<double> widened;
+    ping.getSamples(widened);
+
+    REQUIRE(widened.size() == 3);
+    REQUIRE(widened[0] == 0);
+    REQUIRE(widened[1] == 17);
+    REQUIRE(widened[2] == 255);
+
+    //Copies keep the samples and their type
+    SidescanPing copy(ping);
+
+    REQUIRE(copy.getSampleType() == SIDESCAN_SAMPLE_UINT8);
+    REQUIRE(copy.getSample(1) == 17);
+}
+
+TEST_CASE("Sidescan ping converts doubles to its sample type")
+{
+    SidescanPing ping;
+
+    std::vector<double> samples = {-3,12.4,12.6,70000};
+
+    ping.setSamples(samples);
+    REQUIRE(ping.getSampleType() == SIDESCAN_SAMPLE_DOUBLE);
+    REQUIRE(ping.getSamplesMemorySize() == 32);
+
+    //Integer types round and clamp
+    ping.setSampleType(SIDESCAN_SAMPLE_UINT16);
+    REQUIRE(ping.getSamplesMemorySize() == 8);
+    REQUIRE(ping.getSample(0) == 0);
+    REQUIRE(ping.getSample(1) == 12);
+    REQUIRE(ping.getSample(2) == 13);
+    REQUIRE(ping.getSample(3) == 65535);
+
+    ping.setSampleType(SIDESCAN_SAMPLE_FLOAT);
+    ping.setSamples(samples);
+    REQUIRE(ping.getNbSamples() == 4);
+    REQUIRE(ping.getSamplesAs<float>()[1] == 12.4f);
+}
+
+TEST_CASE("Sidescan ping pool recycles released pings")
+{
+    SidescanPingPool pool(2);
+
+    SidescanPing * first = pool.acquire();
+    std::vector<double> samples(1000,5);
+    first->setSamples(samples);
+    first->setPosition(Position(1,48.5,-68.5,0));
+    first->setChannelNumber(3);
+
+    REQUIRE(first->getPosition() != NULL);
+
+    first->release();
+
+    REQUIRE(pool.getNbFree() == 1);
+    REQUIRE(pool.getNbUsed() == 0);
+
+    //The same ping comes back cleared
+    SidescanPing * second = pool.acquire();
+
+    REQUIRE(second == first);
+    REQUIRE(second->getNbSamples() == 0);
+    REQUIRE(second->getPosition() == NULL);
+    REQUIRE(second->getChannelNumber() == 0);
+
+    SidescanPing * third = pool.acquire();
+    SidescanPing * fourth = pool.acquire();
+
+    REQUIRE(pool.getNbAllocated() == 3);
+    REQUIRE(pool.getNbUsed() == 3);
+
+    //Only two free pings are kept
+    second->release();
+    third->release();
+    fourth->release();
+
+    REQUIRE(pool.getNbFree() == 2);
+    REQUIRE(pool.getNbAllocated() == 2);
+
+    //Pings that do not come from a pool are deleted
+    SidescanPing * unpooled = new SidescanPing();
+    unpooled->release();
+}
+
+TEST_CASE("Sidescan pings outlive their pool")
+{
+    SidescanPing * ping;
+
+    {
+        SidescanPingPool pool;
+        ping = pool.acquire();
+    }
+
+    ping->setChannelNumber(1);
+    ping->release();
+}
+
+TEST_CASE("Sidescan pings deleted by their handler leave their pool")
+{
+    SidescanPingPool pool;
+    std::vector<SidescanPing *> line;
+
+    for(unsigned int i=0;i<1000;i++){
+        line.push_back(pool.acquire());
+    }
+
+    //Deleted in the middle of the pings in use, as a handler owning its pings did
+    delete line[500];
+    delete line[999];
+    delete line[0];
+
+    REQUIRE(pool.getNbUsed() == 997);
+    REQUIRE(pool.getNbAllocated() == 997);
+
+    for(unsigned int i=1;i<999;i++){
+        if(i != 500) line[i]->release();
+    }
+
+    REQUIRE(pool.getNbUsed() == 0);
+    REQUIRE(pool.getNbFree() == 256);
+
+    //A ping deleted while the pool still exists is not touched when the pool is destroyed
+    delete pool.acquire();
+}
+
+TEST_CASE("Sidescan swath hands its pings after those already taken")
+{
+    SidescanPingPool pool;
+    std::vector<SidescanPing *> taken;
+
+    for(unsigned int i=0;i<2;i++){
+        SidescanSwath swath(i);
+        swath.addPing(pool.acquire(),SIDESCAN_SIDE_PORT);
+        swath.addPing(pool.acquire(),SIDESCAN_SIDE_STARBOARD);
+
+        swath.takePings(taken);
+
+        REQUIRE(swath.getPings().empty());
+        REQUIRE(swath.getPort() == NULL);
+    }
+
+    REQUIRE(taken.size() == 4);
+    REQUIRE(pool.getNbUsed() == 4);
+
+    for(auto i=taken.begin();i!=taken.end();i++){
+        (*i)->release();
+    }
+
+    REQUIRE(pool.getNbUsed() == 0);
+}
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   SlantRangeResamplerTest.hpp
+ */
+
+#ifndef SLANTRANGERESAMPLERTEST_HPP
+#define SLANTRANGERESAMPLERTEST_HPP
+
+#include <vector>
+#include <cmath>
+#include "catch.hpp"
+#include "../src/sidescan/SlantRangeResampler.hpp"
+
+TEST_CASE("Slant range resampler reads the slant range of every ground range bin")
+{
+    //Samples are their slant range: 1000 samples, 0.1 m apart
+    std::vector<double> slant(1000);
+
+    for(unsigned int i=0;i<slant.size();i++){
+        slant[i] = i * 0.1;
+    }
+
+    SlantRangeResampler resampler;
+    std::vector<double> ground;
+
+    resampler.resample(slant,100,20,ground);
+
+    REQUIRE(ground.size() == (unsigned int)std::floor(std::sqrt(99.9 * 99.9 - 400) / 0.1) + 1);
+    REQUIRE(resampler.getDistancePerSample() == Approx(0.1));
+
+    //Interpolating a linear ramp is exact, and no bin is left empty
+    bool exact = true;
+
+    for(unsigned int j=0;j<ground.size();j++){
+        double groundRange = j * 0.1;
+        if(std::abs(ground[j] - std::sqrt(groundRange * groundRange + 400)) > 1e-9) exact = false;
+    }
+
+    REQUIRE(exact);
+    REQUIRE(ground[0] == Approx(20));
+
+    //Without altitude, ground range is slant range
+    resampler.resample(slant,100,0,ground);
+
+    REQUIRE(ground.size() == 1000);
+    REQUIRE(ground[500] == Approx(50));
+
+    //Seafloor beyond the slant range
+    resampler.resample(slant,100,150,ground);
+
+    REQUIRE(ground.empty());
+}
+
+TEST_CASE("Slant range resampler resamples a batch of pings in their sample type")
+{
+    std::vector<SidescanPing *> pings;
+    std::vector<double> altitudes;
+
+    for(unsigned int p=0;p<6;p++){
+        std::vector<uint16_t> samples(500);
+
+        for(unsigned int i=0;i<samples.size();i++){
+            samples[i] = i;
+        }
+
+        SidescanPing * ping = new SidescanPing();
+        ping->setSamples(samples.data(),samples.size());
+        ping->setDistancePerSample(0.2);
+
+        pings.push_back(ping);
+        altitudes.push_back(10 + (p % 2) * 5);
+    }
+
+    SlantRangeResampler::resample(pings,altitudes,3);
+
+    for(unsigned int p=0;p<pings.size();p++){
+        double altitude = altitudes[p];
+
+        REQUIRE(pings[p]->getSampleType() == SIDESCAN_SAMPLE_UINT16);
+        REQUIRE(pings[p]->getDistancePerSample() == Approx(0.2));
+        REQUIRE(pings[p]->getNbSamples() == (unsigned int)std::floor(std::sqrt(99.8 * 99.8 - altitude * altitude) / 0.2) + 1);
+
+        //Slant range of the first bin, in samples, rounded
+        REQUIRE(pings[p]->getSample(0) == std::floor(altitude / 0.2 + 0.5));
+
+        pings[p]->release();
+    }
+
+    std::vector<double> missing;
+    REQUIRE_THROWS(SlantRangeResampler::resample(pings,missing));
+}
+
+#endif
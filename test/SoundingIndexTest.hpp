@@ -0,0 +1,75 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   SoundingIndexTest.hpp
+ */
+
+#ifndef SOUNDINGINDEXTEST_HPP
+#define SOUNDINGINDEXTEST_HPP
+
+#include <vector>
+#include "catch.hpp"
+#include "../src/index/SoundingIndex.hpp"
+
+TEST_CASE("Sounding index box queries match a linear scan")
+{
+    SoundingIndexBuilder builder(16,4);
+    std::vector<IndexedSounding> all;
+
+    for(int i=0;i<5000;i++){
+        double x = (i * 7919) % 1000 * 0.1;
+        double y = (i * 104729) % 997 * 0.1;
+        double z = 20 + (i % 31) * 0.5;
+
+        builder.add(x,y,z,i,-i);
+
+        IndexedSounding sounding;
+        sounding.x = x;
+        sounding.y = y;
+        sounding.z = z;
+        sounding.quality = i;
+        all.push_back(sounding);
+    }
+
+    builder.write("build/test/soundings.idx");
+
+    SoundingIndex index("build/test/soundings.idx");
+
+    REQUIRE(index.getNbSoundings() == 5000);
+
+    double minimum[3] = {12.0,40.0,22.0};
+    double maximum[3] = {37.5,61.0,30.0};
+
+    std::vector<IndexedSounding> found;
+    index.query(minimum,maximum,found);
+
+    std::vector<uint32_t> expected;
+
+    for(auto i=all.begin();i!=all.end();i++){
+        if(i->x >= minimum[0] && i->x <= maximum[0] && i->y >= minimum[1] && i->y <= maximum[1] && i->z >= minimum[2] && i->z <= maximum[2]){
+            expected.push_back(i->quality);
+        }
+    }
+
+    std::vector<uint32_t> foundQualities;
+
+    for(auto i=found.begin();i!=found.end();i++){
+        REQUIRE(i->intensity == -(int32_t)i->quality);
+        foundQualities.push_back(i->quality);
+    }
+
+    std::sort(expected.begin(),expected.end());
+    std::sort(foundQualities.begin(),foundQualities.end());
+
+    REQUIRE(expected.size() > 0);
+    REQUIRE(foundQualities == expected);
+}
+
+TEST_CASE("Sounding index rejects files that are not indexes")
+{
+    REQUIRE_THROWS(SoundingIndex("test/data/SVP/SVP.txt"));
+}
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   StaticFilterChainTest.hpp
+ */
+
+#ifndef STATICFILTERCHAINTEST_HPP
+#define STATICFILTERCHAINTEST_HPP
+
+#include <list>
+#include "catch.hpp"
+#include "../src/filter/StaticFilterChain.hpp"
+#include "../src/filter/QualityFilter.hpp"
+#include "../src/filter/IntensityFilter.hpp"
+#include "../src/filter/InsanePositionFilter.hpp"
+
+TEST_CASE("Static filter chain gives the same decisions as the dynamic chain")
+{
+    StaticFilterChain<InsanePositionFilter,QualityFilter,IntensityFilter> chain(InsanePositionFilter(),QualityFilter(5),IntensityFilter(10));
+
+    std::list<PointFilter*> filters;
+    filters.push_back(new InsanePositionFilter());
+    filters.push_back(new QualityFilter(5));
+    filters.push_back(new IntensityFilter(10));
+
+    double positions[] = {0,1e5,-1e9,2e8};
+
+    for(unsigned int p=0;p<4;p++){
+        for(uint32_t quality=0;quality<10;quality++){
+            for(uint32_t intensity=5;intensity<15;intensity++){
+                bool dynamicDecision = false;
+
+                for(auto i=filters.begin();i!=filters.end();i++){
+                    if((*i)->filterPoint(0,positions[p],0,0,quality,intensity)){
+                        dynamicDecision = true;
+                        break;
+                    }
+                }
+
+                REQUIRE(chain.filterPoint(0,positions[p],0,0,quality,intensity) == dynamicDecision);
+            }
+        }
+    }
+
+    for(auto i=filters.begin();i!=filters.end();i++){
+        delete *i;
+    }
+}
+
+TEST_CASE("Static filter chain built with makeFilterChain")
+{
+    auto chain = makeFilterChain(QualityFilter(3));
+
+    REQUIRE(chain.filterPoint(0,0,0,0,2,0));
+    REQUIRE_FALSE(chain.filterPoint(0,0,0,0,3,0));
+
+    StaticFilterChain<> empty;
+    REQUIRE_FALSE(empty.filterPoint(0,1e10,0,0,0,0));
+}
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   TiledDtmTest.hpp
+ */
+
+#ifndef TILEDDTMTEST_HPP
+#define TILEDDTMTEST_HPP
+
+#include <cstdio>
+#include <cmath>
+#include <string>
+#include "catch.hpp"
+#include "../src/gridding/TiledDtm.hpp"
+
+TEST_CASE("Tiled DTM evicts tiles to disk and reads them back")
+{
+    TiledDtm tiles(1.0,"build/test",4,2);
+
+    //Points spread over 4x4 tiles, visited twice so that evicted tiles are read back
+    for(int pass=0;pass<2;pass++){
+        for(int x=-6;x<6;x++){
+            for(int y=-6;y<6;y++){
+                tiles.add(x + 0.5,y + 0.5,10 + pass);
+            }
+        }
+    }
+
+    REQUIRE(tiles.getNbTilesInMemory() <= 2);
+    REQUIRE(tiles.getTiles(0).size() == 16);
+
+    DtmCell cell = tiles.getCell(0,-5.5,3.5);
+
+    REQUIRE(cell.getCount() == 2);
+    REQUIRE(cell.getMean() == Approx(10.5));
+    REQUIRE(tiles.getCell(0,20.0,20.0).getCount() == 0);
+}
+
+TEST_CASE("Tiled DTM coarser levels merge the cells below them")
+{
+    TiledDtm tiles(1.0,"build/test",4,3);
+    DtmGrid grid(1.0);
+
+    for(int x=-8;x<8;x++){
+        for(int y=-8;y<8;y++){
+            grid.add(x + 0.5,y + 0.5,x + y);
+        }
+    }
+
+    tiles.merge(grid);
+    tiles.buildPyramid(3);
+
+    REQUIRE(tiles.getNbLevels() == 3);
+    REQUIRE(tiles.getResolution(2) == 4.0);
+
+    //Level 1 cell covering [2,4[ x [-2,0[
+    DtmCell coarse = tiles.getCell(1,3.0,-1.0);
+
+    REQUIRE(coarse.getCount() == 4);
+    REQUIRE(coarse.getMean() == Approx(1.0));
+    REQUIRE(coarse.getMinimum() == 0);
+    REQUIRE(coarse.getMaximum() == 2);
+
+    //Level 2 cell covering [-8,-4[ x [4,8[
+    DtmCell coarsest = tiles.getCell(2,-7.0,7.0);
+
+    REQUIRE(coarsest.getCount() == 16);
+    REQUIRE(coarsest.getMean() == Approx(-1.0));
+}
+
+TEST_CASE("Tiled DTM writes its modified tiles when destroyed")
+{
+    std::string filename;
+
+    {
+        TiledDtm tiles(1.0,"build/test",4,2);
+        std::remove(tiles.getTileFilename(DtmTileKey(0,25,-25)).c_str());
+
+        tiles.add(100.5,-99.5,12);
+        filename = tiles.getTileFilename(DtmTileKey(0,25,-25));
+
+        REQUIRE_THROWS(tiles.getCell(0,1e10,0));
+        REQUIRE_THROWS(tiles.getCell(0,std::nan(""),0));
+    }
+
+    DtmTile tile(4);
+    tile.read(filename);
+
+    REQUIRE(tile.getCell(0,0).getCount() == 1);
+    REQUIRE(tile.getCell(0,0).getMean() == Approx(12));
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   VoxelDecimatorTest.hpp
+ */
+
+#ifndef VOXELDECIMATORTEST_HPP
+#define VOXELDECIMATORTEST_HPP
+
+#include "catch.hpp"
+#include "../src/gridding/VoxelDecimator.hpp"
+
+TEST_CASE("Voxel decimator keeps the first point of each voxel")
+{
+    VoxelDecimator decimator(1.0);
+
+    REQUIRE(decimator.add(0.1,0.1,10.1));
+    REQUIRE(!decimator.add(0.9,0.9,10.9));
+    REQUIRE(decimator.add(1.1,0.1,10.1));
+    REQUIRE(decimator.add(0.1,0.1,11.1));
+
+    //Negative coordinates round down
+    REQUIRE(decimator.add(-0.1,0.1,10.1));
+    REQUIRE(!decimator.add(-0.9,0.5,10.5));
+
+    //Far coordinates, such as ECEF, do not collide
+    REQUIRE(decimator.add(1563000.5,-4349000.5,4424000.5));
+    REQUIRE(decimator.add(1563001.5,-4349000.5,4424000.5));
+
+    REQUIRE(decimator.getNbPoints() == 8);
+    REQUIRE(decimator.getNbKept() == 6);
+
+    decimator.clear();
+
+    REQUIRE(decimator.add(0.1,0.1,10.1));
+}
+
+TEST_CASE("Voxel decimation scales with area")
+{
+    //Dense soundings over 50 m x 50 m, flat seafloor with 10 cm of noise
+    VoxelDecimator decimator(1.0,5.0);
+
+    for(unsigned int i=0;i<250000;i++){
+        double x = (i % 500) * 0.1;
+        double y = (i / 500) * 0.1;
+        decimator.add(x,y,20 + ((i * 7919) % 100) * 0.001);
+    }
+
+    REQUIRE(decimator.getNbPoints() == 250000);
+    REQUIRE(decimator.getNbKept() == 2500);
+}
+
+#endif
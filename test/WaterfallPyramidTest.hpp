@@ -0,0 +1,149 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   WaterfallPyramidTest.hpp
+ */
+
+#ifndef WATERFALLPYRAMIDTEST_HPP
+#define WATERFALLPYRAMIDTEST_HPP
+
+#include <vector>
+#include <cmath>
+#include <fstream>
+#include "catch.hpp"
+#include "../src/sidescan/WaterfallPyramid.hpp"
+
+TEST_CASE("Waterfall pyramid writes the tiles of every level in one pass")
+{
+    //37 port pings of 20 samples, the sample value being the sample number, in tiles of 8 pixels
+    {
+        WaterfallPyramid pyramid("build/test/waterfall.wfp",8,4);
+
+        for(unsigned int ping=0;ping<37;ping++){
+            std::vector<double> samples(20);
+
+            for(unsigned int j=0;j<samples.size();j++){
+                samples[j] = j;
+            }
+
+            pyramid.add(samples.data(),samples.size(),WATERFALL_PORT);
+        }
+
+        //Tiles are written as their strip of rows fills
+        REQUIRE(pyramid.getNbRows(WATERFALL_PORT,0) == 37);
+        REQUIRE(pyramid.getNbRows(WATERFALL_PORT,1) == 18);
+        REQUIRE(pyramid.getNbTiles() == 4 * 3 + 2 * 2 + 1);
+
+        pyramid.close();
+    }
+
+    WaterfallPyramidReader reader("build/test/waterfall.wfp");
+
+    REQUIRE(reader.getTileSize() == 8);
+    REQUIRE(reader.getNbLevels() == 4);
+
+    //The last odd row goes up alone
+    REQUIRE(reader.getNbRows(WATERFALL_PORT,0) == 37);
+    REQUIRE(reader.getNbRows(WATERFALL_PORT,1) == 19);
+    REQUIRE(reader.getNbRows(WATERFALL_PORT,2) == 10);
+    REQUIRE(reader.getNbRows(WATERFALL_PORT,3) == 5);
+    REQUIRE(reader.getNbColumns(WATERFALL_PORT,0) == 20);
+    REQUIRE(reader.getNbColumns(WATERFALL_PORT,1) == 10);
+    REQUIRE(reader.getNbColumns(WATERFALL_PORT,3) == 3);
+    REQUIRE(reader.getNbRows(WATERFALL_STARBOARD,0) == 0);
+
+    std::vector<float> pixels;
+
+    //Level 0: the samples, padded with NaN past the end of the pings
+    REQUIRE(reader.readTile(WATERFALL_PORT,0,2,4,pixels));
+    REQUIRE(pixels[0] == 16);
+    REQUIRE(pixels[3] == 19);
+    REQUIRE(std::isnan(pixels[4]));
+    REQUIRE(pixels[8] == 16);
+    REQUIRE(std::isnan(pixels[5 * 8]));
+
+    //Level 1: a pixel is the mean of samples 2j and 2j + 1
+    REQUIRE(reader.readTile(WATERFALL_PORT,1,1,1,pixels));
+    REQUIRE(pixels[0] == Approx(16.5));
+    REQUIRE(pixels[1] == Approx(18.5));
+    REQUIRE(std::isnan(pixels[2]));
+
+    //Level 3: pixel 2 holds samples 16 to 19 only
+    REQUIRE(reader.readTile(WATERFALL_PORT,3,0,0,pixels));
+    REQUIRE(pixels[0] == Approx(3.5));
+    REQUIRE(pixels[2] == Approx(17.5));
+    REQUIRE(std::isnan(pixels[3]));
+
+    REQUIRE_FALSE(reader.readTile(WATERFALL_PORT,0,3,0,pixels));
+    REQUIRE_FALSE(reader.readTile(WATERFALL_STARBOARD,0,0,0,pixels));
+}
+
+TEST_CASE("Waterfall pyramid keeps the sides apart and reads pings")
+{
+    {
+        WaterfallPyramid pyramid("build/test/waterfall.wfp",4,2);
+
+        for(unsigned int i=0;i<8;i++){
+            SidescanPing ping;
+            std::vector<double> samples(4,(i % 2 == 0) ? 10 : 20);
+            ping.setSamples(samples);
+
+            pyramid.add(ping,(i < 4) ? WATERFALL_PORT : WATERFALL_STARBOARD);
+        }
+
+        REQUIRE_THROWS(pyramid.add(NULL,0,3));
+    }
+
+    WaterfallPyramidReader reader("build/test/waterfall.wfp");
+    std::vector<float> pixels;
+
+    REQUIRE(reader.getNbRows(WATERFALL_PORT,0) == 4);
+    REQUIRE(reader.getNbRows(WATERFALL_STARBOARD,0) == 4);
+
+    REQUIRE(reader.readTile(WATERFALL_STARBOARD,0,0,0,pixels));
+    REQUIRE(pixels[0] == 10);
+    REQUIRE(pixels[4] == 20);
+
+    REQUIRE(reader.readTile(WATERFALL_STARBOARD,1,0,0,pixels));
+    REQUIRE(pixels[0] == Approx(15));
+    REQUIRE(std::isnan(pixels[2]));
+
+    REQUIRE_THROWS(WaterfallPyramidReader("test/data/SVP/SVP.txt"));
+}
+
+TEST_CASE("Waterfall pyramid does not pad short lines to full tiles")
+{
+    //5 pings of 1000 samples in tiles of 256 pixels
+    {
+        WaterfallPyramid pyramid("build/test/waterfall.wfp",256,8);
+
+        std::vector<double> samples(1000,7);
+
+        for(unsigned int ping=0;ping<5;ping++){
+            pyramid.add(samples.data(),samples.size(),WATERFALL_STARBOARD);
+        }
+
+        pyramid.close();
+    }
+
+    //Level 0 holds 20 KB of samples, a full row of tiles would take 1 MB
+    std::ifstream file("build/test/waterfall.wfp",std::ios::binary | std::ios::ate);
+    REQUIRE((uint64_t)file.tellg() < 64 * 1024);
+
+    WaterfallPyramidReader reader("build/test/waterfall.wfp");
+    std::vector<float> pixels;
+
+    REQUIRE(reader.readTile(WATERFALL_STARBOARD,0,3,0,pixels));
+    REQUIRE(pixels.size() == 256 * 256);
+    REQUIRE(pixels[4 * 256] == 7);
+    REQUIRE(std::isnan(pixels[4 * 256 + 232]));
+    REQUIRE(std::isnan(pixels[5 * 256]));
+
+    REQUIRE(reader.readTile(WATERFALL_STARBOARD,2,0,0,pixels));
+    REQUIRE(pixels[1 * 256] == Approx(7));
+    REQUIRE(std::isnan(pixels[2 * 256]));
+}
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   WorkerPoolTest.hpp
+ */
+
+#ifndef WORKERPOOLTEST_HPP
+#define WORKERPOOLTEST_HPP
+
+#include <vector>
+#include "catch.hpp"
+#include "../src/utils/WorkerPool.hpp"
+
+TEST_CASE("Worker pool runs every chunk on workers kept between jobs")
+{
+    WorkerPool pool;
+    std::vector<unsigned int> visits(1000);
+    std::vector<unsigned int> chunks(4,0);
+
+    //Many small jobs of varying widths, as the pings of a file
+    for(unsigned int job=0;job<500;job++){
+        unsigned int threads = 1 + job % 4;
+
+        pool.runChunks(threads,visits.size(),[&](unsigned int thread,size_t begin,size_t end){
+            //Each chunk is counted by its own thread, the test checks after the job
+            chunks[thread]++;
+
+            for(size_t i=begin;i<end;i++){
+                visits[i]++;
+            }
+        });
+    }
+
+    bool all = true;
+
+    for(auto i=visits.begin();i!=visits.end();i++){
+        if(*i != 500) all = false;
+    }
+
+    REQUIRE(all);
+    REQUIRE(chunks[0] == 500);
+    REQUIRE(chunks[3] == 125);
+
+    //The calling thread runs the first chunk
+    REQUIRE(pool.getNbWorkers() == 3);
+
+    //A single chunk runs on the calling thread
+    WorkerPool idle;
+    size_t covered = 0;
+
+    idle.runChunks(1,10,[&](unsigned int thread,size_t begin,size_t end){
+        covered += end - begin;
+    });
+
+    REQUIRE(covered == 10);
+    REQUIRE(idle.getNbWorkers() == 0);
+}
+
+#endif
@@ -124,4 +124,185 @@ TEST_CASE ("test the XTF parser with a valid datagram")
         excep = error->what();
         REQUIRE(false);
     }
-}
\ No newline at end of file
+}
+
+/**
+ * Writes an XTF file of sidescan pings with a port and a starboard channel of 16 bit samples, listed starboard first.
+ * The channels see a dark water column, then the seafloor from 10 m on port and from 12 m on starboard.
+ *
+ * @param filename the file to write
+ * @param nbPings the number of pings
+ * @param nbSamples the number of samples of each channel, over a 50 m slant range
+ * @param correctionFlags 1 for slant range channels, 2 for ground range channels
+ */
+void writeSidescanXtf(const std::string & filename,unsigned int nbPings,unsigned int nbSamples,uint16_t correctionFlags = 1){
+    FILE * file = fopen(filename.c_str(),"wb");
+    REQUIRE(file != NULL);
+
+    XtfFileHeader fileHeader;
+    memset(&fileHeader,0,sizeof(XtfFileHeader));
+    fileHeader.FileFormat = MAGIC_NUMBER;
+    fileHeader.NumberOfSonarChannels = 2;
+
+    for(unsigned int c=0;c<2;c++){
+        fileHeader.Channels[c].TypeOfChannel = (c == 0) ? XTF_CHANNEL_PORT : XTF_CHANNEL_STARBOARD;
+        fileHeader.Channels[c].CorrectionFlags = correctionFlags;
+        fileHeader.Channels[c].BytesPerSample = 2;
+        fileHeader.Channels[c].SampleFormat = 0;
+    }
+
+    fwrite(&fileHeader,sizeof(XtfFileHeader),1,file);
+
+    std::vector<uint16_t> samples(nbSamples);
+
+    for(unsigned int ping=0;ping<nbPings;ping++){
+        XtfPacketHeader packetHeader;
+        memset(&packetHeader,0,sizeof(XtfPacketHeader));
+        packetHeader.MagicNumber = PACKET_MAGIC_NUMBER;
+        packetHeader.HeaderType = XTF_HEADER_SONAR;
+        packetHeader.NumChansToFollow = 2;
+        packetHeader.NumBytesThisRecord = sizeof(XtfPacketHeader) + sizeof(XtfPingHeader) + 2 * (sizeof(XtfPingChanHeader) + nbSamples * 2);
+
+        XtfPingHeader pingHeader;
+        memset(&pingHeader,0,sizeof(XtfPingHeader));
+        pingHeader.Year = 2019;
+        pingHeader.Month = 9;
+        pingHeader.Day = 1;
+        pingHeader.Second = ping;
+        pingHeader.SoundVelocity = 1500;
+        pingHeader.SensorXcoordinate = -68.5;
+        pingHeader.SensorYcoordinate = 48.5;
+
+        fwrite(&packetHeader,sizeof(XtfPacketHeader),1,file);
+        fwrite(&pingHeader,sizeof(XtfPingHeader),1,file);
+
+        for(int channel=1;channel>=0;channel--){
+            XtfPingChanHeader channelHeader;
+            memset(&channelHeader,0,sizeof(XtfPingChanHeader));
+            channelHeader.ChannelNumber = channel;
+            channelHeader.SlantRange = 50;
+            channelHeader.GroundRange = 50;
+            channelHeader.NumSamples = nbSamples;
+
+            unsigned int bottom = (unsigned int)((channel == 0 ? 10.0 : 12.0) / 50 * nbSamples);
+
+            for(unsigned int i=0;i<nbSamples;i++){
+                samples[i] = (i < bottom) ? 10 : 1000 + (i * 7 + ping) % 50;
+            }
+
+            fwrite(&channelHeader,sizeof(XtfPingChanHeader),1,file);
+            fwrite(samples.data(),2,nbSamples,file);
+        }
+    }
+
+    fclose(file);
+}
+
+/*!
+ * \brief Records the sidescan swaths of a file
+ */
+class SidescanSwathRecorder : public DatagramEventHandler{
+public:
+    void processSidescanSwath(SidescanSwath * swath){
+        REQUIRE(swath->getPort() != NULL);
+        REQUIRE(swath->getStarboard() != NULL);
+        REQUIRE(swath->getPings().size() == 2);
+        REQUIRE(swath->getPosition() != NULL);
+
+        timestamps.push_back(swath->getTimestamp());
+        altitudes.push_back(swath->getAltitude());
+        portChannels.push_back(swath->getPort()->getChannelNumber());
+        portSampleTypes.push_back(swath->getPort()->getSampleType());
+
+        std::vector<double> samples;
+        swath->getPort()->getSamples(samples);
+        portSamples.push_back(samples);
+
+        swath->getStarboard()->getSamples(samples);
+        starboardSamples.push_back(samples);
+
+        delete swath;
+    }
+
+    std::vector<uint64_t> timestamps;
+    std::vector<double> altitudes;
+    std::vector<int> portChannels;
+    std::vector<int> portSampleTypes;
+    std::vector<std::vector<double> > portSamples;
+    std::vector<std::vector<double> > starboardSamples;
+};
+
+/*!
+ * \brief Counts the sidescan pings of a file
+ */
+class SidescanPingCounter : public DatagramEventHandler{
+public:
+    SidescanPingCounter() : nbPings(0){}
+
+    void processSidescanData(SidescanPing * ping){
+        nbPings++;
+        ping->release();
+    }
+
+    unsigned int nbPings;
+};
+
+TEST_CASE ("XTF parser pairs the port and starboard channels of a sidescan ping")
+{
+    std::string file("build/test/sidescan.xtf");
+    writeSidescanXtf(file,5,5000);
+
+    SidescanSwathRecorder sequential;
+    XtfParser sequentialParser(sequential);
+    sequentialParser.setNbDecodingThreads(1);
+    sequentialParser.parse(file);
+
+    SidescanSwathRecorder parallel;
+    XtfParser parallelParser(parallel);
+    parallelParser.parse(file);
+
+    REQUIRE(sequential.timestamps.size() == 5);
+    REQUIRE(sequential.timestamps[1] - sequential.timestamps[0] == 1000000);
+
+    //The port channel is found by its type, though it comes second in the packet
+    REQUIRE(sequential.portChannels[0] == 0);
+
+    //Both channels use the nearest bottom, found on port
+    REQUIRE(sequential.altitudes[0] == Approx(10).margin(0.1));
+    REQUIRE(sequential.portSamples[0].size() == sequential.starboardSamples[0].size());
+
+    //Decoding the channels in parallel gives the same swaths
+    REQUIRE(parallel.timestamps == sequential.timestamps);
+    REQUIRE(parallel.altitudes == sequential.altitudes);
+    REQUIRE(parallel.portSamples == sequential.portSamples);
+    REQUIRE(parallel.starboardSamples == sequential.starboardSamples);
+
+    //Handlers of single pings still get every channel
+    SidescanPingCounter counter;
+    XtfParser counterParser(counter);
+    counterParser.parse(file);
+
+    REQUIRE(counter.nbPings == 10);
+}
+
+TEST_CASE ("XTF parser copies ground range samples in their own type")
+{
+    std::string file("build/test/sidescan-ground.xtf");
+    writeSidescanXtf(file,2,1000,2);
+
+    SidescanSwathRecorder recorder;
+    XtfParser parser(recorder);
+    parser.parse(file);
+
+    REQUIRE(recorder.timestamps.size() == 2);
+
+    //The samples are those of the file: dark until 10 m on port, then the seafloor
+    std::vector<double> & port = recorder.portSamples[1];
+
+    REQUIRE(port.size() == 1000);
+    REQUIRE(recorder.portSampleTypes[1] == SIDESCAN_SAMPLE_UINT16);
+    REQUIRE(port[199] == 10);
+    REQUIRE(port[200] == 1000 + (200 * 7 + 1) % 50);
+    REQUIRE(port[999] == 1000 + (999 * 7 + 1) % 50);
+}
+
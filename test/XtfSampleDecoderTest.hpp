@@ -0,0 +1,70 @@
+/*
+ * Copyright 2019 © Centre Interdisciplinaire de développement en Cartographie des Océans (CIDCO), Tous droits réservés
+ */
+
+/*
+ * File:   XtfSampleDecoderTest.hpp
+ */
+
+#ifndef XTFSAMPLEDECODERTEST_HPP
+#define XTFSAMPLEDECODERTEST_HPP
+
+#include <vector>
+#include <cstring>
+#include "catch.hpp"
+#include "../src/datagrams/xtf/XtfSampleDecoder.hpp"
+
+TEST_CASE("XTF sample converters are selected by sample format")
+{
+    REQUIRE(XtfSampleDecoder::select(0,1) == &XtfSampleDecoder::convert<uint8_t>);
+    REQUIRE(XtfSampleDecoder::select(0,2) == &XtfSampleDecoder::convert<uint16_t>);
+    REQUIRE(XtfSampleDecoder::select(0,4) == &XtfSampleDecoder::convert<uint32_t>);
+    REQUIRE(XtfSampleDecoder::select(0,3) == NULL);
+    REQUIRE(XtfSampleDecoder::select(1,4) == &XtfSampleDecoder::convertIbmFloat);
+    REQUIRE(XtfSampleDecoder::select(2,4) == &XtfSampleDecoder::convert<uint32_t>);
+    REQUIRE(XtfSampleDecoder::select(3,2) == &XtfSampleDecoder::convert<uint16_t>);
+    REQUIRE(XtfSampleDecoder::select(5,4) == &XtfSampleDecoder::convert<float>);
+    REQUIRE(XtfSampleDecoder::select(8,1) == &XtfSampleDecoder::convert<uint8_t>);
+    REQUIRE(XtfSampleDecoder::select(4,4) == NULL);
+}
+
+TEST_CASE("XTF sample converters decode unaligned samples")
+{
+    //Samples start at an odd address, as they can in a packet
+    uint16_t words[] = {0,1,300,65535};
+    unsigned char buffer[1 + sizeof(words)];
+    memcpy(buffer + 1,words,sizeof(words));
+
+    double samples[4];
+    XtfSampleDecoder::select(3,2)(buffer + 1,4,samples);
+
+    REQUIRE(samples[0] == 0);
+    REQUIRE(samples[1] == 1);
+    REQUIRE(samples[2] == 300);
+    REQUIRE(samples[3] == 65535);
+
+    float floats[] = {-1.5f,0.25f,1000.0f};
+    unsigned char floatBuffer[1 + sizeof(floats)];
+    memcpy(floatBuffer + 1,floats,sizeof(floats));
+
+    XtfSampleDecoder::select(5,4)(floatBuffer + 1,3,samples);
+
+    REQUIRE(samples[0] == -1.5);
+    REQUIRE(samples[1] == 0.25);
+    REQUIRE(samples[2] == 1000);
+}
+
+TEST_CASE("XTF sample converter decodes IBM floats")
+{
+    uint32_t words[] = {0x42640000,0xC276A000,0x00000000,0x41100000};
+    double samples[4];
+
+    XtfSampleDecoder::convertIbmFloat((const unsigned char *)words,4,samples);
+
+    REQUIRE(samples[0] == 100);
+    REQUIRE(samples[1] == -118.625);
+    REQUIRE(samples[2] == 0);
+    REQUIRE(samples[3] == 1);
+}
+
+#endif
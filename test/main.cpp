@@ -2,6 +2,14 @@
 #include "catch.hpp"
 
 #include "XtfTypesTest.hpp"
+#include "XtfSampleDecoderTest.hpp"
+#include "QuinsyR2SonicDecoderTest.hpp"
+#include "SidescanPingTest.hpp"
+#include "SlantRangeResamplerTest.hpp"
+#include "BottomTrackerTest.hpp"
+#include "SidescanMosaicTest.hpp"
+#include "WaterfallPyramidTest.hpp"
+#include "GainNormalizerTest.hpp"
 #include "NmeaUtilsTest.hpp"
 #include "SurveySystemTest.hpp"
 #include "CoordinateTransformTest.hpp"
@@ -17,5 +25,22 @@
 #include "CarisSvpTest.hpp"
 #include "SvpStrategyTest.hpp"
 #include "TimeUtilsTest.hpp"
+#include "WorkerPoolTest.hpp"
 #include "KongsbergTypesTest.hpp"
 #include "KongsbergParserTest.hpp"
+#include "AlongTrackSpikeFilterTest.hpp"
+#include "PlaneFitFilterTest.hpp"
+#include "StaticFilterChainTest.hpp"
+#include "DtmGridTest.hpp"
+#include "TiledDtmTest.hpp"
+#include "LiveDtmTest.hpp"
+#include "SoundingIndexTest.hpp"
+#include "MortonSorterTest.hpp"
+#include "RasterFootprintTest.hpp"
+#include "PolygonIndexTest.hpp"
+#include "RTreeTest.hpp"
+#include "OverlapMatrixTest.hpp"
+#include "OverlapDifferenceTest.hpp"
+#include "VoxelDecimatorTest.hpp"
+#include "ConvexHullTest.hpp"
+#include "CoveragePolygonTest.hpp"